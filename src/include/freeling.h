@@ -31,6 +31,8 @@
 
 #include "freeling/windll.h"
 #include "freeling/version.h"
+#include "freeling/morfo/metrics.h"
+#include "freeling/morfo/model_registry.h"
 
 #include "freeling/morfo/lang_ident.h"
 #include "freeling/morfo/tokenizer.h"
@@ -29,9 +29,11 @@
 #ifndef _FREELING_IO
 #define _FREELING_IO
 
+#include "freeling/output/input_binary.h"
 #include "freeling/output/input_conll.h"
 #include "freeling/output/input_freeling.h"
 
+#include "freeling/output/output_binary.h"
 #include "freeling/output/output_conll.h"
 #include "freeling/output/output_freeling.h"
 #include "freeling/output/output_json.h"
@@ -0,0 +1,129 @@
+//////////////////////////////////////////////////////////////////
+//
+//    FreeLing - Open Source Language Analyzers
+//
+//    Copyright (C) 2014   TALP Research Center
+//                         Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU Affero General Public
+//    License as published by the Free Software Foundation; either
+//    version 3 of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Affero General Public License for more details.
+//
+//    You should have received a copy of the GNU Affero General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: Lluis Padro (padro@lsi.upc.es)
+//             TALP Research Center
+//             despatx C6.212 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+////////////////////////////////////////////////////////////////
+
+#ifndef LRUCACHE_H
+#define LRUCACHE_H
+
+#define BOOST_SYSTEM_NO_DEPRECATED
+#include <boost/thread/mutex.hpp>
+#include <list>
+#include <vector>
+#include <unordered_map>
+#include <functional>
+#include <algorithm>
+
+////////////////////////////////////////////////////////////////
+/// This class provides a bounded cache with thread-safe access.
+/// Keys are spread over several shards, each with its own mutex
+/// and least-recently-used eviction, so concurrent threads
+/// rarely wait for each other.
+////////////////////////////////////////////////////////////////
+
+template <class T1, class T2> 
+  class lru_cache {
+
+ private:
+    /// one shard: recency list (most recent first) and index on it
+    class shard {
+    public:
+      boost::mutex sem;
+      std::list<std::pair<T1,T2> > items;
+      std::unordered_map<T1, typename std::list<std::pair<T1,T2> >::iterator> index;
+    };
+
+    std::vector<shard> shards;
+    size_t shard_capacity;
+
+    shard &get_shard(const T1 &key) {
+      return shards[std::hash<T1>()(key) % shards.size()];
+    }
+
+ public:
+    /// create a cache holding about "capacity" entries
+    lru_cache(size_t capacity, size_t nshards=16) : shards(nshards) {
+      shard_capacity = std::max<size_t>(1, capacity/nshards);
+    }
+
+    // check if key is in cache, if found, return true  
+    // and set value in second parameter
+    bool find_safe(const T1 &key, T2 &val) {
+      shard &s = get_shard(key);
+      bool b=false;
+      s.sem.lock();
+      typename std::unordered_map<T1, typename std::list<std::pair<T1,T2> >::iterator>::iterator p=s.index.find(key);
+      if (p!=s.index.end()) {
+        b = true;
+        val = p->second->second;
+        // mark as most recently used
+        s.items.splice(s.items.begin(), s.items, p->second);
+      }
+      s.sem.unlock();
+      return b;
+    }
+
+    // insert new pair in cache, evicting least recently used
+    // entry if the shard is full.
+    void insert_safe(const T1 &key, const T2 &val) {
+      shard &s = get_shard(key);
+      s.sem.lock();
+      if (s.index.find(key)==s.index.end()) {
+        s.items.push_front(std::make_pair(key,val));
+        s.index.insert(std::make_pair(key,s.items.begin()));
+        if (s.items.size() > shard_capacity) {
+          s.index.erase(s.items.back().first);
+          s.items.pop_back();
+        }
+      }
+      s.sem.unlock();
+    }
+
+    // remove pair from cache, with mutex.
+    void erase_safe(const T1 &key) {
+      shard &s = get_shard(key);
+      s.sem.lock();
+      typename std::unordered_map<T1, typename std::list<std::pair<T1,T2> >::iterator>::iterator p=s.index.find(key);
+      if (p!=s.index.end()) {
+        s.items.erase(p->second);
+        s.index.erase(p);
+      }
+      s.sem.unlock();
+    }
+
+    // remove all pairs from cache, with mutex.
+    void clear_safe() {
+      for (size_t i=0; i<shards.size(); i++) {
+        shards[i].sem.lock();
+        shards[i].index.clear();
+        shards[i].items.clear();
+        shards[i].sem.unlock();
+      }
+    }
+};
+
+
+#endif
@@ -29,7 +29,7 @@
 #ifndef _RE_MAP
 #define _RE_MAP
 
-#include <list>
+#include <vector>
 
 #include "freeling/windll.h"
 #include "freeling/regexp.h"
@@ -40,6 +40,8 @@ namespace freeling {
 
   ////////////////////////////////////////////////////////////////
   /// Auxiliary class to store a single RE_map rule
+  /// DEPRECATED: RE_map now checks its rules as a regexp_set. 
+  /// Kept for applications using it.
   ////////////////////////////////////////////////////////////////
 
   class RE_map_rule {
@@ -70,8 +72,9 @@ namespace freeling {
 
   class WINDLL RE_map : public processor {
   private:
-    /// list of regex with associated information
-    std::list<RE_map_rule> regexps;
+    /// regexps, checked as a set, with associated information
+    freeling::regexp_set regexps;
+    std::vector<std::wstring> data;
     
   public:
     /// Constructor
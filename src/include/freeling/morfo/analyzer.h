@@ -31,6 +31,12 @@
 
 #include <iostream> 
 #include <list>
+#include <vector>
+#include <atomic>
+#include <memory>
+
+#define BOOST_SYSTEM_NO_DEPRECATED
+#include <boost/thread/mutex.hpp>
 
 #include "freeling.h"
 #include "freeling/morfo/analyzer_config.h"
@@ -56,22 +62,36 @@ class WINDLL analyzer {
 
    // we use pointers to the analyzers, so we
    // can create only those strictly necessary.
-   tokenizer *tk;
-   splitter *sp;
-   maco *morfo;
-   nec *neclass;
-   senses *sens;
-   ukb *dsb;
-   POS_tagger *hmm;
-   POS_tagger *relax;
-   phonetics *phon;
-   chart_parser *parser;
-   dep_txala *deptxala;
-   dep_treeler *deptreeler;
-   dep_lstm *deplstm;
-   srl_treeler *srltreeler;
-   relaxcor *corfc;
-   semgraph_extract *sge;
+   // Modules are shared with other analyzers loading the same
+   // data files (see model_registry).
+   std::shared_ptr<tokenizer> tk;
+   std::shared_ptr<splitter> sp;
+   // modules beyond the splitter are created the first time
+   // some invoke options need them (see load_modules)
+   mutable std::shared_ptr<maco> morfo;
+   mutable std::shared_ptr<nec> neclass;
+   mutable std::shared_ptr<senses> sens;
+   mutable std::shared_ptr<ukb> dsb;
+   mutable std::shared_ptr<POS_tagger> hmm;
+   mutable std::shared_ptr<POS_tagger> relax;
+   mutable std::shared_ptr<phonetics> phon;
+   mutable std::shared_ptr<chart_parser> parser;
+   mutable std::shared_ptr<dep_txala> deptxala;
+   mutable std::shared_ptr<dep_treeler> deptreeler;
+   mutable std::shared_ptr<dep_lstm> deplstm;
+   mutable std::shared_ptr<srl_treeler> srltreeler;
+   mutable std::shared_ptr<relaxcor> corfc;
+   mutable std::shared_ptr<semgraph_extract> sge;
+
+   /// modules created on demand
+   typedef enum {M_MACO, M_SENSES, M_UKB, M_HMM, M_RELAX, M_PHON, M_NEC, M_PARSER, M_TXALA,
+                 M_TREELER, M_LSTM, M_SRL, M_COREF, M_SEMGRAPH, M_COUNT} module_id;
+   /// modules that initial_options provide files for
+   bool available[M_COUNT];
+   /// modules already created
+   mutable std::atomic<bool> loaded[M_COUNT];
+   /// serializes module creation
+   mutable boost::mutex load_sem;
 
    // store configuration options used to create the analyzer
    analyzer_config initial_options;
@@ -91,6 +111,15 @@ class WINDLL analyzer {
 
    /// auxiliary for constructors: load modules defined in initial_options
    void create_analyzers();
+   /// modules needed to analyze with given options
+   std::vector<module_id> needed_modules(const analyzer_invoke_options &ivk) const;
+   /// get module loaded from given file, shared with other analyzers
+   template<class T> static std::shared_ptr<T> load(const std::wstring &fname);
+   /// create given module
+   void create_module(module_id m) const;
+   /// warn about and clear morphological options that need modules
+   /// not set in initial_options, as maco::set_active_options does.
+   void check_maco_options(analyzer_invoke_options &opt) const;
 
    /// analyze further levels on a partially analyzed document
    template<class T> void do_analysis(T &doc, const analyzer_invoke_options &ivk) const;
@@ -112,6 +141,10 @@ class WINDLL analyzer {
    analyzer(const analyzer_config_options &cfg);
    ~analyzer();
 
+   /// create in advance the modules needed by given options
+   /// (otherwise, they are created when first needed)
+   void load_modules(const analyzer_invoke_options &ivk) const;
+
    const analyzer_config& get_initial_options() const;
    const analyzer_invoke_options& get_current_invoke_options() const;
    void set_current_invoke_options(const analyzer_invoke_options &opt);
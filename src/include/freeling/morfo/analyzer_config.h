@@ -88,6 +88,8 @@ namespace freeling {
          MACO_NPDataFile,  MACO_PunctuationFile, MACO_CompoundFile;
        bool MACO_InverseDictionary;
        double MACO_ProbabilityThreshold;
+       /// Size of the cache of dictionary annotations per form (0 = no cache)
+       int MACO_WordCacheSize;
        /// Phonetics config file
        std::wstring PHON_PhoneticsFile;
        /// NEC config file
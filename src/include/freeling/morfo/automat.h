@@ -35,6 +35,7 @@
 #include "freeling/morfo/language.h"
 #include "freeling/morfo/processor.h"
 #include "freeling/morfo/traces.h"
+#include "freeling/morfo/status_pool.h"
 
 namespace freeling {
 
@@ -194,7 +195,7 @@ namespace freeling {
 
       TRACE(3,L"Checking for mw starting at word '"+i->get_form()+L"'");
 
-      T *pst = new T();
+      T *pst = status_pool<T>::acquire();
       se.set_processing_status((processor_status *)pst);  
     
       // reset automaton
@@ -86,8 +86,17 @@ namespace freeling {
 
     /// chart table
     std::vector<cell> table;
+    /// cell used at each position: the one in the table, or the one
+    /// shared with the reference chart.
+    std::vector<const cell*> cells;
     /// dimension of the chart table (length of the sentece to parse)
     int size;
+    /// analyses loaded for each word, to find out which cells 
+    /// are equal to those of another chart for the same sentence
+    std::vector<std::wstring> signature;
+    /// chart for another tag sequence of the same sentence, 
+    /// whose cells can be shared (NULL if none)
+    const chart *ref;
     /// grammar to use
     const grammar &gram;
 
@@ -97,6 +106,8 @@ namespace freeling {
     std::list<std::pair<int,int> > cover (int a, int b) const;
     /// compute position of the cell inside the vector
     int index(int i, int j) const;
+    /// access cell (i,j)
+    const cell& at(int i, int j) const;
     /// find out whether the cell (i,j) has some inactive edge
     /// whose head is the given category 
     bool can_extend(const std::wstring &, int, int) const;
@@ -107,6 +118,8 @@ namespace freeling {
     bool check_match(const std::wstring &, const std::wstring &) const;
 
     void dump() const;
+    /// fill up first row of chart, sharing cells with given chart (if any)
+    void load(const sentence &, int, const chart *);
 
   public:
     /// constructor
@@ -119,6 +132,10 @@ namespace freeling {
 
     /// load sentece and init parsing (fill up first row of chart)
     void load_sentence(const sentence &, int k=0);
+    /// load sentece and init parsing, sharing cells with a chart already 
+    /// parsed for another tag sequence of the same sentence. The given
+    /// chart must outlive this one.
+    void load_sentence(const sentence &, int, const chart &);
 
     /// Do the parsing
     void parse();
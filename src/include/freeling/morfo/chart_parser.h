@@ -45,6 +45,8 @@ namespace freeling {
 
   private:
     grammar gram;
+    /// obtain the parse tree for the k-th tag sequence from a parsed chart
+    parse_tree build_tree(const chart &, sentence &, int) const;
 
   public:
     /// Constructors
@@ -75,6 +75,9 @@ namespace freeling {
     void replace_database(const std::wstring &, const std::wstring &);
     /// search for a string key in the DB, return associated string data.
     std::wstring access_database(const std::wstring &) const;
+    /// get the key as stored in the DB, valid while the entry is not removed.
+    /// NULL if not found, or if the DB type does not store keys as strings.
+    const std::wstring* stored_key(const std::wstring &) const;
     /// dump listing of database content to given stream
     void dump_database(std::wostream &, bool keysonly=false) const;
   };
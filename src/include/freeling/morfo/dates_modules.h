@@ -95,6 +95,28 @@ namespace freeling {
   // Value of unspecified fields in normalized date
   const std::wstring UNKNOWN_SYMB = L"??";
 
+  ////////////////////////////////////////////////////////////////
+  /// Sub matches of the last date/time regexp search: the searched
+  /// form and the span of each sub match. Substrings are only
+  /// extracted when used.
+  ////////////////////////////////////////////////////////////////
+
+  class re_matches {
+  public:
+    std::wstring form;
+    std::vector<regexp::span> spans;
+
+    /// number of sub matches (including the whole match)
+    size_t size() const { return spans.size(); }
+    /// forget last search
+    void clear() { spans.clear(); }
+    /// i-th sub match (empty if it did not take part in the match)
+    std::wstring operator[](size_t i) const {
+      if (spans[i].first<0) return L"";
+      return form.substr(spans[i].first, spans[i].second);
+    }
+  };
+
   ////////////////////////////////////////////////////////////////
   /// Class to store status information
   ////////////////////////////////////////////////////////////////
@@ -111,7 +133,7 @@ namespace freeling {
     int daytemp; // for special state Gbb in English
     bool inGbb; 
 
-    std::vector<std::wstring> rem;  // remember results of last matched RegEx
+    re_matches rem;  // remember results of last matched RegEx
   };
 
   ////////////////////////////////////////////////////////////////
@@ -138,7 +160,27 @@ namespace freeling {
     // to unify notation (01 -> 1), maybe adding an offset
     std::wstring normalize(const std::wstring &in, int offs=0) const;
 
+    /// shape classes of a token form, computed with a single scan
+    typedef enum {SH_NUMERIC=1, SH_DATESEP=2, SH_TIMESEP=4, SH_MINUTES=8, SH_ROMAN=16} token_shape;
+    /// classify given form in shape classes (bitwise-or of token_shape values).
+    /// Case is ignored, so the shape of the lowercased form holds for the original.
+    static int get_shape(const std::wstring &form);
+
+    /// search date/time regular expressions on given form, with the shape
+    /// computed by get_shape. The regexp is only run if the shape makes 
+    /// a match possible.
+    bool match_date(const std::wstring &form, int shape) const;
+    bool match_date(const std::wstring &form, int shape, re_matches &rem) const;
+    bool match_time1(const std::wstring &form, int shape, re_matches &rem) const;
+    bool match_time2(const std::wstring &form, int shape) const;
+    bool match_time2(const std::wstring &form, int shape, re_matches &rem) const;
+    bool match_roman(const std::wstring &form, int shape, re_matches &rem) const;
+
   private:
+    /// search given regexp if the form shape has all required classes
+    static bool match(const freeling::regexp &re, int required, const std::wstring &form, 
+                      int shape, re_matches *rem);
+
     virtual void ResetActions(dates_status *) const;
 
   public:
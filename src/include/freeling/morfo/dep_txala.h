@@ -31,6 +31,7 @@
 
 #include <string>
 #include <map>
+#include <unordered_map>
 #include <set>
 #include <vector>
 
@@ -49,9 +50,12 @@ namespace freeling {
 
   class dep_txala_status : public processor_status {
   public:
+    /// best rule found for each pair of adjacent chunks 
+    /// (NULL if it has to be computed again)
+    std::vector<const completer_rule*> best;
     /// precomputed last node matching the "last_left/right" condition
-    /// for a certain rule number
-    std::map<std::wstring,parse_tree::iterator> last;
+    /// of the best rule for each pair of adjacent chunks
+    std::vector<parse_tree::iterator> last;
 
     /// set of active flags, which control applicability of rules
     std::set<std::wstring> active_flags;
@@ -72,8 +76,14 @@ namespace freeling {
   private:
     // Root symbol used by the chunk parser when the tree is not complete.
     std::wstring start;
-    /// set of completer rules, indexed by labels of nodes
-    std::map<std::pair<std::wstring,std::wstring>,std::list<completer_rule> > chgram;
+    /// integer codes for chunk labels used in completer rules
+    std::unordered_map<std::wstring,unsigned int> label_codes;
+    /// set of completer rules, indexed by codes of the labels of both chunks
+    std::unordered_map<unsigned long long,std::list<completer_rule> > chgram;
+    /// rule applied when no completer rule matches
+    completer_rule default_rule;
+    /// number of chunks that rule contexts may check at each side (-1 if unbounded)
+    int left_reach, right_reach;
     // set of labeller rules
     std::map<std::wstring, std::list<labeler_rule> > rules;
     // "unique" labels for labeller
@@ -103,10 +113,12 @@ namespace freeling {
 
     /// tree-completing methods  ---------------------
 
+    /// get code for a chunk label, creating it if needed
+    unsigned int label_code(const std::wstring &);
     /// retrieve rule from grammar
-    completer_rule find_grammar_rule(const std::vector<parse_tree *> &, const size_t, dep_txala_status*) const;
+    const completer_rule* find_grammar_rule(const std::vector<parse_tree *> &, const size_t, dep_txala_status*, parse_tree::iterator &) const;
     /// apply a completion rule
-    parse_tree * applyRule(const completer_rule &, int, parse_tree*, parse_tree*, dep_txala_status*) const;
+    parse_tree * applyRule(const completer_rule &, parse_tree::iterator, parse_tree*, parse_tree*, dep_txala_status*) const;
     /// Extract values for requested atribute frm given node
     void extract_attrib(const std::wstring &attr, const std::list<parse_tree::const_iterator> &nds, std::list<std::wstring> &val) const;
     /// Locate actual node for given path
@@ -117,7 +129,7 @@ namespace freeling {
     /// check if the current context matches the given rule
     bool matching_context(const std::vector<parse_tree *> &, const size_t, const completer_rule &) const;
     /// check if the operation is executable (for last_left/last_right cases)
-    bool matching_operation(const std::vector<parse_tree *> &, const size_t, const completer_rule &, dep_txala_status*) const;
+    bool matching_operation(const std::vector<parse_tree *> &, const size_t, const completer_rule &, parse_tree::iterator &) const;
   /// Check if the chunk pair matches pair condition specified in the given rule.
     bool matching_pair(const std::vector<parse_tree *> &trees, const size_t chk, const completer_rule &r) const;
     /// check left or right context
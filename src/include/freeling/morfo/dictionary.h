@@ -30,7 +30,15 @@
 #define _DICTIONARY
 
 #include <map>
+#include <vector>
+#include <deque>
+#include <atomic>
+#include <memory>
+#include <unordered_map>
+#define BOOST_SYSTEM_NO_DEPRECATED
+#include <boost/thread/mutex.hpp>
 #include "freeling/windll.h"
+#include "freeling/lru_cache.h"
 #include "freeling/morfo/analyzer_config.h"
 #include "freeling/morfo/language.h"
 #include "freeling/morfo/processor.h"
@@ -66,9 +74,96 @@ namespace freeling {
       compounds *comp;
     #endif
 
-    /// key-value file or hash
+    /// index from (lemma,tag) pairs to the forms having them, for generation.
+    /// Forms are the keys stored in the forms database, lemmas and tags are 
+    /// interned, and each pair gets a slice of a single array of form ids.
+    class inverse_index {
+    public:
+      /// forms, by id. They point to the forms database keys, or to 'copies'
+      /// if the database does not keep its keys (DB_PREFTREE)
+      std::vector<const std::wstring*> forms;
+      std::deque<std::wstring> copies;
+      /// interned lemmas and tags
+      std::unordered_map<std::wstring,unsigned int> lemmas, tags;
+      /// (lemma<<32 | tag) -> (start,count) in form_ids
+      std::unordered_map<unsigned long long,std::pair<unsigned int,unsigned int> > postings;
+      std::vector<unsigned int> form_ids;
+      /// (pair, form id) collected while loading, until build is called
+      std::vector<std::pair<unsigned long long,unsigned int> > pending;
+
+      /// get id of a lemma or tag, adding it if new
+      static unsigned int intern(std::unordered_map<std::wstring,unsigned int> &, const std::wstring &);
+      /// add a form (and the stored copy, if any) and its (lemma, tags) pairs 
+      void add(const std::wstring &, const std::wstring *, 
+               const std::list<std::pair<std::wstring,std::list<std::wstring> > > &);
+      /// build postings from pending pairs
+      void build();
+      /// get forms for given lemma and tag
+      void get(const std::wstring &, const std::wstring &, std::vector<const std::wstring*> &) const;
+    };
+
+    /// key-value file or hash, and inverse index, as loaded at creation time (never modified afterwards)
     database *morfodb;
-    database *inverdb;
+    inverse_index *inverdb;
+
+    /// changes made to the dictionary after creation. Keys map to their
+    /// new data, an empty data meaning the key was removed.
+    class changes {
+    public:
+      std::unordered_map<std::wstring,std::wstring> forms;
+      /// forms for each changed "lemma#tag" (empty if none remain)
+      std::unordered_map<std::wstring,std::vector<std::wstring> > inverse;
+    };
+    /// an immutable version of all changes. Recent changes are checked first,
+    /// and compacted into settled changes when they grow too large.
+    class version {
+    public:
+      unsigned long epoch;
+      std::shared_ptr<const changes> settled, recent;
+    };
+    /// current version, replaced atomically by writers. Readers keep using 
+    /// the version they got, so they never need a lock.
+    std::shared_ptr<const version> current;
+    /// epoch of current version, to let readers detect updates cheaply
+    std::atomic<unsigned long> epoch;
+    /// identifier of this instance, for per-thread version caching
+    unsigned long instance;
+    /// serializes writers
+    boost::mutex update_sem;
+
+    /// get current version 
+    std::shared_ptr<const version> get_version() const;
+    /// look up a form in forms database, applying given changes
+    std::wstring access(const std::wstring &, const changes &, const changes &) const;
+    /// look up forms for a lemma and tag in inverse index, applying given changes
+    void access_inverse(const std::wstring &, const std::wstring &, const changes &, const changes &,
+                        std::vector<const std::wstring*> &) const;
+    /// record in given changes a new analysis of a form, for the inverse index
+    void add_inverse(const std::wstring &, const analysis &, changes &, const changes &) const;
+    /// publish a new version with given recent changes
+    void publish(const std::shared_ptr<const version> &, changes *);
+
+    /// result of annotating a form with no previous analysis
+    class cached_annotation {
+    public:
+      /// analysis found for the form
+      std::list<analysis> la;
+      /// whether the word got locked, and modules that analyzed it
+      bool locked;
+      unsigned analyzed_by;
+      /// whether the form is a contraction, and its components
+      bool contraction;
+      std::list<word> components;
+      /// dictionary epoch when the annotation was computed
+      unsigned long epoch;
+    };
+    /// cache of annotations, keyed by form and active options (NULL if disabled)
+    lru_cache<std::wstring,cached_annotation> *wcache;
+    /// cache statistics
+    mutable std::atomic<unsigned long> cache_hits, cache_misses;
+
+    /// annotate a word with no analysis, using the cache if enabled
+    bool annotate_word_cached(word &, std::list<word> &, const analyzer_invoke_options &opts) const;
 
     /// check whether the word is a contraction, and if so, fill the
     /// list with the contracted words
@@ -96,9 +191,11 @@ namespace freeling {
     /// get configuration being used by default
     const analyzer_invoke_options& get_current_invoke_options() const;
 
-    /// add analysis to dictionary entry (create entry if not there)
+    /// add analysis to dictionary entry (create entry if not there).
+    /// Safe to call while other threads are using the dictionary.
     void add_analysis(const std::wstring &, const analysis &);
-    /// remove entry from dictionary
+    /// remove entry from dictionary.
+    /// Safe to call while other threads are using the dictionary.
     void remove_entry(const std::wstring &);
     
     /// Get dictionary entry for a given form, add to given list.
@@ -116,10 +213,17 @@ namespace freeling {
     void annotate_word(word &) const;
     /// Get possible forms for a lemma+pos
     std::list<std::wstring> get_forms(const std::wstring &, const std::wstring &) const;
+    /// Get possible forms for a lemma+pos, without copying them. Pointed forms
+    /// are valid while the dictionary exists and the returned handle is kept,
+    /// even if the dictionary is modified meanwhile.
+    std::shared_ptr<const void> get_forms(const std::wstring &, const std::wstring &, std::vector<const std::wstring*> &) const;
 
     /// dump dictionary to a buffer. Either full entries or keys only
     void dump_dictionary(std::wostream &, bool keysonly=false) const;
 
+    /// get number of cache hits and misses so far (both zero if cache is disabled)
+    void get_cache_stats(unsigned long &, unsigned long &) const;
+
     /// analyze given sentence with given options
     void analyze(sentence &se, const analyzer_invoke_options &opts) const;
     /// analyze given sentence with default options
@@ -52,9 +52,9 @@ namespace freeling {
     /// for each rule id, store list of features extracted 
     /// for each word in sentence
     std::map<std::wstring,std::map<int,std::list<std::wstring> > > features;
-    /// for each condition id that requires it, store substrings
-    /// matching latest regex application
-    std::map<std::wstring,std::vector<std::wstring> > re_result;
+    /// for each condition id that requires it, store the string matched
+    /// by latest regex application, and the spans of its substrings
+    std::map<std::wstring,std::pair<std::wstring,std::vector<freeling::regexp::span> > > re_result;
   };
 
   ////////////////////////////////////////////////////////////////
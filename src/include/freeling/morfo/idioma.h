@@ -102,6 +102,12 @@ namespace freeling {
     std::wstring get_language_code() const;
     /// get maximum allowed perplexity
     double get_threshold() const;
+    /// get order of ngram model
+    int get_order() const;
+    /// get phantom char used for initial states
+    wchar_t get_phantom() const;
+    /// get ngram model
+    const smoothingLD<std::wstring,wchar_t> &get_smoothing() const;
   };
 
 } // namespace
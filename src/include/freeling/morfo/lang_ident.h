@@ -42,6 +42,7 @@
 
 #include "freeling/windll.h"
 #include "freeling/morfo/idioma.h"
+#include "freeling/morfo/lang_scorer.h"
 
 namespace freeling {
 
@@ -49,7 +50,8 @@ namespace freeling {
   /// Class "lang_ident" checks a text against all known languages
   /// and sorts the results by probability.
   /// It creates an instance of "idioma" for each known language, and
-  /// checks input text against all existing instances.
+  /// merges their models in a "lang_scorer", so the input text is 
+  /// checked against all languages in a single pass.
   //////////////////////////////////////////////////////////////
 
   class WINDLL lang_ident {
@@ -58,10 +60,26 @@ namespace freeling {
     std::map<std::wstring,idioma*> idiomes;
     std::set<std::wstring> all_known_languages;
 
+    /// combined models, one for each group of languages with the same order and phantom
+    std::vector<lang_scorer*> scorers;
+    /// scorer and position in it for each language
+    std::map<std::wstring,std::pair<size_t,size_t> > scorer_index;
+
+    /// identify_language stops scoring when the best language log probability
+    /// is stop_margin over the second, after at least stop_minlen chars.
+    size_t stop_minlen;
+    double stop_margin;
+
+    /// load given language from given model file, without rebuilding scorers
+    void load_language(const std::wstring &modelfile);
+    /// rebuild combined models for current languages
+    void build_scorers();
+
     /// fill a vector with unsorted perplexities for each language in given set
     void language_perplexities (std::vector<std::pair<double,std::wstring> > &, 
                                 const std::wstring &, 
-                                const std::set<std::wstring>&) const;
+                                const std::set<std::wstring>&,
+                                bool early_stop=false) const;
 
   public:
     /// Build an empty language identifier.
@@ -72,6 +90,8 @@ namespace freeling {
     ~lang_ident();
     /// load given language from given model file, add to existing languages.
     void add_language(const std::wstring &modelfile);
+    /// set early stop parameters for identify_language (margin<=0 disables it)
+    void set_early_stop(size_t minlen, double margin);
     /// train a model for a language, store in modelFile, and add 
     /// it to the known languages list.
     void train_language(const std::wstring &textfile, const std::wstring &modelfile, 
@@ -0,0 +1,122 @@
+//////////////////////////////////////////////////////////////////
+//
+//    Copyright (C) 2014   TALP Research Center
+//                         Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU Affero General Public License
+//    (GNU AGPL) as published by the Free Software Foundation; either
+//    version 3 of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+//    Affero General Public License for more details.
+//
+//    You should have received a copy of the GNU Affero General Public License 
+//    along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: Muntsa Padro (mpadro@lsi.upc.edu)
+//             TALP Research Center
+//             despatx Omega.S107 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+////////////////////////////////////////////////////////////////
+
+// /////////////////////////////////
+//
+//  lang_scorer.h
+//
+//  Class that scores a text against several language ngram
+//  models in a single pass.
+//
+///////////////////////////////////
+
+#ifndef _LANG_SCORER_H
+#define _LANG_SCORER_H
+
+#include <vector>
+#include <string>
+
+#include "freeling/morfo/idioma.h"
+
+namespace freeling {
+
+  //////////////////////////////////////////////////////////////
+  /// Class "lang_scorer" merges the ngram models of several languages
+  /// sharing the same order and phantom char into a single hash table.
+  /// Each ngram in the table holds the (log) counts for the languages
+  /// where it was observed, so the text is traversed only once, and 
+  /// each position collects the smoothed probabilities of all languages
+  /// with a few table lookups. Results are the same than calling 
+  /// idioma::sequence_probability for each language.
+  //////////////////////////////////////////////////////////////
+
+  class lang_scorer {
+  private:
+    /// ngram entry in the table
+    class ngram_entry {
+    public:
+      /// hash value of the ngram
+      unsigned long long hash;
+      /// ngram chars (position in key pool and length)
+      unsigned int key;
+      unsigned int keylen;
+      /// (language,logcount) pairs (position in score pool and length)
+      unsigned int first;
+      unsigned int nscores;
+    };
+
+    /// order of ngram models, and phantom char
+    size_t order;
+    wchar_t phantom;
+
+    /// open addressing index on entries (-1 == empty slot)
+    std::vector<int> slots;
+    size_t shift;
+    std::vector<ngram_entry> entries;
+    /// chars of all ngrams
+    std::vector<wchar_t> keys;
+    /// per-ngram language log counts, sorted by language
+    std::vector<std::pair<unsigned int,double> > scores;
+
+    /// smoothing parameters for each language
+    std::vector<double> alpha, notalpha, unseen, nobs;
+
+    /// slot holding the entry with given hash and chars, or the empty slot where it should go
+    size_t probe(unsigned long long h, const wchar_t *s, size_t len) const;
+    /// locate entry with given hash and chars, -1 if not found
+    int find(unsigned long long h, const wchar_t *s, size_t len) const;
+    /// log count of given ngram entry for given language, -1 if not seen
+    double count(int e, unsigned int lang) const;
+    /// hash of given string
+    static unsigned long long hash(const std::wstring &);
+    /// (re)build slots index for current entries
+    void rehash(size_t n);
+
+  public:
+    /// Build a combined model for given languages. They must all have 
+    /// the same order and phantom char.
+    lang_scorer(const std::vector<const idioma*> &);
+    /// destructor
+    ~lang_scorer();
+
+    /// order of the ngram models
+    size_t get_order() const;
+    /// phantom char of the ngram models
+    wchar_t get_phantom() const;
+    /// number of merged languages
+    size_t num_languages() const;
+
+    /// Compute log probability of given text for each language with active[l] set.
+    /// Returns the number of transitions scored. If margin>0, scoring stops
+    /// once the distance between the best and second best language is over
+    /// the margin, if at least minlen transitions were scored.
+    size_t score(const std::wstring &text, const std::vector<bool> &active,
+                 std::vector<double> &logprob, size_t minlen=0, double margin=0) const;
+  };
+
+} // namespace
+
+#endif
@@ -34,6 +34,7 @@
 #include <vector>
 #include <set>
 #include <map>
+#include <unordered_map>
 
 #include "freeling/regexp.h"
 #include "freeling/windll.h"
@@ -161,6 +162,8 @@ namespace freeling {
     float get_probability() const;
     /// Whether the alternative is selected in the kbest path or not
     bool is_selected(int k = 1) const;
+    /// Get the largest kbest sequence index the alternative is selected in
+    int max_kbest() const;
     /// Clear the kbest selections
     void clear_selections();
     /// Add a kbest selection
@@ -505,14 +508,24 @@ namespace freeling {
   class WINDLL parse_tree : public tree<node> {
   private:
     // access nodes by id
-    std::map<std::wstring,parse_tree::iterator> node_index;
+    std::unordered_map<std::wstring,parse_tree::iterator> node_index;
     // acces leaf nodes by word position
     std::vector<parse_tree::iterator> word_index;
+    // take over indexes from a tree whose nodes were moved to this one
+    void take_index(parse_tree &);
 
   public:
     parse_tree();
     parse_tree(parse_tree::const_iterator p);
     parse_tree(const node &);
+    /// copy (indexes are rebuilt on the copy)
+    parse_tree(const parse_tree &);
+    /// move (nodes and indexes are taken over, not copied)
+    parse_tree(parse_tree &&);
+    /// assignment
+    parse_tree& operator=(const parse_tree &);
+    /// move assignment
+    parse_tree& operator=(parse_tree &&);
 
     /// assign an id to each node and build index
     void build_node_index(const std::wstring &);
@@ -589,10 +602,20 @@ namespace freeling {
   private:
     // acces nodes by word position
     std::vector<dep_tree::iterator> word_index;
+    // take over index from a tree whose nodes were moved to this one
+    void take_index(dep_tree &);
 
   public:
     dep_tree();
     dep_tree(const depnode &);
+    /// copy (index is rebuilt on the copy)
+    dep_tree(const dep_tree &);
+    /// move (nodes and index are taken over, not copied)
+    dep_tree(dep_tree &&);
+    /// assignment
+    dep_tree& operator=(const dep_tree &);
+    /// move assignment
+    dep_tree& operator=(dep_tree &&);
 
     /// get depnode corresponding to word in given position
     dep_tree::const_iterator get_node_by_pos(size_t) const;
@@ -621,6 +644,9 @@ namespace freeling {
   public:
     processor_status();
     virtual ~processor_status() {};
+    /// dispose of the status when the sentence pops it.
+    /// By default it is deleted, pooled statuses go back to their pool.
+    virtual void release();
   };
 
 
@@ -750,14 +776,18 @@ namespace freeling {
     bool is_tagged() const;
 
     void set_parse_tree(const parse_tree &, int k=0);
+    void set_parse_tree(parse_tree &&, int k=0);
     parse_tree & get_parse_tree(int k=0);
     const parse_tree & get_parse_tree(int k=0) const;
     bool is_parsed() const;
+    bool has_parse_tree(int k) const;
 
     void set_dep_tree(const dep_tree &, int k=0);
+    void set_dep_tree(dep_tree &&, int k=0);
     dep_tree & get_dep_tree(int k=0);
     const dep_tree & get_dep_tree(int k=0) const;
     bool is_dep_parsed() const;
+    bool has_dep_tree(int k) const;
 
     /// get status at the top of stack
     processor_status* get_processing_status();
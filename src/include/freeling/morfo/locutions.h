@@ -31,6 +31,8 @@
 
 #include <map> 
 #include <set> 
+#include <vector> 
+#include <unordered_map> 
 
 #include "freeling/windll.h"
 #include "freeling/morfo/language.h"
@@ -45,8 +47,8 @@ namespace freeling {
 
   class WINDLL locutions_status : public automat_status {
   public:
-    /// partially build multiword.
-    std::set<std::wstring> acc_mw,longest_mw;
+    /// partially build multiword (as nodes in the multiword trie).
+    std::set<int> acc_mw,longest_mw;
     /// store mw components in case we need to recover them
     std::vector<sentence::const_iterator> components;
     /// count words scanned beyond last longest mw found.
@@ -64,16 +66,34 @@ namespace freeling {
 
   class WINDLL locutions: public automat<locutions_status> {
   private:
-    /// store multiword list
-    std::map<std::wstring,std::wstring> locut;
-    /// store multiword prefixes
-    std::set<std::wstring> prefixes;
+    /// node in the multiword trie. There is a node for each
+    /// multiword prefix (xxx, xxx_yyy, ...)
+    class mw_node {
+    public:
+      /// prefix leading to this node (e.g. xxx_yyy)
+      std::wstring key;
+      /// whether the prefix is a complete multiword
+      bool complete;
+      /// multiword analysis data, if complete
+      std::wstring data;
+    };
+    /// multiword trie. Node 0 is the root.
+    std::vector<mw_node> trie;
+    /// trie transitions, indexed by node and component symbol
+    std::unordered_map<unsigned long long,int> transitions;
+    /// interned multiword components (forms, <lemmas>, tags, *)
+    std::unordered_map<std::wstring,int> symbols;
+    /// symbols for lemma components, indexed without the <> brackets
+    std::unordered_map<std::wstring,int> lemma_symbols;
     /// Tagset handling modul
     tagset *Tags;
     /// Whether to check all analysis for lemma and PoS conditions, or just selected ones.
     bool OnlySelected;
 
-    bool check(const std::wstring &, std::set<std::wstring> &, bool &, bool &, locutions_status *) const;
+    int next_node(int, const std::wstring &) const;
+    int next_node_lemma(int, const std::wstring &) const;
+    int next_node_symbol(int, int) const;
+    bool check(int, std::set<int> &, bool &, bool &, locutions_status *) const;
     int ComputeToken(int, sentence::iterator &, sentence &) const;
     void ResetActions(locutions_status *) const;
     void StateActions(int, int, int, sentence::const_iterator, locutions_status *) const;
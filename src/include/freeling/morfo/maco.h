@@ -92,6 +92,9 @@ namespace freeling {
                             bool dic, bool aff, bool comp, bool rtk,
                             bool mw, bool ner, bool qt, bool prb);
 
+    /// get hits and misses of the dictionary annotation cache (see WordCacheSize option)
+    void get_word_cache_stats(unsigned long &hits, unsigned long &misses) const;
+
     /// analyze given sentence with given options
     void analyze(sentence &s, const analyzer_invoke_options &opts) const;
     /// analyze given sentence with default options
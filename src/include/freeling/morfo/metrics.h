@@ -0,0 +1,128 @@
+//////////////////////////////////////////////////////////////////
+//
+//    FreeLing - Open Source Language Analyzers
+//
+//    Copyright (C) 2014   TALP Research Center
+//                         Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU Affero General Public
+//    License as published by the Free Software Foundation; either
+//    version 3 of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Affero General Public License for more details.
+//
+//    You should have received a copy of the GNU Affero General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: Lluis Padro (padro@lsi.upc.es)
+//             TALP Research Center
+//             despatx C6.212 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+////////////////////////////////////////////////////////////////
+
+#ifndef _METRICS
+#define _METRICS
+
+#include <string>
+#include <list>
+#include <atomic>
+#include <chrono>
+#include <typeinfo>
+
+#include "freeling/windll.h"
+#include "freeling/morfo/language.h"
+
+namespace freeling {
+
+  ////////////////////////////////////////////////////////////////
+  ///
+  ///  Process-wide registry of per-module performance counters:
+  ///  calls, sentences, tokens, wall time and a latency histogram.
+  ///
+  ///  Each thread updates its own counters, so recording takes
+  ///  no locks. Exports add up the counters of all threads.
+  ///  Recording is off by default, and costs one flag check
+  ///  per call while it stays off.
+  ///
+  ////////////////////////////////////////////////////////////////
+
+  class WINDLL metrics {
+
+  public:
+    /// turn recording on or off
+    static void enable(bool b=true);
+    /// find out whether recording is on
+    static bool is_enabled() { return enabled.load(std::memory_order_relaxed); }
+
+    /// add a call of given module, taking given microseconds
+    static void record(const char *module, bool is_type, unsigned long usecs,
+                       unsigned long nsent, unsigned long ntok);
+    /// set all counters to zero
+    static void reset();
+
+    /// dump counters in Prometheus text exposition format
+    static std::wstring to_prometheus();
+    /// dump counters as a JSON object
+    static std::wstring to_json();
+
+    ////////////////////////////////////////////////////////////////
+    /// Times the scope where it lives, and records it as one call
+    /// of given module when the scope is left.
+    ////////////////////////////////////////////////////////////////
+
+    class probe {
+    private:
+      const char *module;
+      bool is_type;
+      bool active;
+      unsigned long nsent, ntok;
+      std::chrono::steady_clock::time_point start;
+
+    public:
+      /// probe for a module given by name (must be a literal or outlive the registry)
+      probe(const char *m) : module(m), is_type(false), active(is_enabled()), nsent(0), ntok(0) {
+        if (active) start = std::chrono::steady_clock::now();
+      }
+      /// probe for a module given by its class (e.g. typeid(*this))
+      probe(const std::type_info &t) : module(t.name()), is_type(true), active(is_enabled()), nsent(0), ntok(0) {
+        if (active) start = std::chrono::steady_clock::now();
+      }
+      ~probe() {
+        if (not active) return;
+        std::chrono::microseconds us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now()-start);
+        record(module, is_type, us.count(), nsent, ntok);
+      }
+
+      /// count sentences and tokens processed in this call
+      void count(unsigned long ns, unsigned long nt) {
+        nsent += ns;
+        ntok += nt;
+      }
+      void count(const sentence &s) {
+        if (not active) return;
+        nsent++;
+        ntok += s.size();
+      }
+      void count(const std::list<sentence> &ls) {
+        if (not active) return;
+        for (std::list<sentence>::const_iterator s=ls.begin(); s!=ls.end(); s++) count(*s);
+      }
+      void count(const document &doc) {
+        if (not active) return;
+        for (document::const_iterator p=doc.begin(); p!=doc.end(); p++) count(*p);
+      }
+    };
+
+  private:
+    static std::atomic<bool> enabled;
+  };
+
+} // namespace
+
+#endif
@@ -0,0 +1,94 @@
+//////////////////////////////////////////////////////////////////
+//
+//    FreeLing - Open Source Language Analyzers
+//
+//    Copyright (C) 2014   TALP Research Center
+//                         Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU Affero General Public
+//    License as published by the Free Software Foundation; either
+//    version 3 of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Affero General Public License for more details.
+//
+//    You should have received a copy of the GNU Affero General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: Lluis Padro (padro@lsi.upc.es)
+//             TALP Research Center
+//             despatx C6.212 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+////////////////////////////////////////////////////////////////
+
+#ifndef _MODEL_REGISTRY
+#define _MODEL_REGISTRY
+
+#include <string>
+#include <memory>
+#include <functional>
+#include <typeinfo>
+
+#define BOOST_SYSTEM_NO_DEPRECATED
+#include <boost/thread/mutex.hpp>
+
+#include "freeling/windll.h"
+
+namespace freeling {
+
+  ////////////////////////////////////////////////////////////////
+  ///
+  ///  Process-wide registry of loaded models, so that analyzers
+  ///  using the same data files (e.g. two configurations of the
+  ///  same language) share one copy of each module.
+  ///
+  ///  Models are kept by key (class, canonical file names and
+  ///  creation options) and reference counted: a model is freed
+  ///  when the last holder releases it, and loaded again if
+  ///  requested later. Each key is loaded once even if several
+  ///  threads ask for it at the same time, while different keys
+  ///  load concurrently.
+  ///
+  ////////////////////////////////////////////////////////////////
+
+  class WINDLL model_registry {
+
+  public:
+    /// get the model of class T stored under given key,
+    /// creating it with 'create' if nobody holds it.
+    template<class T>
+    static std::shared_ptr<T> get(const std::wstring &key, const std::function<T*()> &create) {
+      const char *type = typeid(T).name();
+      std::shared_ptr<boost::mutex> sem = key_lock(type, key);
+      boost::mutex::scoped_lock lock(*sem);
+
+      std::shared_ptr<void> m = find(type, key);
+      if (m) return std::static_pointer_cast<T>(m);
+
+      std::shared_ptr<T> p(create());
+      store(type, key, p);
+      return p;
+    }
+
+    /// canonical form of a file name (absolute, no symlinks), to build keys
+    static std::wstring canonical(const std::wstring &fname);
+    /// number of models currently held by someone
+    static size_t size();
+
+  private:
+    /// mutex serializing the creation of the model with given key
+    static std::shared_ptr<boost::mutex> key_lock(const char *type, const std::wstring &key);
+    /// model stored under given key, if still alive
+    static std::shared_ptr<void> find(const char *type, const std::wstring &key);
+    /// remember model under given key
+    static void store(const char *type, const std::wstring &key, const std::shared_ptr<void> &model);
+  };
+
+} // namespace
+
+#endif
@@ -33,7 +33,7 @@
 #include <map>
 #include <vector>
 
-#include "freeling/safe_map.h"
+#include "freeling/lru_cache.h"
 #include "freeling/regexp.h"
 #include "freeling/morfo/processor.h"
 
@@ -52,6 +52,9 @@ namespace freeling {
     /// in which context
     std::wstring env;
     freeling::regexp re_env;
+    /// text (or set of chars, for set-replacement rules) that must be in 
+    /// the word for the rule to match. Empty if unknown (rule always tried)
+    std::wstring trigger;
 
     ph_rule();
     ~ph_rule();
@@ -78,8 +81,8 @@ namespace freeling {
     std::vector<rule_set> RuleSets;
 
     /// internal caches with phonetic translation of already 
-    /// seen words. One cache for each ruleset
-    std::vector<safe_map<std::wstring, std::wstring> *> Cache;
+    /// seen words. One bounded cache for each ruleset
+    std::vector<lru_cache<std::wstring, std::wstring> *> Cache;
 
     /// exceptions. Words with direct sound encoding
     std::map<std::wstring, std::wstring> Exceptions;
@@ -31,6 +31,8 @@
 #define _PROBABILITIES
 
 #include <map>
+#include <vector>
+#include <unordered_map>
 
 #include "freeling/windll.h"
 #include "freeling/morfo/language.h"
@@ -75,8 +77,20 @@ namespace freeling {
     std::map<std::wstring,std::map<std::wstring,double> > lexical_tags;
     /// list of tags and probabilities to assign to unknown words
     std::map<std::wstring,double> unk_tags;
-    /// list of tag frequencies for unknown word suffixes
-    std::map<std::wstring,std::map<std::wstring,double> > unk_suffs;
+    /// node in the trie of unknown word suffixes
+    class suffix_node {
+    public:
+      /// whether the suffix leading to this node was in the model
+      bool present;
+      /// tag probabilities for this suffix, as (tag id,prob), sorted by tag id
+      std::vector<std::pair<int,double> > probs;
+    };
+    /// ids for tags appearing in suffix probabilities
+    std::map<std::wstring,int> suff_tags;
+    /// trie of unknown word suffixes, built on reversed words (root at 0)
+    std::vector<suffix_node> suff_nodes;
+    /// trie transitions, keyed by (node<<32 | char)
+    std::unordered_map<unsigned long long,int> suff_trans;
     /// unknown words suffix smoothing parameter;
     double theeta;
     /// length of longest suffix
@@ -89,8 +103,12 @@ namespace freeling {
 
     /// Smooth probabilities for the analysis of given word
     void smoothing(word &) const;
+    /// add a suffix with its tag probabilities to the suffix trie
+    void add_suffix(const std::wstring &, const std::map<std::wstring,double> &);
+    /// trie nodes for the suffixes of given word, shortest first
+    void suffix_path(const std::wstring &, std::vector<int> &) const;
     /// Compute p(tag|suffix) using recursively shorter suffixes.
-    double compute_probability(const std::wstring &, double, const std::wstring &) const;
+    double compute_probability(const std::wstring &, double, const std::vector<int> &) const;
     /// Guess possible tags, keeping some mass for previously assigned tags    
     void guesser(word &, double mass=1.0) const;
     /// compare two analysis to set the right order of preference
@@ -34,6 +34,7 @@
 #include "freeling/windll.h"
 #include "freeling/morfo/language.h"
 #include "freeling/morfo/analyzer_config.h"
+#include "freeling/morfo/metrics.h"
 
 namespace freeling {
 
@@ -63,18 +64,22 @@ namespace freeling {
 
     /// analyze list of sentences (paragraph)
     virtual void analyze(std::list<sentence> &ls) const {
+      metrics::probe p(typeid(*this));
       std::list<sentence>::iterator is;
       for (is=ls.begin(); is!=ls.end(); is++) {
         analyze(*is);    
       }
+      p.count(ls);
     }
 
     /// analyze list of sentences (paragraph) with given options
     virtual void analyze(std::list<sentence> &ls, const analyzer_invoke_options &opt) const {
+      metrics::probe p(typeid(*this));
       std::list<sentence>::iterator is;
       for (is=ls.begin(); is!=ls.end(); is++) {
         analyze(*is, opt);    
       }
+      p.count(ls);
     }
 
     /// analyze document
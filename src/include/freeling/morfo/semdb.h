@@ -31,6 +31,8 @@
 
 #include <string>
 #include <list>
+#include <vector>
+#include <unordered_map>
 
 #include "freeling/windll.h"
 #include "freeling/morfo/database.h"
@@ -95,6 +97,18 @@ namespace freeling {
     database *sensesdb;
     database *wndb;
 
+    /// interned sense codes, indexed by sense id
+    std::vector<std::wstring> sense_codes;
+    /// compiled index lemma -> (WN PoS, sense ids)
+    std::unordered_map<std::wstring,std::vector<std::pair<std::wstring,std::vector<int> > > > word_senses;
+    /// whether some posmap rule uses the word form, so it is part of memo keys
+    bool form_in_key;
+    /// unique id for this instance, to tell apart its entries in the memo
+    unsigned long instance;
+
+    /// append senses for given lemma and WN PoS to given list
+    void lookup_senses(const std::wstring &, const std::wstring &, std::list<std::wstring> &) const;
+
   public:
     /// Constructor
     semanticDB(const std::wstring &); 
@@ -31,6 +31,7 @@
 
 #include <string>
 #include <list>
+#include <atomic>
 
 #include "freeling/windll.h"
 #include "freeling/morfo/language.h"
@@ -49,6 +50,11 @@ namespace freeling {
     bool duplicate;
     /// sense information
     semanticDB *semdb;
+    /// whether user was warned about duplicate being ignored
+    mutable std::atomic<bool> warned;
+
+    /// annotate senses, duplicating analysis if requested
+    void annotate(sentence &, bool) const;
 
   public:
     /// Constructor
@@ -63,6 +69,9 @@ namespace freeling {
     
     /// analyze given sentence
     void analyze(sentence &) const;
+    /// analyze given sentence with given options. Analysis are not 
+    /// duplicated if the requested output level is TAGGED or beyond.
+    void analyze(sentence &, const analyzer_invoke_options &) const;
 
     /// inherit other methods
     using processor::analyze;
@@ -194,6 +194,16 @@ namespace freeling {
     /// destructor
     
     ~smoothingLD() {}
+
+    //////////////////////////////////////////
+    /// Access model parameters (all in log form), e.g. to 
+    /// merge several models in a single table
+
+    const std::map<G,double>& get_counts() const { return counts; }
+    double get_alpha() const { return alpha; }
+    double get_notalpha() const { return notalpha; }
+    double get_unseen() const { return pUnseen; }
+    double get_nobs() const { return nobs; }
          
     //////////////////////////////////////////
     /// Compute smoothed conditional log prob of seeing 
@@ -62,8 +62,10 @@ class WINDLL srl_treeler : public freeling::srl_parser {
   /// Destructor
   ~srl_treeler();
 
-  /// Analyze given sentences
+  /// Analyze given sentence
   void analyze(freeling::sentence &) const;
+  /// Analyze given sentences, in parallel (see util::parallel_for)
+  void analyze(std::list<freeling::sentence> &) const;
 
   /// inherit other methods
   using processor::analyze;
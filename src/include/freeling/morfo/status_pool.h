@@ -0,0 +1,90 @@
+////////////////////////////////////////////////////////////////
+//
+//    FreeLing - Open Source Language Analyzers
+//
+//    Copyright (C) 2014   TALP Research Center
+//                         Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU Affero General Public
+//    License as published by the Free Software Foundation; either
+//    version 3 of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Affero General Public License for more details.
+//
+//    You should have received a copy of the GNU Affero General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: Lluis Padro (padro@lsi.upc.es)
+//             TALP Research Center
+//             despatx C6.212 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+////////////////////////////////////////////////////////////////
+
+#ifndef _STATUS_POOL
+#define _STATUS_POOL
+
+#include <vector>
+
+#include "freeling/morfo/language.h"
+
+namespace freeling {
+
+  ////////////////////////////////////////////////////////////////
+  ///
+  ///  Per-thread pool of processor status objects.
+  ///
+  ///  Processors that push a status on the sentence for each word
+  ///  or each sentence they handle (e.g. automat) get it from here
+  ///  instead of allocating a new one. When the sentence pops the
+  ///  status, it goes back to the free list of the calling thread,
+  ///  keeping the buffers of its string and vector members.
+  ///
+  ////////////////////////////////////////////////////////////////
+
+  template <class T> 
+  class status_pool {
+  private:
+    /// pooled status, returned to the pool instead of deleted
+    class pooled_status : public T {
+    public:
+      void release() { status_pool<T>::free_list().push_back(this); }
+    };
+
+    /// free list, owns the pooled objects until thread exit
+    class holder {
+    public:
+      std::vector<pooled_status*> items;
+      ~holder() { 
+        for (typename std::vector<pooled_status*>::iterator p=items.begin(); p!=items.end(); p++) 
+          delete *p; 
+      }
+    };
+
+    static std::vector<pooled_status*>& free_list() {
+      static thread_local holder h;
+      return h.items;
+    }
+
+  public:
+    /// get a status object, in the same state as a newly created T()
+    static T* acquire() {
+      std::vector<pooled_status*> &fl = free_list();
+      if (fl.empty()) return new pooled_status();
+
+      static const T blank = T();
+      pooled_status *p = fl.back();
+      fl.pop_back();
+      static_cast<T&>(*p) = blank;
+      return p;
+    }
+  };
+
+} // namespace
+
+#endif
@@ -32,6 +32,9 @@
 #include <string>
 #include <set>
 #include <map>
+#include <list>
+#include <vector>
+#include <unordered_map>
 
 #include "freeling/morfo/language.h"
 #include "freeling/morfo/accents.h"
@@ -56,24 +59,39 @@ namespace freeling {
     accents accen;
     const dictionary& dic;
 
-    /// all suffixation/prefixation rules
-    std::multimap<std::wstring,sufrule> affix[2];
-    /// suffixation/prefixation rules applied unconditionally
-    std::multimap<std::wstring,sufrule> affix_always[2];
-
-    /// index of existing suffix/prefixs lengths.
-    std::set<unsigned int> ExistingLength[2];
-    /// Length of longest suffix/prefix.
-    unsigned int Longest[2];
-
-    /// find all applicable affix rules for a word
-    void look_for_affixes_in_list (int, const std::multimap<std::wstring,sufrule> &, word &) const;
+    /// node of an affix trie: rules for the affix spelled by the path to the node
+    class affix_node {
+    public:
+      /// all rules for this affix
+      std::vector<const sufrule*> all;
+      /// rules for this affix applied unconditionally
+      std::vector<const sufrule*> always;
+    };
+
+    /// all suffixation/prefixation rules, in file order (addresses must be stable)
+    std::list<sufrule> rules[2];
+    /// affix tries: suffixes are inserted reversed, prefixes forward. Node 0 is the root.
+    std::vector<affix_node> trie[2];
+    /// trie transitions, keyed by (node<<32 | char)
+    std::unordered_map<unsigned long long,int> trans[2];
+
+    /// affixes found in a word: (affix length, applicable rules), by increasing length
+    typedef std::vector<std::pair<unsigned int,const std::vector<const sufrule*>*> > affix_matches;
+    /// dictionary lookups already performed for the current word
+    typedef std::unordered_map<std::wstring,std::list<analysis> > root_cache;
+
+    /// add a rule to the trie of given kind
+    void add_rule(int, const std::wstring &, const sufrule &);
+    /// walk the trie of given kind along the word, collecting matching affixes
+    void find_affixes(int, const std::wstring &, bool, affix_matches &) const;
+    /// apply rules for all found affixes of one kind to the word
+    void look_for_affixes_in_list (int, const affix_matches &, word &, root_cache &) const;
     /// find all applicable prefix+sufix rules combination for a word
-    void look_for_combined_affixes(const std::multimap<std::wstring,sufrule> &, const std::multimap<std::wstring,sufrule> &, word &) const;
+    void look_for_combined_affixes(const affix_matches &, const affix_matches &, word &, root_cache &) const;
     /// generate roots according to rules.
     std::set<std::wstring> GenerateRoots(int, const sufrule &, const std::wstring &) const;
     /// find roots in dictionary and apply matching rules
-    void SearchRootsList(std::set<std::wstring> &, const std::wstring &, const sufrule &, word &) const;
+    void SearchRootsList(std::set<std::wstring> &, const std::wstring &, const sufrule &, word &, root_cache &) const;
     /// actually apply a affix rule
     void ApplyRule(const std::wstring &, const std::list<analysis> &, const std::wstring &, const sufrule &, word &) const;
 
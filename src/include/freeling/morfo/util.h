@@ -36,6 +36,7 @@
 #include <string>
 #include <vector>
 #include <set>
+#include <functional>
 
 #include <locale>
 #include <iostream>
@@ -131,6 +132,17 @@ namespace freeling {
     static int capitalization(const std::wstring &);
     static std::wstring capitalize(const std::wstring &, int, bool);
 
+    /// call f(i) for each i in [from,to), spreading the calls over a
+    /// persistent pool of threads. Returns when all calls are done.
+    /// Calls made from pool threads or serial threads run serially.
+    static void parallel_for(size_t, size_t, const std::function<void(size_t)> &);
+    /// max number of threads a parallel_for call may use, including the
+    /// calling one (default: number of cores, 1 runs every call serially)
+    static void set_parallel_threads(size_t);
+    /// make parallel_for calls from the calling thread run serially (e.g. 
+    /// in threads of a server pool, that already keep the cores busy)
+    static void set_serial_thread(bool);
+
     /// sorting criteria for lists of pairs
     template<class T1,class T2> static bool ascending_first(const std::pair<T1,T2> &, const std::pair<T1,T2> &);
     template<class T1,class T2> static bool ascending_second(const std::pair<T1,T2> &, const std::pair<T1,T2> &);
@@ -0,0 +1,114 @@
+//////////////////////////////////////////////////////////////////
+//
+//    FreeLing - Open Source Language Analyzers
+//
+//    Copyright (C) 2014   TALP Research Center
+//                         Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU Affero General Public
+//    License as published by the Free Software Foundation; either
+//    version 3 of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Affero General Public License for more details.
+//
+//    You should have received a copy of the GNU Affero General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: Lluis Padro (padro@lsi.upc.es)
+//             TALP Research Center
+//             despatx C6.212 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+////////////////////////////////////////////////////////////////
+
+#ifndef _BINARY_HANDLER
+#define _BINARY_HANDLER
+
+#include <iostream> 
+#include <string> 
+#include <vector> 
+#include <map> 
+#include <locale> 
+#include "freeling/morfo/language.h"
+
+namespace freeling {
+
+  namespace io {
+
+    ////////////////////////////////////////////////////////////////
+    /// Common infrastructure for output_binary and input_binary.
+    ///
+    /// A binary stream is a sequence of self-delimited messages:
+    ///    magic (4 bytes) + version (1 byte) + type (1 byte)
+    ///    + payload length (varint) + payload
+    /// Each message holds either one sentence or one document.
+    /// Integers are LEB128 varints (zigzag for signed values), doubles
+    /// are 8-byte little-endian IEEE, and strings are UTF-8 interned
+    /// in a per-message table, so repeated lemmas and tags are sent once.
+    ///
+    /// Messages are bytes, and are best handled with byte streams 
+    /// (output_binary::write_sentences, input_binary::read_sentence).
+    /// Wide streams carry one byte per character, and must use
+    /// byte_locale, so the locale set by util::init_locale does not 
+    /// re-encode them.
+    ////////////////////////////////////////////////////////////////
+
+    class WINDLL binary_handler {
+
+    public:
+      /// locale mapping each wide character in 0-255 to one byte and back. 
+      /// Imbue it into wide file streams (before opening them) used 
+      /// with output_binary::PrintResults or input_binary::input_sentence.
+      static std::locale byte_locale(const std::locale &base=std::locale());
+
+    protected:
+      typedef enum {BIN_SENTENCE=1, BIN_DOCUMENT=2} MessageType;
+
+      static const std::string Magic;
+      static const unsigned char Version;
+
+      /// accumulates the payload of a message
+      class encoder {
+      public:
+        encoder();
+        void put_uint(unsigned long long);
+        void put_int(long long);
+        void put_bool(bool);
+        void put_double(double);
+        void put_string(const std::wstring &);
+        /// write a complete message (header and payload) to given stream
+        void write_message(std::ostream &sout, MessageType type) const;
+      private:
+        std::string buff;
+        std::map<std::wstring,size_t> strings;
+      };
+
+      /// reads fields from the payload of a message
+      class decoder {
+      public:
+        decoder(const std::string &payload);
+        unsigned long long get_uint();
+        long long get_int();
+        bool get_bool();
+        double get_double();
+        std::wstring get_string();
+        /// read next message from given stream. Returns false at end of stream
+        static bool read_message(std::istream &sin, MessageType &type, std::string &payload);
+      private:
+        const std::string &buff;
+        size_t pos;
+        std::vector<std::wstring> strings;
+        unsigned char next_byte();
+      };
+
+      binary_handler();
+      ~binary_handler();
+    };
+  }
+}
+#endif
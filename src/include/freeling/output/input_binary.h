@@ -0,0 +1,81 @@
+//////////////////////////////////////////////////////////////////
+//
+//    FreeLing - Open Source Language Analyzers
+//
+//    Copyright (C) 2014   TALP Research Center
+//                         Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU Affero General Public
+//    License as published by the Free Software Foundation; either
+//    version 3 of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Affero General Public License for more details.
+//
+//    You should have received a copy of the GNU Affero General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: Lluis Padro (padro@lsi.upc.es)
+//             TALP Research Center
+//             despatx C6.212 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+////////////////////////////////////////////////////////////////
+
+#ifndef _INPUT_BINARY
+#define _INPUT_BINARY
+
+#include <iostream> 
+#include "freeling/output/input_handler.h"
+#include "freeling/output/binary_handler.h"
+
+namespace freeling {
+
+  namespace io {
+
+    ////////////////////////////////////////////////////////////////
+    /// Class input_binary loads sentences/documents written by
+    /// output_binary.
+    ////////////////////////////////////////////////////////////////
+
+    class WINDLL input_binary : public input_handler, public binary_handler {
+
+    public:   
+      // constructor. 
+      input_binary ();
+      // destructor. 
+      ~input_binary ();
+
+      /// read next sentence from a byte stream. Returns false at end of stream.
+      bool read_sentence (std::istream &sin, freeling::sentence &s) const;
+      /// read a document from a byte stream. Returns false at end of stream.
+      bool read_document (std::istream &sin, freeling::document &doc) const;
+
+      /// load sentences from a wide string or stream holding one byte per character
+      /// (see binary_handler::byte_locale)
+      using input_handler::input_sentences;
+      void input_sentences(const std::wstring &lines, std::list<freeling::sentence> &ls) const;
+      bool input_sentence(std::wistream &is, freeling::sentence &s) const;
+      void input_document(const std::wstring &lines, freeling::document &doc) const;
+
+    private:
+      void decode_sentence(decoder &dec, freeling::sentence &s) const;
+      void decode_paragraph(decoder &dec, freeling::paragraph &p) const;
+      freeling::word decode_word(decoder &dec) const;
+      freeling::analysis decode_analysis(decoder &dec) const;
+      freeling::node decode_node(decoder &dec, freeling::sentence &s) const;
+      void decode_parse_tree(decoder &dec, freeling::sentence &s, freeling::parse_tree &t) const;
+      void decode_dep_tree(decoder &dec, freeling::sentence &s, 
+                           const std::vector<freeling::parse_tree::iterator> &ptindex,
+                           freeling::dep_tree &t) const;
+      static std::string narrow(const std::wstring &lines);
+      static char to_byte(wchar_t c);
+    };
+  }
+}
+
+#endif
@@ -46,10 +46,15 @@ namespace freeling {
       // destructor. 
       ~input_conll();
 
+      using input_handler::input_sentences;
       void input_sentences(const std::wstring &lines, std::list<freeling::sentence> &ls) const;
+      bool input_sentence(std::wistream &is, freeling::sentence &s) const;
       void input_document(const std::wstring &lines, freeling::document &doc) const;
 
     private:
+      // read token lines up to next blank line into 'cs'. False if there are none.
+      bool read_conll_sentence(std::wistream &is, conll_sentence &cs) const;
+
       // whether to infer TAG from MSD column or not.
       bool use_msd;
 
@@ -43,7 +43,13 @@ namespace freeling {
       // destructor. 
       ~input_freeling ();
       
+      using input_handler::input_sentences;
       void input_sentences(const std::wstring &lines, std::list<freeling::sentence> &ls) const;
+      bool input_sentence(std::wistream &is, freeling::sentence &s) const;
+
+    private:
+      // build a word from a token line, simulating spans from offset 'sp'
+      freeling::word read_word(const std::wstring &line, size_t &sp) const;
     };
     
   }
@@ -47,6 +47,13 @@ namespace freeling {
       /// load partially analyzed sentences form 'lines' into a list of sentences
       virtual void input_sentences(const std::wstring &lines, std::list<freeling::sentence> &ls) const = 0;
       virtual void input_document(const std::wstring &lines, freeling::document &doc) const;
+
+      /// load next partially analyzed sentence from stream 'is' into 's'. 
+      /// Returns false if the stream was exhausted before any token was read.
+      virtual bool input_sentence(std::wistream &is, freeling::sentence &s) const;
+      /// load at most 'maxsent' sentences (0 means no limit) from stream 'is' into 'ls'.
+      /// Returns false when the stream is exhausted.
+      bool input_sentences(std::wistream &is, std::list<freeling::sentence> &ls, size_t maxsent=0) const;
     };
 
   }
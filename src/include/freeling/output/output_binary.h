@@ -0,0 +1,83 @@
+//////////////////////////////////////////////////////////////////
+//
+//    FreeLing - Open Source Language Analyzers
+//
+//    Copyright (C) 2014   TALP Research Center
+//                         Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU Affero General Public
+//    License as published by the Free Software Foundation; either
+//    version 3 of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Affero General Public License for more details.
+//
+//    You should have received a copy of the GNU Affero General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: Lluis Padro (padro@lsi.upc.es)
+//             TALP Research Center
+//             despatx C6.212 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+////////////////////////////////////////////////////////////////
+
+#ifndef _OUTPUT_BINARY
+#define _OUTPUT_BINARY
+
+#include <iostream> 
+#include "freeling/output/output_handler.h"
+#include "freeling/output/binary_handler.h"
+
+namespace freeling {
+
+  namespace io {
+
+    ////////////////////////////////////////////////////////////////
+    /// Class output_binary serializes analyzed sentences/documents 
+    /// in a compact versioned binary format, to be loaded back with
+    /// input_binary (e.g. to split analysis stages across processes).
+    /// Analyses, k-best selections, alternatives, user fields, trees 
+    /// and predicates are kept.  Document-level coreference and 
+    /// semantic graph are not serialized.
+    ////////////////////////////////////////////////////////////////
+
+    class WINDLL output_binary : public output_handler, public binary_handler {
+
+    public:   
+      // constructor. 
+      output_binary ();
+      // destructor. 
+      ~output_binary ();
+
+      /// write given sentences to a byte stream, one message per sentence
+      void write_sentences (std::ostream &sout, const std::list<freeling::sentence> &ls) const;
+      /// write given document to a byte stream, as a single message
+      void write_document (std::ostream &sout, const freeling::document &doc) const;
+
+      /// print given sentences to a wide stream, one byte per character
+      /// (see binary_handler::byte_locale)
+      void PrintResults (std::wostream &sout, const std::list<freeling::sentence> &ls) const;
+      /// print given document to a wide stream, one byte per character
+      void PrintResults (std::wostream &sout, const freeling::document &doc) const;
+      /// inherit other methods
+      using output_handler::PrintResults;
+
+    private:
+      void encode_sentence(encoder &enc, const freeling::sentence &s) const;
+      void encode_word(encoder &enc, const freeling::word &w) const;
+      void encode_analysis(encoder &enc, const freeling::analysis &a) const;
+      void encode_node(encoder &enc, const freeling::node &n) const;
+      void encode_parse_tree(encoder &enc, freeling::parse_tree::const_iterator n) const;
+      void encode_dep_tree(encoder &enc, freeling::dep_tree::const_iterator n, 
+                           const std::map<const freeling::node*,size_t> &ptindex) const;
+      static void widen(std::wostream &sout, const std::string &bytes);
+    };
+  }
+}
+
+#endif
@@ -59,18 +59,28 @@ namespace freeling {
       /// inherit other methods
       using output_handler::PrintResults;
 
+      // activate/deactivate one-line-per-sentence (JSONL) output
+      void output_jsonl(bool);
+
     private:
       bool AllSenses;
       bool AllAnalysis;
+      bool JsonLines;
+
+      // streaming json emitter, writes directly to output stream
+      class json_writer;
 
-      jsn::ordered_json json_analysis(const freeling::analysis &a, bool print_sel_status, bool print_probs) const;
-      jsn::ordered_json json_Tree (const std::wstring &sid,
-				   freeling::parse_tree::const_iterator n) const;
-      jsn::ordered_json json_DepTree (const std::wstring &sid,
-				      freeling::dep_tree::const_iterator n) const;
-      jsn::ordered_json json_PredArgs(const freeling::sentence &s) const;
-      jsn::ordered_json json_Corefs(const freeling::document &doc) const;
-      jsn::ordered_json json_Semgraph(const freeling::document &doc) const;
+      void write_analysis(json_writer &js, const freeling::analysis &a, bool print_sel_status, bool print_probs) const;
+      void write_Sentence(json_writer &js, const freeling::sentence &s) const;
+      void write_Sentences(json_writer &js, const std::list<freeling::sentence> &ls) const;
+      void write_Document(json_writer &js, const freeling::document &doc) const;
+      void write_Tree (json_writer &js, const std::wstring &sid,
+                       freeling::parse_tree::const_iterator n) const;
+      void write_DepTree (json_writer &js, const std::wstring &sid,
+                          freeling::dep_tree::const_iterator n) const;
+      void write_PredArgs(json_writer &js, const freeling::sentence &s) const;
+      void write_Corefs(json_writer &js, const freeling::document &doc) const;
+      void write_Semgraph(json_writer &js, const freeling::document &doc) const;
     };
   }
 }
@@ -53,6 +53,9 @@
 
 #include <string>
 #include <vector>
+#include <unordered_map>
+#include <atomic>
+#include <boost/thread/mutex.hpp>
 
 namespace freeling {
 
@@ -67,18 +70,34 @@ namespace freeling {
     typedef boost::wsmatch match_type;
 #endif
 
-    // internal regular expression
+    // internal regular expression, and its source
     regex_type re;
+    std::wstring expression;
+    // whether exceeding the engine complexity bounds was already reported
+    mutable std::atomic<bool> warned;
 
     // private function: convert internal match list to vector<string>
     void extract_matches(const match_type &, std::vector<std::wstring> &) const;
     // private function: convert internal match list to vector<string> and positions to vector<int>
     void extract_matches(const match_type &, std::vector<std::wstring> &, std::vector<int> &) const;
+    // private function: convert internal match list to vector<span>
+    void extract_matches(const match_type &, std::vector<std::pair<int,int> > &) const;
+    // private functions: call the engine, treating as a failed match any search
+    // aborted by the engine because it exceeded its complexity bounds
+    bool run_search(std::wstring::const_iterator, std::wstring::const_iterator, match_type &, bool) const;
+    bool run_match(std::wstring::const_iterator, std::wstring::const_iterator, match_type &) const;
+    // private function: report, only the first time, that complexity bounds were exceeded
+    void complexity_exceeded() const;
 
   public:
+    /// position and length of a (sub)match in the searched string. 
+    /// Position is -1 for groups not taking part in the match.
+    typedef std::pair<int,int> span;
+
     regexp (const regexp&);
     regexp (const std::wstring &expr, bool icase=false);
     ~regexp (); 
+    regexp& operator=(const regexp&);
     /// Search for a partial match in a string
     bool search (const std::wstring &in, bool continuous=false) const;
     /// Search for a partial match in a string, return sub matches
@@ -92,10 +111,75 @@ namespace freeling {
     /// Search for a partial match in a string, return sub matches and positions
     bool search (std::wstring::const_iterator i1, std::wstring::const_iterator i2, 
                  std::vector<std::wstring> &out, std::vector<int> &pos, bool continuous=false) const;
+    /// Search for a partial match in a string, return sub match spans (no substring is copied)
+    bool search (const std::wstring &in, std::vector<span> &out, bool continuous=false) const;
+    /// Search for a partial match in a string, return sub match spans (positions relative to i1)
+    bool search (std::wstring::const_iterator i1, std::wstring::const_iterator i2, 
+                 std::vector<span> &out, bool continuous=false) const;
     /// Search for a whole match in a string
     bool match (const std::wstring &in) const;
     /// Search for a whole match in a string, return sub matches
     bool match (const std::wstring &in, std::vector<std::wstring> &out) const;
+    /// Search for a whole match in a string, return sub match spans
+    bool match (const std::wstring &in, std::vector<span> &out) const;
+    /// get source expression
+    const std::wstring & get_expression() const;
+  };
+
+
+  ///////////////////////////////////////////////
+  /// A set of regular expressions checked together on the same string.
+  /// For each expression, a literal that any match must contain is extracted
+  /// (when it can be safely determined), and all those literals are found with
+  /// a single Aho-Corasick pass over the string. Only expressions whose literal
+  /// is present, or that have none, are run on the string.
+  ///////////////////////////////////////////////
+
+  class regexp_set {
+
+  private:
+    /// expressions in the set, identified by insertion order
+    std::vector<regexp> exprs;
+    /// expressions with no required literal (always checked)
+    std::vector<int> unfiltered;
+
+    /// Aho-Corasick automaton over required literals. Node 0 is the root.
+    /// transitions keyed by (node<<32 | char), children of each node, failure links,
+    /// and expressions whose literal is recognized at each node (including via failure links)
+    std::unordered_map<unsigned long long,int> trans;
+    std::vector<std::vector<std::pair<wchar_t,int> > > children;
+    mutable std::vector<int> fail;
+    mutable std::vector<std::vector<int> > found;
+    /// expressions whose literal ends at each node
+    std::vector<std::vector<int> > ending;
+    /// whether failure links are up to date. They are built on the
+    /// first search after adding expressions, so loading is linear.
+    mutable std::atomic<bool> linked;
+    mutable boost::mutex link_sem;
+
+    /// find the literal that any match of given expression must contain
+    static std::wstring required_literal(const std::wstring &, bool);
+    /// recompute failure links and outputs of the automaton, if needed
+    void build_links() const;
+    /// mark which expressions may match the string
+    void candidates(const std::wstring &, std::vector<bool> &) const;
+
+  public:
+    regexp_set();
+    ~regexp_set();
+
+    /// add an expression to the set, return its identifier
+    int add(const std::wstring &expr, bool icase=false);
+    /// number of expressions in the set
+    size_t size() const;
+    /// get expression with given identifier
+    const regexp & get(int) const;
+
+    /// find the first expression (in insertion order) that matches the whole string,
+    /// return its identifier (or -1) and its sub matches
+    int match_first(const std::wstring &in, std::vector<std::wstring> &out) const;
+    /// find all expressions with a partial match in the string, in insertion order
+    void search_all(const std::wstring &in, std::vector<int> &ids) const;
   };
 }
 
@@ -29,6 +29,7 @@
 #ifndef _TREE_TEMPLATE
 #define _TREE_TEMPLATE
 
+#include <utility>
 #include "freeling/windll.h"
 
 namespace freeling {
@@ -62,6 +63,8 @@ namespace freeling {
     private:
       /// auxiliary to copy, assignment, and destructor
       void clone(const tree<T>&);
+      /// auxiliary to move constructor and move assignment
+      void adopt(tree<T>&);
     
     protected:
       /// information contained in the root node
@@ -92,8 +95,12 @@ namespace freeling {
       tree(const const_iterator&);
       /// copy
       tree(const tree<T>&);
+      /// move (nodes are relinked, not copied)
+      tree(tree<T>&&);
       /// assignment
       tree<T>& operator=(const tree<T>&);
+      /// move assignment (nodes are relinked, not copied)
+      tree<T>& operator=(tree<T>&&);
       /// destructor
       ~tree();
       
@@ -120,6 +127,8 @@ namespace freeling {
       /// copy given tree and add it as a child
       void add_child(const tree<T>& t, bool back=true);
       void add_child(const const_iterator &p, bool back=true);
+      /// move given tree nodes into a new child. NO COPIES MADE.
+      void add_child(tree<T>&& t, bool back=true);
       /// add given tree and as a child reordering structure. NO COPIES MADE.
       void hang_child(tree<T>& t, tree_sibling_iterator<T> where=tree_sibling_iterator<T>(NULL));
       void hang_child(preorder_iterator &p, tree_sibling_iterator<T> where=tree_sibling_iterator<T>(NULL));
@@ -177,6 +186,13 @@ namespace freeling {
     clone(t);
   }
 
+  /////////////////////////////////////////////
+  /// Move constructor
+
+  template<class T> tree<T>::tree(tree<T>&& t) {
+    adopt(t);
+  }
+
   /////////////////////////////////////////////
   /// Assignment
 
@@ -187,6 +203,17 @@ namespace freeling {
     }
     return (*this);
   }
+
+  /////////////////////////////////////////////
+  /// Move assignment
+
+  template<class T> tree<T>& tree<T>::operator=(tree<T>&& t) {
+    if (this!=&t) {
+      clear();
+      adopt(t);
+    }
+    return (*this);
+  }
   
   /////////////////////////////////////////////
   /// Destructor
@@ -220,6 +247,33 @@ namespace freeling {
     }
   }
 
+  /////////////////////////////////////////////
+  /// Auxiliary for move constructor and move assignment.
+  /// Takes over the root content and children of given tree,
+  /// which is left empty. Only the direct children need to be
+  /// relinked, so the cost does not depend on the tree size.
+  /// Nodes hanging inside another tree are copied instead, 
+  /// since their position in the owner tree must be kept.
+  
+  template<class T> void tree<T>::adopt(tree<T>& t) {
+    if (t.parent!=NULL or t.prev!=NULL or t.next!=NULL) {
+      clone(t);
+      return;
+    }
+
+    pinfo = t.pinfo;
+    parent = prev = next = NULL;
+    first = t.first;
+    last = t.last;
+    nchildren = t.nchildren;
+    for (tree<T>* p = first; p!=NULL; p=p->next) 
+      p->parent = this;
+
+    t.pinfo = NULL;
+    t.first = t.last = NULL;
+    t.nchildren = 0;
+  }
+
   /////////////////////////////////////////////
   /// Check whether the tree top has no parent (is the root
 
@@ -426,6 +480,16 @@ namespace freeling {
     else this->hang_child(*nt,this->sibling_begin()); 
   }
 
+  /////////////////////////////////////////////
+  /// move given tree nodes under a new child, leaving it empty
+
+  template<class T> void tree<T>::add_child(tree<T>&& t, bool back) {
+    tree<T> *nt = new tree<T>(std::move(t));  // take over given tree nodes
+    // hang the new node under 'this'
+    if (back) this->hang_child(*nt,this->sibling_end());  
+    else this->hang_child(*nt,this->sibling_begin()); 
+  }
+
   /////////////////////////////////////////////
   /// Get iterator to first node in the tree
 
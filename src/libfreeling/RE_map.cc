@@ -56,8 +56,9 @@ namespace freeling {
 
     while (getline(fabr,line)) {
       wstring key=line.substr(0,line.find(L" "));
-      wstring data=line.substr(line.find(L" ")+1);        
-      regexps.push_back(RE_map_rule(key,data));
+      wstring dt=line.substr(line.find(L" ")+1);        
+      regexps.add(key);
+      data.push_back(dt);
     }
     fabr.close(); 
   
@@ -74,23 +75,15 @@ namespace freeling {
     wstring form=w.get_form();
     TRACE(3,L"checking "+form);
 
-    // check word against each regexp in list
-    std::list<RE_map_rule>::const_iterator r;  
-    wstring data=L"";
-    bool found=false;
+    // check word against regexps in list, first match wins.
+    // Only regexps that may match the form are actually run.
     vector<wstring> mtch;
-    for (r=regexps.begin(); r!=regexps.end() and not found; r++) {
-      TRACE(3,L"Checking expression "+r->expression);
-      if (r->re.match(form,mtch)) {
-        found=true;
-        data=r->data;
-        TRACE(3,L" ... Match! returning data= "+data);
-      }
-    }
+    int r = regexps.match_first(form,mtch);
 
-    if (found) {
+    if (r>=0) {
+      TRACE(3,L" ... Match with expression "+regexps.get(r).get_expression()+L"! returning data= "+data[r]);
       wistringstream sin;
-      sin.str(data);
+      sin.str(data[r]);
       // extract lemma+tag pairs from recovered data string
       wstring lemma,tag;
       while (sin>>lemma>>tag) {
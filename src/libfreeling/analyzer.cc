@@ -27,6 +27,7 @@
 ////////////////////////////////////////////////////////////////
 
 #include <sstream>
+#include <algorithm>
 
 #include "freeling/morfo/traces.h"
 #include "freeling/morfo/analyzer.h"
@@ -101,87 +102,214 @@ analyzer::analyzer(const analyzer_config_options &cfg) {
 //---------------------------------------------
 
 void analyzer::create_analyzers() {
-  tk=NULL; sp=NULL; morfo=NULL; neclass=NULL; sens=NULL;
-  dsb=NULL; hmm=NULL; relax=NULL; phon=NULL; parser=NULL;
-  deptxala=NULL; deptreeler=NULL; deplstm=NULL; srltreeler=NULL;
-  corfc=NULL; sge=NULL;
-  
   offs = 0;
   nsentence = 1;
   
-  //--- create needed analyzers, depending on given options ---//
+  //--- create tokenizer and splitter, which are cheap and always used ---//
 
   // tokenizer requested
   if (not initial_options.config_opt.TOK_TokenizerFile.empty())
-    tk = new tokenizer(initial_options.config_opt.TOK_TokenizerFile);
+    tk = load<tokenizer>(initial_options.config_opt.TOK_TokenizerFile);
   // splitter requested
   if (not initial_options.config_opt.SPLIT_SplitterFile.empty()) {
-    sp = new splitter(initial_options.config_opt.SPLIT_SplitterFile);
+    sp = load<splitter>(initial_options.config_opt.SPLIT_SplitterFile);
     sp_id = sp->open_session();
   }
 
+  //--- find out which other modules can be created, depending on given options ---//
+  const analyzer_config_options &co = initial_options.config_opt;
+
   // some morfological analysis requested
-  if (not initial_options.config_opt.MACO_UserMapFile.empty() or not initial_options.config_opt.MACO_PunctuationFile.empty() or
-      not initial_options.config_opt.MACO_DictionaryFile.empty() or not initial_options.config_opt.MACO_AffixFile.empty() or 
-      not initial_options.config_opt.MACO_CompoundFile.empty() or not initial_options.config_opt.MACO_LocutionsFile.empty() or  
-      not initial_options.config_opt.MACO_NPDataFile.empty() or not initial_options.config_opt.MACO_QuantitiesFile.empty() or 
-      not initial_options.config_opt.MACO_ProbabilityFile.empty()) {
-
-    // create analyzer with desired options
-    morfo = new maco(initial_options);
+  available[M_MACO] = (not co.MACO_UserMapFile.empty() or not co.MACO_PunctuationFile.empty() or
+                       not co.MACO_DictionaryFile.empty() or not co.MACO_AffixFile.empty() or 
+                       not co.MACO_CompoundFile.empty() or not co.MACO_LocutionsFile.empty() or  
+                       not co.MACO_NPDataFile.empty() or not co.MACO_QuantitiesFile.empty() or 
+                       not co.MACO_ProbabilityFile.empty());
+
+  available[M_SENSES] = not co.SENSE_ConfigFile.empty();
+  available[M_UKB] = not co.UKB_ConfigFile.empty();
+  available[M_HMM] = not co.TAGGER_HMMFile.empty();
+  available[M_RELAX] = not co.TAGGER_RelaxFile.empty();
+  available[M_PHON] = not co.PHON_PhoneticsFile.empty();
+  available[M_NEC] = not co.NEC_NECFile.empty();
+  available[M_PARSER] = not co.PARSER_GrammarFile.empty();
+  // rule-based dep parser needs the chart parser grammar
+  available[M_TXALA] = not co.DEP_TxalaFile.empty() and not co.PARSER_GrammarFile.empty();
+  available[M_TREELER] = not co.DEP_TreelerFile.empty();
+  available[M_LSTM] = not co.DEP_LSTMFile.empty();
+  available[M_SRL] = not co.SRL_TreelerFile.empty();
+  available[M_COREF] = not co.COREF_CorefFile.empty();
+  available[M_SEMGRAPH] = not co.SEMGRAPH_SemGraphFile.empty();
+
+  for (int m=0; m<M_COUNT; m++) loaded[m].store(false);
+}
+
+
+//---------------------------------------------
+// Find out which modules are needed to analyze with given options
+// (must follow the same conditions than do_analysis)
+//---------------------------------------------
+
+vector<analyzer::module_id> analyzer::needed_modules(const analyzer_invoke_options &ivk) const {
+  vector<module_id> need;
+
+  if (ivk.InputLevel < MORFO and ivk.OutputLevel >= MORFO) need.push_back(M_MACO);
+  if (ivk.SENSE_WSD_which != NO_WSD) need.push_back(M_SENSES);
+  if (ivk.PHON_Phonetics) need.push_back(M_PHON);
+  if (ivk.OutputLevel <= MORFO) return need;
+
+  if (ivk.InputLevel < TAGGED and ivk.OutputLevel >= TAGGED) {
+    if (ivk.TAGGER_which==HMM) need.push_back(M_HMM);
+    else if (ivk.TAGGER_which==RELAX) need.push_back(M_RELAX);
+  }
+  if (ivk.SENSE_WSD_which == UKB and available[M_UKB]) need.push_back(M_UKB);
+  if (ivk.NEC_NEClassification and available[M_NEC]) need.push_back(M_NEC);
+  if (ivk.OutputLevel == TAGGED) return need;
+
+  if (available[M_PARSER] and ivk.InputLevel < SHALLOW and
+      (ivk.OutputLevel == SHALLOW or ivk.OutputLevel == PARSED or
+       (ivk.OutputLevel >= DEP and ivk.DEP_which==TXALA)))
+    need.push_back(M_PARSER);
+  if (ivk.OutputLevel == SHALLOW) return need;
+
+  bool coref = ivk.OutputLevel>=COREF and available[M_COREF];
+  bool txala = available[M_TXALA] and ivk.InputLevel < PARSED and
+               (ivk.OutputLevel == PARSED or (ivk.OutputLevel > PARSED and ivk.DEP_which==TXALA));
+  if (ivk.OutputLevel > PARSED) {
+    if (available[M_TREELER] and ivk.InputLevel<DEP and
+        (coref or (ivk.OutputLevel >= DEP and ivk.DEP_which==TREELER)))
+      need.push_back(M_TREELER);
+    else if (available[M_LSTM] and ivk.InputLevel<DEP and
+             (coref or (ivk.OutputLevel >= DEP and ivk.DEP_which==LSTM)))
+      need.push_back(M_LSTM);
+    else if (available[M_TXALA] and ivk.InputLevel < DEP and
+             ivk.OutputLevel >= DEP and ivk.DEP_which==TXALA)
+      txala = true;
   }
+  // dep_txala is built on the chart parser start symbol
+  if (txala) {
+    need.push_back(M_PARSER);
+    need.push_back(M_TXALA);
+  }
+  if (ivk.OutputLevel <= DEP) return need;
 
-  // sense annotation requested/needed
-  if (not initial_options.config_opt.SENSE_ConfigFile.empty()) 
-    sens = new senses(initial_options.config_opt.SENSE_ConfigFile);
+  if (available[M_SRL] and ivk.InputLevel<SRL and
+      (coref or (ivk.OutputLevel >= SRL and ivk.SRL_which==SRL_TREELER)))
+    need.push_back(M_SRL);
+  if (ivk.InputLevel < COREF and coref) need.push_back(M_COREF);
+  if (ivk.OutputLevel >= SEMGRAPH and available[M_SEMGRAPH]) need.push_back(M_SEMGRAPH);
 
-  // sense disambiguation requested
-  if (not initial_options.config_opt.UKB_ConfigFile.empty()) 
-    dsb = new ukb(initial_options.config_opt.UKB_ConfigFile);
+  return need;
+}
 
-  // taggers requested
-  if (not initial_options.config_opt.TAGGER_HMMFile.empty())
-    hmm = new hmm_tagger(initial_options);
-  
-  if (not initial_options.config_opt.TAGGER_RelaxFile.empty())
-    relax = new relax_tagger(initial_options);
-  
-  // phonetics requested
-  if (not initial_options.config_opt.PHON_PhoneticsFile.empty()) 
-    phon = new phonetics(initial_options.config_opt.PHON_PhoneticsFile);
-  
-  // NEC requested
-  if (not initial_options.config_opt.NEC_NECFile.empty())
-    neclass = new nec(initial_options.config_opt.NEC_NECFile);
-  
-  // Chunking requested
-  if (not initial_options.config_opt.PARSER_GrammarFile.empty()) 
-    parser = new chart_parser (initial_options.config_opt.PARSER_GrammarFile);
-
-  // rule-based dep parser
-  if (not initial_options.config_opt.DEP_TxalaFile.empty() and not initial_options.config_opt.PARSER_GrammarFile.empty()) 
-    deptxala = new dep_txala(initial_options.config_opt.DEP_TxalaFile, parser->get_start_symbol ());
-
-  // statistical dep-parser 
-  if (not initial_options.config_opt.DEP_TreelerFile.empty()) 
-    deptreeler = new dep_treeler(initial_options.config_opt.DEP_TreelerFile);
-
-  // LSTM based statistical parser
-  if (not initial_options.config_opt.DEP_LSTMFile.empty()) 
-    deplstm = new dep_lstm(initial_options.config_opt.DEP_LSTMFile);
-
-  // statistical SRL
-  if (not initial_options.config_opt.SRL_TreelerFile.empty()) 
-    srltreeler = new srl_treeler(initial_options.config_opt.SRL_TreelerFile);
-
-  // coreference resolution
-  if (not initial_options.config_opt.COREF_CorefFile.empty()) 
-    corfc = new relaxcor(initial_options.config_opt.COREF_CorefFile);
-
-  // semantic graph extractor
-  if (not initial_options.config_opt.SEMGRAPH_SemGraphFile.empty())
-    sge = new semgraph_extract(initial_options.config_opt.SEMGRAPH_SemGraphFile);
-   
+
+//---------------------------------------------
+// Get a module loaded from given file, shared with any other
+// analyzer using the same file.
+//---------------------------------------------
+
+template<class T> 
+shared_ptr<T> analyzer::load(const wstring &fname) {
+  return model_registry::get<T>(model_registry::canonical(fname),
+                                [&fname]() { return new T(fname); });
+}
+
+
+//---------------------------------------------
+// Create given module. Caller must hold load_sem
+//---------------------------------------------
+
+void analyzer::create_module(module_id m) const {
+  // unavailable modules are left as NULL, as when created eagerly
+  if (not available[m]) return;
+
+  const analyzer_config_options &co = initial_options.config_opt;
+  const analyzer_config &opts = initial_options;
+  wostringstream key;
+  switch (m) {
+  case M_MACO:     
+    // morphological analyzer depends on all its creation options
+    key << co.Lang << L"|" << co.MACO_Decimal << L"|" << co.MACO_Thousand;
+    for (const wstring &f : {co.MACO_UserMapFile, co.MACO_PunctuationFile, co.MACO_DictionaryFile,
+                             co.MACO_AffixFile, co.MACO_CompoundFile, co.MACO_LocutionsFile,
+                             co.MACO_NPDataFile, co.MACO_QuantitiesFile, co.MACO_ProbabilityFile})
+      key << L"|" << model_registry::canonical(f);
+    key << L"|" << co.MACO_InverseDictionary << L"|" << co.MACO_ProbabilityThreshold
+        << L"|" << co.MACO_WordCacheSize;
+    morfo = model_registry::get<maco>(key.str(), [&opts]() { return new maco(opts); }); 
+    break;
+  case M_HMM:
+    hmm = model_registry::get<hmm_tagger>(model_registry::canonical(co.TAGGER_HMMFile), 
+                                          [&opts]() { return new hmm_tagger(opts); }); 
+    break;
+  case M_RELAX:
+    key << model_registry::canonical(co.TAGGER_RelaxFile) << L"|" << co.TAGGER_RelaxMaxIter 
+        << L"|" << co.TAGGER_RelaxScaleFactor << L"|" << co.TAGGER_RelaxEpsilon;
+    relax = model_registry::get<relax_tagger>(key.str(), [&opts]() { return new relax_tagger(opts); }); 
+    break;
+  case M_TXALA:
+    // rules are built on the grammar start symbol
+    key << model_registry::canonical(co.DEP_TxalaFile) << L"|" << model_registry::canonical(co.PARSER_GrammarFile);
+    deptxala = model_registry::get<dep_txala>(key.str(), [&]() { return new dep_txala(co.DEP_TxalaFile, 
+                                                                                       parser->get_start_symbol()); });
+    break;
+  case M_SENSES:   sens = load<senses>(co.SENSE_ConfigFile); break;
+  case M_UKB:      dsb = load<ukb>(co.UKB_ConfigFile); break;
+  case M_PHON:     phon = load<phonetics>(co.PHON_PhoneticsFile); break;
+  case M_NEC:      neclass = load<nec>(co.NEC_NECFile); break;
+  case M_PARSER:   parser = load<chart_parser>(co.PARSER_GrammarFile); break;
+  case M_TREELER:  deptreeler = load<dep_treeler>(co.DEP_TreelerFile); break;
+  case M_LSTM:     deplstm = load<dep_lstm>(co.DEP_LSTMFile); break;
+  case M_SRL:      srltreeler = load<srl_treeler>(co.SRL_TreelerFile); break;
+  case M_COREF:    corfc = load<relaxcor>(co.COREF_CorefFile); break;
+  case M_SEMGRAPH: sge = load<semgraph_extract>(co.SEMGRAPH_SemGraphFile); break;
+  default: break;
+  }
+}
+
+
+//---------------------------------------------
+// Create modules needed by given options that do not exist yet.
+// Independent modules are loaded in parallel.
+//---------------------------------------------
+
+void analyzer::load_modules(const analyzer_invoke_options &ivk) const {
+
+  vector<module_id> need = needed_modules(ivk);
+
+  // usual case: everything is already there
+  bool ready = true;
+  for (size_t i=0; i<need.size() and ready; i++) 
+    ready = loaded[need[i]].load(memory_order_acquire);
+  if (ready) return;
+
+  boost::mutex::scoped_lock lock(load_sem);
+
+  // group missing modules in independent tasks. dep_txala goes
+  // with the chart parser if this one is also missing.
+  vector<vector<module_id> > tasks;
+  vector<bool> queued(M_COUNT,false);
+  for (size_t i=0; i<need.size(); i++) {
+    module_id m = need[i];
+    if (queued[m] or loaded[m].load(memory_order_relaxed)) continue;
+    if (m==M_TXALA and not loaded[M_PARSER].load(memory_order_relaxed)) continue;
+
+    tasks.push_back(vector<module_id>(1,m));
+    queued[m] = true;
+    if (m==M_PARSER and find(need.begin(),need.end(),M_TXALA)!=need.end() 
+        and not loaded[M_TXALA].load(memory_order_relaxed)) {
+      tasks.back().push_back(M_TXALA);
+      queued[M_TXALA] = true;
+    }
+  }
+
+  TRACE(2,L"Loading "<<tasks.size()<<L" modules");
+  util::parallel_for(0, tasks.size(), [&](size_t t) {
+      for (size_t i=0; i<tasks[t].size(); i++) create_module(tasks[t][i]);
+    });
+
+  for (size_t t=0; t<tasks.size(); t++) 
+    for (size_t i=0; i<tasks[t].size(); i++) loaded[tasks[t][i]].store(true, memory_order_release);
 }
   
   
@@ -190,24 +318,8 @@ void analyzer::create_analyzers() {
 //---------------------------------------------
 
 analyzer::~analyzer() {
-  // clean up. Note that deleting a null pointer is a safe operation
-  delete tk;
-  if (sp!=NULL) sp->close_session(sp_id); 
-  delete sp;
-  delete morfo;
-  delete phon;
-  delete hmm;
-  delete relax;
-  delete neclass;
-  delete sens;
-  delete dsb;
-  delete parser;
-  delete deptxala;
-  delete deptreeler;
-  delete deplstm;
-  delete srltreeler;
-  delete corfc;
-  delete sge;
+  // modules are released when the last analyzer using them is gone
+  if (sp) sp->close_session(sp_id); 
 }
 
   
@@ -217,24 +329,42 @@ analyzer::~analyzer() {
 
 void analyzer::set_current_invoke_options(const analyzer_invoke_options &opt) { 
 
-  if (morfo!=NULL) {
-    // morfo class will take care of setting and validating its own options
-    morfo->set_active_options (opt.MACO_UserMap,
-                               opt.MACO_NumbersDetection,
-                               opt.MACO_PunctuationDetection,
-                               opt.MACO_DatesDetection,
-                               opt.MACO_DictionarySearch,
-                               opt.MACO_AffixAnalysis,
-                               opt.MACO_CompoundAnalysis,
-                               opt.MACO_RetokContractions,
-                               opt.MACO_MultiwordsDetection,
-                               opt.MACO_NERecognition,
-                               opt.MACO_QuantitiesDetection,
-                               opt.MACO_ProbabilityAssignment);
-  }
+  // maco may be shared with other analyzers, so its active options are
+  // not changed: this analyzer passes its own options to each call. 
+  // They are checked against the configuration, as maco would do.
+  analyzer_invoke_options ivk = opt;
+  check_maco_options(ivk);
 
   // store given options as current
-  current_invoke_options = opt;
+  current_invoke_options = ivk;
+}
+
+//---------------------------------------------
+// Warn about morphological options whose modules are not
+// in the configuration, and deactivate them.
+//---------------------------------------------
+
+void analyzer::check_maco_options(analyzer_invoke_options &opt) const {
+  // without maco, morphological options are ignored
+  if (not available[M_MACO]) return;
+
+  const analyzer_config_options &co = initial_options.config_opt;
+  bool dic = not co.MACO_DictionaryFile.empty();
+  wstring msg=L"option can't be activated because it was not loaded at instantiation time.";
+
+  if (opt.MACO_UserMap and co.MACO_UserMapFile.empty()) { WARNING(L"UserMap "+msg); opt.MACO_UserMap=false; }
+  if (opt.MACO_MultiwordsDetection and co.MACO_LocutionsFile.empty()) { WARNING(L"Multiwords "+msg); opt.MACO_MultiwordsDetection=false; }
+  if (opt.MACO_PunctuationDetection and co.MACO_PunctuationFile.empty()) { WARNING(L"Punctuation "+msg); opt.MACO_PunctuationDetection=false; }
+  if (opt.MACO_QuantitiesDetection and co.MACO_QuantitiesFile.empty()) { WARNING(L"Quantities "+msg); opt.MACO_QuantitiesDetection=false; }
+  if (opt.MACO_ProbabilityAssignment and co.MACO_ProbabilityFile.empty()) { WARNING(L"Probabilities "+msg); opt.MACO_ProbabilityAssignment=false; }
+  if (opt.MACO_NERecognition and co.MACO_NPDataFile.empty()) { WARNING(L"NE Recognition "+msg); opt.MACO_NERecognition=false; }
+  if (opt.MACO_DictionarySearch and not dic) { 
+    WARNING(L"Dictionary "+msg); 
+    WARNING(L"Retokenize contractions "+msg);
+    opt.MACO_DictionarySearch=false;
+  }
+  if (opt.MACO_AffixAnalysis and (not dic or co.MACO_AffixFile.empty())) { WARNING(L"Affixation "+msg); opt.MACO_AffixAnalysis=false; }
+  if (opt.MACO_CompoundAnalysis and (not dic or co.MACO_CompoundFile.empty())) { WARNING(L"Compound "+msg); opt.MACO_CompoundAnalysis=false; }
 }
 
 //---------------------------------------------  
@@ -256,7 +386,7 @@ template<class T> void analyzer::do_analysis(T &doc, const analyzer_invoke_optio
   // apply sense tagging (without WSD) if requested at morfo level
   if (ivk.SENSE_WSD_which != NO_WSD and ivk.OutputLevel <= MORFO) {
     TRACE(2,L"running sense annotation");
-    sens->analyze(doc);
+    sens->analyze(doc, ivk);
   }
   
   // add phonetic encoding if needed 
@@ -284,15 +414,13 @@ template<class T> void analyzer::do_analysis(T &doc, const analyzer_invoke_optio
   if (ivk.OutputLevel >= TAGGED) {
     // apply sense tagging if needed
     if (ivk.SENSE_WSD_which != NO_WSD) {
-      if (sens->get_duplicate_analysis()) {
-	sens->set_duplicate_analysis(false);
-	WARNING(L"Deactivated DuplicateAnalysis option for 'senses' module due to selected OutputLevel>=TAGGED.")
-      }
+      // senses may be shared with other analyzers, so its DuplicateAnalysis
+      // option is not changed: it is ignored for output levels >= TAGGED
       TRACE(2,L"running sense annotation");
-      sens->analyze(doc);
+      sens->analyze(doc, ivk);
 
       // apply WSD if requested
-      if (ivk.SENSE_WSD_which == UKB and dsb != NULL) {
+      if (ivk.SENSE_WSD_which == UKB and available[M_UKB]) {
 	TRACE(2,L"running WSD");
 	dsb->analyze(doc);
       }
@@ -300,7 +428,7 @@ template<class T> void analyzer::do_analysis(T &doc, const analyzer_invoke_optio
   }
 
   // -- NEC
-  if (ivk.OutputLevel >= TAGGED and ivk.NEC_NEClassification and neclass != NULL) {
+  if (ivk.OutputLevel >= TAGGED and ivk.NEC_NEClassification and available[M_NEC]) {
     TRACE(2,L"running NEC");
     neclass->analyze(doc);
   }
@@ -310,7 +438,7 @@ template<class T> void analyzer::do_analysis(T &doc, const analyzer_invoke_optio
 
   // --------- CHART PARSER
   // apply chart parser if needed
-  if (parser != NULL and                                    // chart parser is loaded
+  if (available[M_PARSER] and                               // chart parser is configured
       ivk.InputLevel < SHALLOW and       // input is not parsed
         (ivk.OutputLevel == SHALLOW or     // requested output is shallow or parsed
          ivk.OutputLevel == PARSED or      // 
@@ -324,7 +452,7 @@ template<class T> void analyzer::do_analysis(T &doc, const analyzer_invoke_optio
   if (ivk.OutputLevel==SHALLOW) return;
 
   // --------  Check if "PARSED" level needs to be computed
-  if (deptxala != NULL                                          // dep_txala is loaded
+  if (available[M_TXALA]                                        // dep_txala is configured
       and ivk.InputLevel < PARSED            // input is at most chunked
       and (ivk.OutputLevel == PARSED         // and requested output is parsed
            or (ivk.OutputLevel > PARSED      // or any later stage, but dep_txala 
@@ -338,25 +466,25 @@ template<class T> void analyzer::do_analysis(T &doc, const analyzer_invoke_optio
   
   // --------- DEP PARSER (+SRL in treeler-> to detach).
   // apply dep parser if needed
-  if (deptreeler!=NULL and 
+  if (available[M_TREELER] and 
       ivk.InputLevel<DEP and
-      ((ivk.OutputLevel>=COREF and corfc!=NULL)
+      ((ivk.OutputLevel>=COREF and available[M_COREF])
        or (ivk.OutputLevel >= DEP and ivk.DEP_which==TREELER))) {
 
     TRACE(2,L"running dep Treeler parser");
     deptreeler->analyze(doc);
   }
   // apply lstm dep parser if needed
-  else if (deplstm!=NULL and 
+  else if (available[M_LSTM] and 
       ivk.InputLevel<DEP and
-      ((ivk.OutputLevel>=COREF and corfc!=NULL)
+      ((ivk.OutputLevel>=COREF and available[M_COREF])
        or (ivk.OutputLevel >= DEP and ivk.DEP_which==LSTM))) {
 
     TRACE(2,L"running dep LSTM parser");
     deplstm->analyze(doc);
   }
   // default to rule based dep parser
-  else if (deptxala != NULL and ivk.InputLevel < DEP and
+  else if (available[M_TXALA] and ivk.InputLevel < DEP and
            ivk.OutputLevel >= DEP and ivk.DEP_which==TXALA) {
 
     TRACE(2,L"running dep Txala parser");
@@ -367,9 +495,9 @@ template<class T> void analyzer::do_analysis(T &doc, const analyzer_invoke_optio
   if (ivk.OutputLevel==DEP) return;
 
   // --------- SRL PARSER
-  if (srltreeler!=NULL and 
+  if (available[M_SRL] and 
       ivk.InputLevel<SRL and
-      ((ivk.OutputLevel>=COREF and corfc!=NULL)
+      ((ivk.OutputLevel>=COREF and available[M_COREF])
        or (ivk.OutputLevel >= SRL and ivk.SRL_which==SRL_TREELER))) {
     TRACE(2,L"running SLR");
     srltreeler->analyze(doc);
@@ -384,18 +512,26 @@ template<class T> void analyzer::do_analysis(T &doc, const analyzer_invoke_optio
 
 void analyzer::analyze(document &doc, const analyzer_invoke_options& ivk) const {
 
+  // create modules needed for these options, if not there yet
+  load_modules(ivk);
+
+  // time the whole cascade, besides each module
+  metrics::probe p("analyzer");
+  p.count(doc);
+
   // analyze document
   do_analysis<document>(doc, ivk);
 
   // solve coreference if needed 
-  if (ivk.InputLevel<COREF and ivk.OutputLevel>=COREF and corfc!=NULL and not doc.empty()) {
+  if (ivk.InputLevel<COREF and ivk.OutputLevel>=COREF and available[M_COREF] and not doc.empty()) {
     TRACE(2,L"running coref");
     corfc->analyze(doc);
   }
 
   // extract semantic graph if needed
-  if (ivk.OutputLevel>=SEMGRAPH and sge!=NULL and not doc.empty()) {
+  if (ivk.OutputLevel>=SEMGRAPH and available[M_SEMGRAPH] and not doc.empty()) {
     TRACE(2,L"running semgraph");
+    metrics::probe ps("semgraph_extract");
     sge->extract(doc);
   }
 }
@@ -412,6 +548,9 @@ void analyzer::analyze(document &doc) const { analyze(doc, current_invoke_option
 //---------------------------------------------
 
 void analyzer::analyze(list<sentence> &ls, const analyzer_invoke_options& ivk) const {
+  load_modules(ivk);
+  metrics::probe p("analyzer");
+  p.count(ls);
   do_analysis<list<sentence> >(ls, ivk);
 }
 
@@ -596,7 +735,12 @@ void analyzer::tokenize_split(const wstring &text,
   ls.clear();
 
   // --------- TOKENIZER
-  tk->tokenize (text, offs, av);
+  {
+    metrics::probe p("tokenizer");
+    // tokenize replaces the content of av with the new tokens
+    tk->tokenize (text, offs, av);
+    p.count(0, av.size());
+  }
   
   // if expected output was TOKEN, we are done
   if (ivk.OutputLevel==TOKEN) {
@@ -609,7 +753,9 @@ void analyzer::tokenize_split(const wstring &text,
   if (ivk.InputLevel<SPLITTED and 
       ivk.OutputLevel>=SPLITTED) {
     // split text into a list of sentences (ls)
+    metrics::probe p("splitter");
     sp->split(sp_ses, av, flush, ls);
+    p.count(ls);
     av.clear();
     // assign an id to each sentence.
     for (list<sentence>::iterator s=ls.begin(); s!=ls.end(); s++) {
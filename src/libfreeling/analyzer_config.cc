@@ -145,6 +145,7 @@ namespace freeling {
   
   analyzer_config_options::analyzer_config_options() {
     MACO_ProbabilityThreshold = 0.001;
+    MACO_WordCacheSize = 0;
     TAGGER_RelaxMaxIter = 500;
     TAGGER_RelaxScaleFactor = 67;
     TAGGER_RelaxEpsilon = 0.001;
@@ -173,6 +174,7 @@ namespace freeling {
     sout << L"MACO_PunctuationFile: " << MACO_PunctuationFile << endl;
     sout << L"MACO_CompoundFile: " << MACO_CompoundFile << endl;
     sout << L"MACO_ProbabilityThreshold: " << MACO_ProbabilityThreshold << endl;
+    sout << L"MACO_WordCacheSize: " << MACO_WordCacheSize << endl;
     sout << L"PHON_PhoneticsFile: " << PHON_PhoneticsFile << endl;
     sout << L"NEC_NECFile: " << NEC_NECFile << endl;
     sout << L"SENSE_ConfigFile: " << SENSE_ConfigFile << endl;
@@ -296,6 +298,7 @@ namespace freeling {
       ("fprob,P",po::wvalue<std::wstring>(&config_opt.MACO_ProbabilityFile),"Probabilities file")
       ("thres,e",po::wvalue<double>(&config_opt.MACO_ProbabilityThreshold),"Probability threshold for unknown word tags")
       ("fdict,D",po::wvalue<std::wstring>(&config_opt.MACO_DictionaryFile),"Form dictionary")
+      ("wcache",po::wvalue<int>(&config_opt.MACO_WordCacheSize),"Number of word forms whose dictionary annotation is cached (0 to disable)")
       ("fnp,N",po::wvalue<std::wstring>(&config_opt.MACO_NPDataFile),"NE recognizer data file")
       ("fcomp,K",po::wvalue<std::wstring>(&config_opt.MACO_CompoundFile),"Compound detector configuration file")
       ("fpunct,F",po::wvalue<std::wstring>(&config_opt.MACO_PunctuationFile),"Punctuation symbol file")
@@ -355,6 +358,7 @@ namespace freeling {
       ("ProbabilityFile",po::wvalue<std::wstring>(&config_opt.MACO_ProbabilityFile),"Probabilities file")
       ("ProbabilityThreshold",po::wvalue<double>(&config_opt.MACO_ProbabilityThreshold),"Probability threshold for unknown word tags")
       ("DictionaryFile",po::wvalue<std::wstring>(&config_opt.MACO_DictionaryFile),"Form dictionary")
+      ("WordCacheSize",po::wvalue<int>(&config_opt.MACO_WordCacheSize),"Number of word forms whose dictionary annotation is cached (0 to disable)")
       ("NPDataFile",po::wvalue<std::wstring>(&config_opt.MACO_NPDataFile),"NP recognizer data file")
       ("CompoundFile",po::wvalue<std::wstring>(&config_opt.MACO_CompoundFile),"Compound detector configuration file")
       ("PunctuationFile",po::wvalue<std::wstring>(&config_opt.MACO_PunctuationFile),"Punctuation symbol file")
@@ -123,7 +123,7 @@ return *this;
   /// Constructor.
   ////////////////////////////////////////////////////////////////
 
-  chart::chart(const grammar &g) : gram(g) {}
+  chart::chart(const grammar &g) : size(0), ref(NULL), gram(g) {}
 
   ////////////////////////////////////////////////////////////////
   /// Destructor
@@ -143,6 +143,25 @@ return *this;
   ////////////////////////////////////////////////////////////////
 
   void chart::load_sentence(const sentence &s, int k) {
+    load(s,k,NULL);
+  }
+
+  ////////////////////////////////////////////////////////////////
+  /// load sentece and init parsing (fill up first row of chart),
+  /// sharing cells with a chart already parsed for another tag 
+  /// sequence of the same sentence. 
+  ////////////////////////////////////////////////////////////////
+
+  void chart::load_sentence(const sentence &s, int k, const chart &r) {
+    load(s,k,&r);
+  }
+
+  ////////////////////////////////////////////////////////////////
+  /// Fill up first row of chart. A word whose selected analyses 
+  /// are the same than in the reference chart uses the cell there.
+  ////////////////////////////////////////////////////////////////
+
+  void chart::load(const sentence &s, int k, const chart *r) {
     int j,n;
     list<wstring> l;
     sentence::const_iterator w;
@@ -153,13 +172,33 @@ return *this;
     n=s.size();
     table.clear();  
     table.assign((1+n)*n/2,cell());
+    cells.clear();
+    for (vector<cell>::const_iterator c=table.begin(); c!=table.end(); c++)
+      cells.push_back(&(*c));
+    size=n;
+
+    // reference chart is only useful if it has the same words.
+    ref = (r!=NULL and r->size==n ? r : NULL);
 
     TRACE(2,L"Table allocated");
     // load sentence words in lower row of the chart
+    signature.assign(n,L"");
     j=0; l.clear();
     for (w=s.begin(); w!=s.end(); w++) {
-      cell ce;
 
+      for (a=w->selected_begin(k); a!=w->selected_end(k); a++) 
+        signature[j] += a->get_tag()+L"<"+a->get_lemma()+L"> ";
+
+      // share the cell if possible. In a one-word sentence it is 
+      // the top cell, which is never shared.
+      if (ref!=NULL and n>1 and signature[j]==ref->signature[j]) {
+        TRACE(3,L"Sharing cell (0,"+util::int2wstring(j)+L")");
+        cells[index(0,j)] = ref->cells[index(0,j)];
+        j++;
+        continue;
+      }
+
+      cell ce;
       for (a=w->selected_begin(k); a!=w->selected_end(k); a++) {
  
         TRACE(3,L"selected tags");
@@ -183,14 +222,15 @@ return *this;
       j++;  
     }
 
-    size=j;
-
     TRACE(3,L"Sentence loaded.");
   }
 
 
   ////////////////////////////////////////////////////////////////
   /// Do the parsing of loaded sentence using current grammar.
+  /// A cell depends only on the words it spans, so if none of 
+  /// them got different analyses than in the reference chart 
+  /// (if any), the cell of the reference chart is used.
   ////////////////////////////////////////////////////////////////
 
   void chart::parse() {
@@ -203,14 +243,31 @@ return *this;
     cell ce;
     edge e;
 
+    // ndiff[i] = number of words before position i whose analyses differ
+    // from those in the reference chart.
+    vector<int> ndiff;
+    if (ref!=NULL) {
+      ndiff.assign(size+1,0);
+      for (i=0; i<size; i++) 
+        ndiff[i+1] = ndiff[i] + (signature[i]!=ref->signature[i] ? 1 : 0);
+    }
+
     // Cycle through lengths
     for (k=1; k<size; k++) {
       // Visit all cells
       for (i=0; i<size-k; i++) {
+        // share the cell if the words it spans are unchanged. The top
+        // cell is never shared, since it may get a fictitious root.
+        if (not ndiff.empty() and k<size-1 and ndiff[i+k+1]==ndiff[i]) {
+          TRACE(3,L"Sharing cell ("+util::int2wstring(k)+L","+util::int2wstring(i)+L")");
+          cells[index(k,i)] = ref->cells[index(k,i)];
+          continue;
+        }
+
         ce.clear();
         for (a=0; a<k; a++) {
           TRACE(3,L"Visiting cell ("+util::int2wstring(a)+L","+util::int2wstring(i)+L")");
-          for (ed=table[index(a,i)].begin(); ed!=table[index(a,i)].end(); ed++) {     
+          for (ed=at(a,i).begin(); ed!=at(a,i).end(); ed++) {     
             if (ed->active()) {
               TRACE(3,L"   Active edge for "+ed->get_head());
               ls=ed->get_right();
@@ -235,7 +292,7 @@ return *this;
     // search for valid roots covering all the sentence.  Valid roots are inactive 
     // edges at cell (size-1,0) which are not marked as @NOTOP
     edge best; gotroot=false;
-    for (ed=table[index(size-1,0)].begin(); ed!=table[index(size-1,0)].end(); ed++) { 
+    for (ed=at(size-1,0).begin(); ed!=at(size-1,0).end(); ed++) { 
       if (!ed->active() && !gram.is_notop(ed->get_head()) && better_edge(*ed,best)) {
         gotroot=true;
         best=(*ed);
@@ -252,7 +309,7 @@ return *this;
       ls.clear();
       for (p=lp.begin(); p!=lp.end(); p++) {
         edge best; 
-        for (ed=table[index(p->first,p->second)].begin(); ed!=table[index(p->first,p->second)].end(); ed++) { 
+        for (ed=at(p->first,p->second).begin(); ed!=at(p->first,p->second).end(); ed++) { 
           if (!ed->active() && better_edge(*ed,best)) 
             best=(*ed);
         } 
@@ -292,7 +349,7 @@ return *this;
     // (this is typically the tree root call.)
     if (label==L"") {
       edge best;
-      for (ed=table[index(x,y)].begin(); ed!=table[index(x,y)].end(); ed++) {
+      for (ed=at(x,y).begin(); ed!=at(x,y).end(); ed++) {
         if (!ed->active() && !gram.is_hidden(ed->get_head()) && better_edge(*ed,best)) {
           label=ed->get_head();
           best=(*ed);
@@ -309,7 +366,7 @@ return *this;
       TRACE(3, L"  Checking: "+label);
       // select edge to expand
       edge best;
-      for (ed=table[index(x,y)].begin(); ed!=table[index(x,y)].end(); ed++) {
+      for (ed=at(x,y).begin(); ed!=at(x,y).end(); ed++) {
         if (!ed->active() && label==ed->get_head() && better_edge(*ed,best)) {
 
           best=(*ed);
@@ -336,13 +393,16 @@ return *this;
             gram.is_onlytop(childlabel) ||
             (gram.is_flat(childlabel) && label==childlabel)) { 
           TRACE(3, L"    -Child is hidden or flat "+label+L" "+childlabel);
-          // skip 'child' and append its daughters
-          for (parse_tree::sibling_iterator x=child.sibling_begin(); x!=child.sibling_end(); ++x) {
+          // skip 'child' and move its daughters under 'tr' (no copies)
+          parse_tree::sibling_iterator x=child.sibling_begin();
+          while (x!=child.sibling_end()) {
+            parse_tree::sibling_iterator nx=x; ++nx;
             // if the skipped child was the head, preserve its head as new head for the father.
             // otherwise, make sure the child's head won't interfere
             if (ch == g) headset=true; 
             else x->set_head(false);            
-            tr.add_child(x);
+            tr.hang_child(x);
+            x=nx;
           }
           TRACE(3, L"     skipped, sons raised. Headset="+wstring(headset?L"YES":L"NO"));
         }
@@ -353,7 +413,7 @@ return *this;
             child.begin()->set_head(true);
             headset=true;
           }
-          tr.add_child(child);
+          tr.add_child(std::move(child));
           TRACE(3, L"     added. Headset="+wstring(headset?L"YES":L"NO"));
         }      
       }
@@ -392,7 +452,7 @@ return *this;
     edge best;
     for (i=a; !f && i>=0; i--) {
       for (j=b; j<b+(a-i)+1; j++) {
-        for (ed=table[index(i,j)].begin(); ed!=table[index(i,j)].end(); ed++) {
+        for (ed=at(i,j).begin(); ed!=at(i,j).end(); ed++) {
           if (!ed->active() && better_edge(*ed,best) ) {
             x=i; y=j; 
             best=(*ed);
@@ -462,6 +522,14 @@ return *this;
     return j + i*(size+1) - (i+1)*i/2;
   }
 
+  ////////////////////////////////////////////////////////////////
+  /// access cell (i,j), either own or shared with reference chart
+  ////////////////////////////////////////////////////////////////
+
+  const cell& chart::at(int i, int j) const {
+    return *cells[index(i,j)];
+  }
+
   ////////////////////////////////////////////////////////////////
   /// find out whether the cell (i,j) has some inactive 
   /// edge whose head is the given category.
@@ -472,7 +540,7 @@ return *this;
     bool b;
 
     b = false;
-    for (ed=table[index(i,j)].begin(); !b && ed!=table[index(i,j)].end(); ed++) {
+    for (ed=at(i,j).begin(); !b && ed!=at(i,j).end(); ed++) {
       TRACE(4,L"   rule head: "+ed->get_head()+L", active: "+util::int2wstring(ed->active()));
       b = (!ed->active() && check_match(hd,ed->get_head()));
     }
@@ -581,9 +649,9 @@ return *this;
 
     for (a=0; a<size; a++) {
       for (i=0; i<size-a; i++) {
-        if (not table[index(a,i)].empty()) {
+        if (not at(a,i).empty()) {
           wcout<<L"Cell ("<<a<<L","<<i<<L")"<<endl;
-          for (ed=table[index(a,i)].begin(); ed!=table[index(a,i)].end(); ed++) {
+          for (ed=at(a,i).begin(); ed!=at(a,i).end(); ed++) {
             wcout<<L"   "<<ed->get_head()<<L" ==>";
             ls=ed->get_matched();
             for (s=ls.begin(); s!=ls.end(); s++) wcout<<L" "<<*s;
@@ -60,40 +60,59 @@ namespace freeling {
 
   void chart_parser::analyze(sentence &s) const {
     TRACE(2,L"CHUNKER ");
-    // parse each of k-best tag sequences
-    for (unsigned int k=0; k<s.num_kbest(); k++) {
-      // create chart for this sentence, using given grammar
-      chart ch(gram);
-   
-      TRACE(3,L"LOOP ");
-      ch.load_sentence(s,k);
-      TRACE(3,L" Sentence loaded.");
-      ch.parse();
-      TRACE(3,L" Sentence parsed.");
-    
-      // navigate through the chart and obtain a parse tree for the sentence
-      parse_tree tr=ch.get_tree(ch.get_size()-1,0);
-
-      // associate leaf nodes in the tree with the right word in the sentence:
-      sentence::iterator w=s.begin();
-      for (parse_tree::preorder_iterator n=tr.begin(); n!=tr.end(); ++n) {
-        TRACE(4,L" Completing tree: "+n->get_label()+L" children:"+util::int2wstring(n.num_children()));
-        if (n.num_children()==0) {
-          n->set_word(*w);
-          n->set_label(w->get_tag(k));
-          w++;
-        }
-      }
+    unsigned int nk = s.num_kbest();
+    if (nk==0) return;
+
+    vector<parse_tree> trees(nk);
+
+    // parse first tag sequence from scratch.
+    chart ch0(gram);
+    ch0.load_sentence(s,0);
+    ch0.parse();
+    TRACE(3,L" Sentence parsed for sequence 0.");
+    trees[0] = build_tree(ch0,s,0);
+
+    // remaining sequences usually differ in a few tags only, so they
+    // share most cells with the first chart, and are parsed in parallel.
+    util::parallel_for(1, nk, [&](size_t k) {
+        chart ch(gram);
+        ch.load_sentence(s,k,ch0);
+        ch.parse();
+        TRACE(3,L" Sentence parsed for sequence "+util::int2wstring(k)+L".");
+        trees[k] = build_tree(ch,s,k);
+      });
+
+    // include the trees in the sentence object
+    TRACE(3,L" Setting sentence parse trees");
+    for (unsigned int k=0; k<nk; k++) 
+      s.set_parse_tree(std::move(trees[k]),k);
 
-      // assign an id to each node and build an index to access them by id
-      TRACE(3,L" Building node index.");
-      tr.build_node_index(s.get_sentence_id());
-      // include the tree in the sentence object
-      TRACE(3,L" Setting sentence parse tree");
-      s.set_parse_tree(tr,k);
-      TRACE(3,L" Parse tree set");
-    }
     TRACE(2,L"CHUNKER DONE");
   }
 
+  ////////////////////////////////////////////////////////////////
+  /// navigate through a parsed chart and obtain the parse tree
+  /// for the k-th tag sequence of the sentence
+  ////////////////////////////////////////////////////////////////
+
+  parse_tree chart_parser::build_tree(const chart &ch, sentence &s, int k) const {
+    parse_tree tr=ch.get_tree(ch.get_size()-1,0);
+
+    // associate leaf nodes in the tree with the right word in the sentence:
+    sentence::iterator w=s.begin();
+    for (parse_tree::preorder_iterator n=tr.begin(); n!=tr.end(); ++n) {
+      TRACE(4,L" Completing tree: "+n->get_label()+L" children:"+util::int2wstring(n.num_children()));
+      if (n.num_children()==0) {
+        n->set_word(*w);
+        n->set_label(w->get_tag(k));
+        w++;
+      }
+    }
+
+    // assign an id to each node and build an index to access them by id
+    TRACE(3,L" Building node index.");
+    tr.build_node_index(s.get_sentence_id());
+    return tr;
+  }
+
 } // namespace
@@ -582,6 +582,8 @@ namespace freeling {
   /////////////////////////////////////////////////////////////////////////////
 
   void relaxcor::analyze(document &doc) const {
+    metrics::probe p(typeid(*this));
+    p.count(doc);
     clock_t t0, t1;
     
     TRACE(3,L"Detecting mentions");
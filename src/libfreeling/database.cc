@@ -211,6 +211,19 @@ namespace freeling {
   }
 
 
+  ///////////////////////////////////////////////////////////////
+  ///  get the key as stored in the DB (only map DBs store it)
+  ///////////////////////////////////////////////////////////////
+
+  const wstring* database::stored_key(const wstring &key) const {
+    if (DBtype==DB_MAP) {
+      map<wstring,wstring>::const_iterator p=dbmap.find(key);
+      if (p!=dbmap.end()) return &(p->first);
+    }
+    return NULL;
+  }
+
+
   ///////////////////////////////////////////////////////////////
   /// dump listing of database to given stream
   ///////////////////////////////////////////////////////////////
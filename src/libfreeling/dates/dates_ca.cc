@@ -428,6 +428,7 @@ namespace freeling {
 
     formU = j->get_form();
     form = j->get_lc_form();
+    int shape = get_shape(form);
 
     token = TK_other;
     im = tok.find(form);
@@ -458,11 +459,11 @@ namespace freeling {
       if (token==TK_number && value>=0 && value<=31) {
         token = TK_daynum; // it can be a "quart" number, an hour number  or a day number
       }
-      else if (RE_Date.search(form,st->rem)) {
+      else if (match_date(form,shape,st->rem)) {
         TRACE(3,L"Match DATE regex. ");
         token = TK_date;
       }
-      else if (RE_Time1.search(form,st->rem)) {
+      else if (match_time1(form,shape,st->rem)) {
         if (st->rem.size()>=3) {   // if (not rem[2].empty()) ??  // if (RE_Time1.Match(2)!="")
           TRACE(3,L"Match TIME1 regex (hour+min)");
           token = TK_hhmm;
@@ -502,7 +503,7 @@ namespace freeling {
       break;
       // --------------------------------
     case ST_S1:
-      if (RE_Roman.search(formU,st->rem)) {
+      if (match_roman(formU,shape,st->rem)) {
         TRACE(3,L"Match ROMAN regex. ");
         token=TK_roman;
       }
@@ -513,7 +514,7 @@ namespace freeling {
       if (token==TK_number && value>=0 && value<=24) {
         token = TK_hournum;
       }
-      if (RE_Time1.search(form,st->rem)) {
+      if (match_time1(form,shape,st->rem)) {
         if (st->rem.size()>=3) {   // if (not rem[2].empty()) ??  // if (RE_Time1.Match(2)!="")
           TRACE(3,L"Match TIME1 regex (hour+min)");
           token = TK_hhmm;
@@ -531,7 +532,7 @@ namespace freeling {
       if (token==TK_number && value>=0 && value<=60) {
         token=TK_minnum;
       }
-      else if (RE_Time2.search(form,st->rem)) {
+      else if (match_time2(form,shape,st->rem)) {
         TRACE(3,L"Match TIME2 regex (minutes)");
         token = TK_min;
       }    
@@ -545,7 +546,7 @@ namespace freeling {
       if (token==TK_number && value>=0 && value<=60) {
         token=TK_minnum;
       }
-      else if (RE_Time2.search(form,st->rem)) {
+      else if (match_time2(form,shape,st->rem)) {
         TRACE(3,L"Match TIME2 regex (minutes)");
         token = TK_min;
       }
@@ -566,7 +567,7 @@ namespace freeling {
       if (token==TK_number && value>0 && value<15) { // "i cinc, i deu..."
         token=TK_minnum;
       }
-      else if (RE_Time2.search(form,st->rem)) {
+      else if (match_time2(form,shape,st->rem)) {
         TRACE(3,L"Match TIME2 regex (minutes)"); 
         token = TK_min;
       }
@@ -578,7 +579,7 @@ namespace freeling {
       if (token==TK_number && value>=0 && value<=24) {
         token = TK_hournum;
       }
-      else if (RE_Time1.search(form,st->rem)) {
+      else if (match_time1(form,shape,st->rem)) {
         if (st->rem.size()<3) {   //  if (rem[2].empty()) ??  // if (RE_Time1.Match(2)=="")
           TRACE(3,L"Partial match TIME1 regex (hour)");
           token = TK_hour;
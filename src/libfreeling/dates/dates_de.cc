@@ -371,6 +371,7 @@ namespace freeling {
 	st->rem.clear(); // clear any previous RE matches
 	formU = j->get_form();
 	form = j->get_lc_form();
+	int shape = get_shape(form);
 	token = TK_other;
 	im = tok.find(form);
 	if (im!=tok.end()) {
@@ -409,7 +410,7 @@ namespace freeling {
 
 	case ST_Start:
 	case ST_read_comma:
-	    if (RE_Date.search(form,st->rem)) {		
+	    if (match_date(form,shape,st->rem)) {		
 		TRACE(3,L"Match DATE (h+m) regex.");
 		//for (unsigned int i = 0; i < st->rem.size(); ++i) {
 		//    //TRACE(3,L" RE " + i + L" " + st->rem[i]);
@@ -417,7 +418,7 @@ namespace freeling {
 		//}
 		token = TK_date;
 	    } 
-	    else if (RE_Time1.search(form,st->rem)) {
+	    else if (match_time1(form,shape,st->rem)) {
 		if (st->rem.size() >= 3 && !st->rem[2].empty()) {
 		    TRACE(3,L"Match TIME1 (h+m) regex.");
 		    token = TK_time;
@@ -436,7 +437,7 @@ namespace freeling {
 	    break;
 
 	case ST_read_um:
-	    if (RE_Time1.search(form,st->rem)) {
+	    if (match_time1(form,shape,st->rem)) {
 		if (st->rem.size() >= 3 && !st->rem[2].empty()) {
 		    TRACE(3,L"Match TIME1 (h+m) regex.");
 		    token = TK_time;
@@ -452,7 +453,7 @@ namespace freeling {
 
 	case ST_read_am:
 	    TRACE(3,L"check Match DATE regex." + form);
-	    if (RE_Date.search(form,st->rem)) {		
+	    if (match_date(form,shape,st->rem)) {		
 		TRACE(3,L"Match DATE regex.");
 		//for (unsigned int i = 0; i < st->rem.size(); ++i) {
 		//    //TRACE(3,L" RE " + i + L" " + st->rem[i]);
@@ -26,6 +26,9 @@
 //
 ////////////////////////////////////////////////////////////////
 
+#include <cwchar>
+#include <cwctype>
+
 #include "freeling/morfo/traces.h"
 #include "freeling/morfo/util.h"
 #include "freeling/morfo/dates_modules.h"
@@ -53,6 +56,78 @@ namespace freeling {
     return (in!=UNKNOWN_SYMB ? util::int2wstring(util::wstring2int(in)+offs) : in);
   }
 
+  ///////////////////////////////////////////////////////////////
+  ///  Classify a token form in shape classes with a single scan.
+  ///  Date and time regexps all start with a digit and need some 
+  ///  separator or unit char, so most words can be discarded
+  ///  without running any regexp.
+  ///////////////////////////////////////////////////////////////
+
+  int dates_module::get_shape(const wstring &form) {
+    if (form.empty()) return 0;
+
+    int shape = SH_ROMAN;
+    // regexps use \d, which matches also non-ASCII digits
+    if (form[0]>=128 or iswdigit(form[0])) shape |= SH_NUMERIC;
+
+    for (wstring::const_iterator c=form.begin(); c!=form.end(); c++) {
+      switch (*c) {
+      case L'/': case L'.': 
+        shape |= SH_DATESEP; break;
+      case L':': case L'h': case L'H': case L'ч': case L'Ч': 
+        shape |= SH_TIMESEP; break;
+      case L'm': case L'M': case L'м': case L'М': 
+        shape |= SH_MINUTES; break;
+      default: break;
+      }
+      // roman numerals are matched on the original form, which may be uppercase
+      if (wcschr(L"IVXLCDMivxlcdm",*c)==NULL or *c==0) shape &= ~SH_ROMAN;
+    }
+    return shape;
+  }
+
+  ///////////////////////////////////////////////////////////////
+  ///  Search given regexp if the form has all required shape classes.
+  ///  Otherwise, return false, leaving rem as a failed search would.
+  ///////////////////////////////////////////////////////////////
+
+  bool dates_module::match(const freeling::regexp &re, int required, const wstring &form, int shape, re_matches *rem) {
+    if ((shape & required) != required) {
+      if (rem!=NULL) rem->clear();
+      return false;
+    }
+    if (rem==NULL) return re.search(form);
+
+    // keep only match spans, and the form they refer to
+    if (not re.search(form,rem->spans)) return false;
+    rem->form = form;
+    return true;
+  }
+
+  ///////////////////////////////////////////////////////////////
+  ///  Search date/time regexps on given form, if its shape
+  ///  makes a match possible.
+  ///////////////////////////////////////////////////////////////
+
+  bool dates_module::match_date(const wstring &form, int shape) const {
+    return match(RE_Date, SH_NUMERIC|SH_DATESEP, form, shape, NULL);
+  }
+  bool dates_module::match_date(const wstring &form, int shape, re_matches &rem) const {
+    return match(RE_Date, SH_NUMERIC|SH_DATESEP, form, shape, &rem);
+  }
+  bool dates_module::match_time1(const wstring &form, int shape, re_matches &rem) const {
+    return match(RE_Time1, SH_NUMERIC|SH_TIMESEP, form, shape, &rem);
+  }
+  bool dates_module::match_time2(const wstring &form, int shape) const {
+    return match(RE_Time2, SH_NUMERIC|SH_MINUTES, form, shape, NULL);
+  }
+  bool dates_module::match_time2(const wstring &form, int shape, re_matches &rem) const {
+    return match(RE_Time2, SH_NUMERIC|SH_MINUTES, form, shape, &rem);
+  }
+  bool dates_module::match_roman(const wstring &form, int shape, re_matches &rem) const {
+    return match(RE_Roman, SH_ROMAN, form, shape, &rem);
+  }
+
 
   ///////////////////////////////////////////////////////////////
   ///   Reset acumulators used by state actions:
@@ -130,17 +205,18 @@ namespace freeling {
   int dates_default::ComputeToken(int state, sentence::iterator &j, sentence &se) const {
     wstring form,formU;
     int token;
-    vector<wstring> rem;  // to store r.e. match results
+    re_matches rem;  // to store r.e. match results
 
     formU = j->get_form();
     form = j->get_lc_form();
+    int shape = get_shape(form);
 
     token = TK_other;
-    if (RE_Date.search(form)) {
+    if (match_date(form,shape)) {
       TRACE(3,L"Match DATE regex.");  
       token = TK_date;
     }
-    else if (RE_Time1.search(form,rem)) {
+    else if (match_time1(form,shape,rem)) {
       if (rem.size()>=3) {   // if (not rem[2].str().empty()) ??  // if (RE_Time1.Match(2)!="")
         TRACE(3,L"Match TIME1 regex (hour+min)");
         token = TK_hhmm;
@@ -150,7 +226,7 @@ namespace freeling {
         token = TK_hour;
       }
     }
-    else if (RE_Time2.search(form)) {
+    else if (match_time2(form,shape)) {
       TRACE(3,L"Match TIME2 regex (minutes)");
       token = TK_min;
     }
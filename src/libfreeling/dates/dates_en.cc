@@ -483,6 +483,7 @@ namespace freeling {
     st->rem.clear(); // clear any previous RE matches
 
     form = j->get_lc_form();
+    int shape = get_shape(form);
 
     token = TK_other;  
     // check if it is a known token
@@ -537,11 +538,11 @@ namespace freeling {
       if (token==TK_number && value>=0 && value<=59) {
         token = TK_minnum; // it can also be an hournum
       }
-      else if (RE_Date.search(form,st->rem)) {
+      else if (match_date(form,shape,st->rem)) {
         TRACE(3,L"Match DATE regex. ");
         token = TK_date;
       }
-      else if (RE_Time1.search(form,st->rem)) {
+      else if (match_time1(form,shape,st->rem)) {
         if (st->rem.size()>=3) {   //  if (RE_Time1.Match(2)!="")
           TRACE(3,L"Match TIME1 regex (hour+min)");
           token = TK_hhmm;
@@ -551,7 +552,7 @@ namespace freeling {
           token = TK_hour;
         }  
       }
-      else if (RE_Time2.search(form,st->rem)) {
+      else if (match_time2(form,shape,st->rem)) {
         token = TK_min;
       }
     
@@ -564,11 +565,11 @@ namespace freeling {
       if (token==TK_number && value>=0 && value<=31){
         token = TK_daynum;
       }
-      else if (RE_Date.search(form,st->rem)) {
+      else if (match_date(form,shape,st->rem)) {
         TRACE(3,L"Match DATE regex. ");
         token = TK_date;
       }
-      else if (RE_Time1.search(form,st->rem)) {
+      else if (match_time1(form,shape,st->rem)) {
         if (st->rem.size()>=3) {   //  if (RE_Time1.Match(2)!="")
           TRACE(3,L"Match TIME1 regex (hour+min)");
           token = TK_hhmm;
@@ -578,7 +579,7 @@ namespace freeling {
           token = TK_hour;
         }  
       }
-      else if (RE_Time2.search(form,st->rem)) {
+      else if (match_time2(form,shape,st->rem)) {
         token = TK_min;
       }
       
@@ -658,7 +659,7 @@ namespace freeling {
       if (token==TK_number && value>=0 && value<=60) {
         token = TK_minnum;
       }
-      else if (RE_Time1.search(form,st->rem)) {
+      else if (match_time1(form,shape,st->rem)) {
         if (st->rem.size()>=3) {   //  if (RE_Time1.Match(2)!="")
           TRACE(3,L"Match TIME1 regex (hour+min)");
           token = TK_hhmm;
@@ -676,7 +677,7 @@ namespace freeling {
       if (token==TK_number && value>=0 && value<=60) {
         token=TK_minnum;
       }
-      else if (RE_Time2.search(form,st->rem)) {
+      else if (match_time2(form,shape,st->rem)) {
         TRACE(3,L"Match TIME2 regex (minutes)");
         token = TK_min;
       }    
@@ -690,7 +691,7 @@ namespace freeling {
       if (token==TK_number && value>=0 && value<=24) {
         token = TK_hournum;
       }
-      else if (RE_Time1.search(form,st->rem)) {
+      else if (match_time1(form,shape,st->rem)) {
         if (st->rem.size()>=3) {   //  if (RE_Time1.Match(2)!="")
           TRACE(3,L"Match TIME1 regex (hour+min)");
           token = TK_hhmm;
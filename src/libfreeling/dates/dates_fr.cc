@@ -419,6 +419,7 @@ namespace freeling {
 
 	formU = j->get_form();
 	form = j->get_lc_form();
+	int shape = get_shape(form);
 
 	token = TK_other;
 	im = tok.find(form);
@@ -460,7 +461,7 @@ namespace freeling {
 	switch (state) {
         case ST_1:
 	case ST_3:
-	    if (RE_Date.search(form,st->rem)) {
+	    if (match_date(form,shape,st->rem)) {
 		TRACE(3,L"Match DATE regex.");
 		token = TK_date;
 	    }
@@ -483,7 +484,7 @@ namespace freeling {
 
 	case ST_9:
           //	    wcerr << L"feeeeee " << form << L" " << st->rem.size() << endl;
-	    if (RE_Time1.search(form,st->rem)) {
+	    if (match_time1(form,shape,st->rem)) {
 		if (st->rem.size() >= 3 && !st->rem[2].empty()) {
 		    TRACE(3,L"Match TIME1 (h+m) regex.");
 		    token = TK_time;
@@ -217,6 +217,7 @@ namespace freeling {
     dates_status *st = (dates_status *)se.get_processing_status();
   
     form = j->get_lc_form();
+    int shape = get_shape(form);
 
     im = tok.find(form);
     if (im!=tok.end())
@@ -236,7 +237,7 @@ namespace freeling {
         TRACE(3,L"Numerical value of form: "+util::int2wstring(value));
       }
 
-    vector<wstring> rem;  // store regex matches
+    re_matches rem;  // store regex matches
 
     // determine how to interpret that number, or if not number, check for specific regexps.
     switch (state) 
@@ -247,12 +248,12 @@ namespace freeling {
           {
             token = TK_minnum; // it can also be an hournum
           }
-        else if (RE_Date.search(form)) 
+        else if (match_date(form,shape)) 
           {
             TRACE(3,L"Match DATE regex. ");
             token = TK_date;
           }
-        else if (RE_Time1.search(form, rem)) 
+        else if (match_time1(form, shape, rem)) 
           {
             if (rem.size()>=3) 
               {
@@ -268,7 +269,7 @@ namespace freeling {
                 token = TK_hour;
               }  
           }
-        else if (RE_Time2.search(form, rem))
+        else if (match_time2(form, shape, rem))
           {
             token = TK_min;
             st->minute = rem[1];
@@ -303,7 +304,7 @@ namespace freeling {
     std::wstring form = j->get_lc_form();
     int value;
     map<wstring,int>::const_iterator im;
-    vector<wstring> rem;  // store regex matches
+    re_matches rem;  // store regex matches
 
     TRACE(3,L"Reaching state "+util::int2wstring(state)+L" with token "+util::int2wstring(token)+L" for word ["+form+L"]");
 
@@ -334,7 +335,7 @@ namespace freeling {
         if (token==TK_date) 
           {
             std::wstring form = j->get_form();
-            RE_Date.search(form, rem);
+            match_date(form, get_shape(form), rem);
             // day number
             st->day=rem[1];
             // month number (translating month name if necessary) 
@@ -38,6 +38,7 @@
 #include "freeling/morfo/dep_rules.h"
 #include "freeling/morfo/dep_txala.h"
 #include "freeling/morfo/configfile.h"
+#include "freeling/morfo/status_pool.h"
 
 using namespace std;
 
@@ -53,11 +54,12 @@ namespace freeling {
   /// constructor. Load a dependecy rule file.
   ///////////////////////////////////////////////////////////////
 
-  dep_txala::dep_txala(const wstring & filename, const wstring & startSymbol) {
+  dep_txala::dep_txala(const wstring & filename, const wstring & startSymbol) : default_rule(L"-",L"-",L"top_left") {
 
     TRACE(1,L"Loading dep_txala file "+filename);
     start = startSymbol;
     semdb = NULL;
+    left_reach = right_reach = 0;
 
     wstring path=filename.substr(0,filename.find_last_of(L"/\\")+1);
     wstring fname=filename.substr(filename.find_last_of(L"/\\")+1);
@@ -324,9 +326,28 @@ namespace freeling {
       r.node2 = r.node2.substr(0,p); 
     }
     
+    // keep track of how far contexts may look, so completion knows
+    // which chunk pairs are affected when two chunks are merged.
+    for (int side=0; side<2; side++) {
+      const vector<matching_condition> &ctx = (side==0 ? r.leftContext : r.rightContext);
+      int &reach = (side==0 ? left_reach : right_reach);
+      for (size_t c=0; c<ctx.size() and reach>=0; c++)
+        if (ctx[c].label==L"*") reach = -1;
+      if (reach>=0) reach = max(reach, (int)ctx.size());
+    }
+
     // Store rule
     TRACE(3,L"Loaded rule: [line "+r.line+L"] ");
-    chgram[make_pair(r.leftChk,r.rightChk)].push_back(r);          
+    unsigned long long key = ((unsigned long long)label_code(r.leftChk)<<32) | label_code(r.rightChk);
+    chgram[key].push_back(r);          
+  }
+
+  ///////////////////////////////////////////////////////////////
+  /// get code for a chunk label, creating it if needed
+  ///////////////////////////////////////////////////////////////
+
+  unsigned int dep_txala::label_code(const wstring &label) {
+    return label_codes.insert(make_pair(label,(unsigned int)label_codes.size())).first->second;
   }
 
   ///////////////////////////////////////////////////////////////
@@ -494,6 +515,13 @@ namespace freeling {
       mtree->begin()->set_chunk(nchunk);
       trees.push_back(mtree);
     }
+
+    // best rule for each pair of adjacent chunks, computed on demand.
+    // After each merge, only pairs whose context may see the merged 
+    // chunk need to be computed again.
+    size_t npairs = (trees.size()>0 ? trees.size()-1 : 0);
+    st->best.assign(npairs, (const completer_rule*)NULL);
+    st->last.assign(npairs, parse_tree::iterator());
   
     // Apply as many rules as number of chunks minus one (since each rule fusions two chunks in one)
     for (nchunk=0; nchunk<maxchunk-1; ++nchunk) {
@@ -510,17 +538,21 @@ namespace freeling {
       }
 
       TRACE(3,L"LOOKING FOR BEST APPLICABLE RULE");
-      size_t chk=0;
-      completer_rule bestR = find_grammar_rule(trees, chk, st);
-      int best_prio= bestR.weight;
-      size_t best_pchunk = chk;
+      size_t chk;
+      for (chk=0; chk<trees.size()-1; chk++) 
+        if (st->best[chk]==NULL) 
+          st->best[chk] = find_grammar_rule(trees, chk, st, st->last[chk]);
+
+      const completer_rule *bestR = st->best[0];
+      int best_prio= bestR->weight;
+      size_t best_pchunk = 0;
 
       chk=1;
       while (chk<trees.size()-1) {
-        completer_rule r = find_grammar_rule(trees, chk, st);
+        const completer_rule *r = st->best[chk];
 
-        if ( (r.weight==best_prio && chk<best_pchunk) || (r.weight>0 && r.weight<best_prio) || (best_prio<=0 && r.weight>best_prio) ) {
-          best_prio = r.weight;
+        if ( (r->weight==best_prio && chk<best_pchunk) || (r->weight>0 && r->weight<best_prio) || (best_prio<=0 && r->weight>best_prio) ) {
+          best_prio = r->weight;
           best_pchunk = chk;
           bestR = r;
         }
@@ -528,22 +560,29 @@ namespace freeling {
         chk++;
       }
     
-      TRACE(2,L"BEST RULE SELECTED. Apply rule [line "+util::int2wstring(bestR.line)+L"] to chunk trees["+util::int2wstring(best_pchunk)+L"]");
+      TRACE(2,L"BEST RULE SELECTED. Apply rule [line "+bestR->line+L"] to chunk trees["+util::int2wstring(best_pchunk)+L"]");
     
-      parse_tree * resultingTree=applyRule(bestR, best_pchunk, trees[best_pchunk], trees[best_pchunk+1], st);
+      parse_tree * resultingTree=applyRule(*bestR, st->last[best_pchunk], trees[best_pchunk], trees[best_pchunk+1], st);
 
       TRACE(2,L"Rule applied - Erasing chunk in trees["+util::int2wstring(best_pchunk+1)+L"]");
       trees[best_pchunk]=resultingTree;
-      trees[best_pchunk+1]=NULL;     
-      vector<parse_tree*>::iterator end = remove (trees.begin(), trees.end(), (parse_tree*)NULL);    
-      trees.erase (end, trees.end());    
-
-      // clear rule appliactions to start fresh at next iteration
-      st->last.clear();
+      trees.erase(trees.begin()+best_pchunk+1);
+      st->best.erase(st->best.begin()+best_pchunk);
+      st->last.erase(st->last.begin()+best_pchunk);
+
+      // forget results for pairs whose chunks or context include the merged chunk.
+      // If the rule toggled flags, any pair may be affected.
+      int from=0, to=(int)st->best.size()-1;
+      if (bestR->flags_toggle_on.empty() and bestR->flags_toggle_off.empty()) {
+        if (right_reach>=0) from = max(from, (int)best_pchunk-1-right_reach);
+        if (left_reach>=0) to = min(to, (int)best_pchunk+left_reach);
+      }
+      for (int i=from; i<=to; i++) st->best[i]=NULL;
     }
   
-    // rebuild node index with new iterators, maintaining id's
-    parse_tree ret_val = (*trees[0]); 
+    // take over the resulting nodes and rebuild node index 
+    // with new iterators, maintaining id's
+    parse_tree ret_val(std::move(*trees[0])); 
     delete trees[0];
     ret_val.rebuild_node_index();
     return (ret_val);
@@ -868,31 +907,28 @@ namespace freeling {
   /// check if the operation is executable (for last_left cases)
   ///////////////////////////////////////////////////////////////
 
-  bool dep_txala::matching_operation(const vector<parse_tree *> &trees, const size_t chk, const completer_rule &r, dep_txala_status *st) const {
+  bool dep_txala::matching_operation(const vector<parse_tree *> &trees, const size_t chk, const completer_rule &r, parse_tree::iterator &last) const {
 
     // "top" operations are always feasible
     if (r.operation != L"last_left" && r.operation!=L"cover_last_left") 
       return true;
 
-    // build id to store that this is the application of rule num "r.line" to chunk number "chk"
-    wstring aid = r.line+L":"+util::int2wstring(chk);
-
     // locate last_left matching node 
-    st->last[aid] = trees[chk]->end();
+    last = trees[chk]->end();
     for (parse_tree::iterator i=trees[chk]->begin(); i!=trees[chk]->end(); ++i) {
       TRACE(5,L"           matching operation: "+r.operation+L". Rule expects "+r.matchingCond.label+L", node is "+i->get_label());
       if (match_condition(i,r.matchingCond)) 
-        st->last[aid] = i;  // remember node location in case the rule is finally selected.
+        last = i;  // remember node location in case the rule is finally selected.
     }
    
     // No matching node found
-    if (st->last[aid]==trees[chk]->end()) {
+    if (last==trees[chk]->end()) {
       TRACE(4,L"        Operation does NOT match");
       return false;
     }
     
     // Matching node exists. Check whether rule application would break tree projectivity.
-    int head_end = parse_tree::get_rightmost_leaf(st->last[aid])->get_word().get_position();
+    int head_end = parse_tree::get_rightmost_leaf(last)->get_word().get_position();
     int chunk_end = parse_tree::get_rightmost_leaf(trees[chk])->get_word().get_position();
     int child_begin = parse_tree::get_leftmost_leaf(trees[chk+1])->get_word().get_position();
     if (chunk_end>head_end and chunk_end<child_begin) {
@@ -929,18 +965,22 @@ namespace freeling {
   /// chunk in "chk" position of "trees" and his right-hand-side mate.
   ///////////////////////////////////////////////////////////////
 
-  completer_rule dep_txala::find_grammar_rule(const vector<parse_tree *> &trees, const size_t chk, dep_txala_status *st) const {
+  const completer_rule* dep_txala::find_grammar_rule(const vector<parse_tree *> &trees, const size_t chk, dep_txala_status *st, parse_tree::iterator &last) const {
 
-    wstring leftChunk = trees[chk]->begin()->get_label();
-    wstring rightChunk = trees[chk+1]->begin()->get_label();
+    const wstring &leftChunk = trees[chk]->begin()->get_label();
+    const wstring &rightChunk = trees[chk+1]->begin()->get_label();
     TRACE(3,L"  Look up rule for: ("+leftChunk+L","+rightChunk+L")");
 
     // find rules matching the chunks
-    map<pair<wstring,wstring>,list<completer_rule> >::const_iterator r;
-    r = chgram.find(make_pair(leftChunk,rightChunk));
+    unordered_map<unsigned long long,list<completer_rule> >::const_iterator r = chgram.end();
+    unordered_map<wstring,unsigned int>::const_iterator lc = label_codes.find(leftChunk);
+    unordered_map<wstring,unsigned int>::const_iterator rc = label_codes.find(rightChunk);
+    if (lc!=label_codes.end() and rc!=label_codes.end()) 
+      r = chgram.find(((unsigned long long)lc->second<<32) | rc->second);
  
     list<completer_rule>::const_iterator i;  
     list<completer_rule>::const_iterator best;
+    parse_tree::iterator lst;
     int bprio= -1;
     bool found=false;
     if (r != chgram.end()) { 
@@ -956,12 +996,13 @@ namespace freeling {
             && match_condition(trees[chk+1]->begin(),i->rightConds) 
             && matching_pair(trees,chk,*i)
             && matching_context(trees,chk,*i)
-            && matching_operation(trees,chk,*i,st)) {
+            && matching_operation(trees,chk,*i,lst)) {
      
           if (bprio == -1 || bprio>i->weight) {
             found = true;
             best=i;
             bprio=i->weight;
+            last=lst;
           }
 
           TRACE(3,L"    Candidate: [line "+util::int2wstring(i->line)+L"] -- MATCH");
@@ -973,11 +1014,11 @@ namespace freeling {
     }
 
     if (found) 
-      return (*best);
+      return &(*best);
     else {
       TRACE(3,L"    NO matching candidates found, applying default rule.");    
       // Default rule: top_left, no relabel
-      return completer_rule(L"-",L"-",L"top_left");
+      return &default_rule;
     }
   
   }
@@ -987,7 +1028,7 @@ namespace freeling {
   /// apply a tree completion rule
   ///////////////////////////////////////////////////////////////
 
-  parse_tree * dep_txala::applyRule(const completer_rule & r, int chk, parse_tree * chunkLeft, parse_tree * chunkRight, dep_txala_status *st) const {
+  parse_tree * dep_txala::applyRule(const completer_rule & r, parse_tree::iterator last, parse_tree * chunkLeft, parse_tree * chunkRight, dep_txala_status *st) const {
   
     // toggle necessary flags on/off
     set<wstring>::const_iterator x;
@@ -996,9 +1037,6 @@ namespace freeling {
     for (x=r.flags_toggle_off.begin(); x!=r.flags_toggle_off.end(); x++) 
       st->active_flags.erase(*x);
 
-    // build id to retrieve that this is the application of rule num "r.line" to chunk number "chk"
-    wstring aid = r.line+L":"+util::int2wstring(chk);
-
     // hang left tree under right tree root
     if (r.operation==L"top_right") {
       TRACE(3,L"Applying rule: Insert left chunk under top_right");
@@ -1048,10 +1086,10 @@ namespace freeling {
       TRACE(3,L"Applying rule: Insert right chunk under last_left with label "+r.matchingCond.label);
       // Left is head, so unmark Right as head.
       chunkRight->begin()->set_head(false); 
-      TRACE(4,L"recovering last right match for rule "+r.line+L" application "+aid);
+      TRACE(4,L"recovering last right match for rule "+r.line);
       // obtain last node with given label in Left tree
-      // We stored it in the rule when checking for its applicability.
-      parse_tree::iterator p=st->last[aid];
+      // We stored it when checking for the rule applicability.
+      parse_tree::iterator p=last;
       TRACE(4,L"   node recovered is: ");
       TRACE(4,L"     "+p->get_label());    // hang Right tree under last node in Left tree
       p.hang_child(*chunkRight); 
@@ -1066,8 +1104,7 @@ namespace freeling {
       chunkRight->begin()->set_head(true); 
       chunkLeft->begin()->set_head(false); 
       // obtain last node with given label in Left tree
-      // We stored it in the rule when checking for its applicability.
-      parse_tree::iterator last=st->last[aid];
+      // We stored it when checking for the rule applicability.
       parse_tree::iterator parent = last.get_parent();
       // put last_left tree under Right tree (removing it from its original place)
       chunkRight->begin().hang_child(last); 
@@ -1162,24 +1199,24 @@ namespace freeling {
 
   void dep_txala::complete_parse_tree(sentence &s) const {
 
-    // parse each of k-best tag sequences
-    for (unsigned int k=0; k<s.num_kbest(); k++) {
-
-      dep_txala_status *st = new dep_txala_status();
-      st->active_flags.insert(L"INIT");
-      s.set_processing_status((processor_status*)st);
+    // complete each of k-best tag sequences in parallel. Each one
+    // uses its own status, which is not stored in the shared sentence.
+    unsigned int nk = s.num_kbest();
+    vector<parse_tree> done(nk);
+    util::parallel_for(0, nk, [&](size_t k) {
+        dep_txala_status *st = status_pool<dep_txala_status>::acquire();
+        st->active_flags.insert(L"INIT");
 
-      // get chunker output
-      parse_tree buff = s.get_parse_tree(k);
-      // complete it into a full parsing tree
-      parse_tree ntr = complete(buff,start,st);
-      // store complete tree in the sentence
-      s.set_parse_tree(ntr,k);    
+        // complete chunker output into a full parsing tree
+        done[k] = complete(s.get_parse_tree(k),start,st);
+        // parse_tree::PrintTree(done[k].begin(),k,0); // debugging
 
-      // parse_tree::PrintTree(ntr.begin(),k,0); // debugging
+        st->release();
+      });
 
-      s.clear_processing_status();
-    }
+    // store complete trees in the sentence
+    for (unsigned int k=0; k<nk; k++) 
+      s.set_parse_tree(std::move(done[k]),k);    
   }
 
   ///////////////////////////////////////////////////////////////
@@ -1210,20 +1247,22 @@ namespace freeling {
     // complete parse trees using completion rules
     complete_parse_tree(s);
 
-    // convert to dependencies and label dep tree
-    for (unsigned int k=0; k<s.num_kbest(); k++) {    
-      // Convert full parse tree to dependencies tree
-      dep_tree* deps = dependencies(s.get_parse_tree(k).begin(),s.get_parse_tree(k).begin());
-      // Set labels on the dependencies
-      label(deps);
-    
+    // convert to dependencies and label dep trees
+    unsigned int nk = s.num_kbest();
+    vector<dep_tree*> deps(nk);
+    util::parallel_for(0, nk, [&](size_t k) {
+        // Convert full parse tree to dependencies tree
+        deps[k] = dependencies(s.get_parse_tree(k).begin(),s.get_parse_tree(k).begin());
+        // Set labels on the dependencies
+        label(deps[k]);
+      });
+
+    for (unsigned int k=0; k<nk; k++) {
       // store the tree in the sentence
-      s.set_dep_tree(*deps,k);
-
+      s.set_dep_tree(std::move(*deps[k]),k);
       // PrintDepTree(s.get_dep_tree().begin(),0); // debugging
-      delete(deps);
+      delete(deps[k]);
     }
-
   }
 
 
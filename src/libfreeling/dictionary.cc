@@ -29,6 +29,8 @@
 #include <fstream>
 #include <sstream>
 #include <vector>
+#include <set>
+#include <algorithm>
 
 #include "freeling/morfo/dictionary.h"
 #include "freeling/morfo/configfile.h"
@@ -42,6 +44,12 @@ namespace freeling {
 #define MOD_TRACENAME L"DICTIONARY"
 #define MOD_TRACECODE DICT_TRACE
 
+/// recent changes are compacted into settled ones when they exceed this size
+#define RECENT_CHANGES_SIZE 256
+
+  /// counter to assign a unique id to each dictionary instance
+  static atomic<unsigned long> dictionary_instances(0);
+
 
   ///////////////////////////////////////////////////////////////
   ///  Create a dictionary module, open database.
@@ -81,7 +89,7 @@ namespace freeling {
         // create database for dictionary entries
         morfodb = new database(type);
         // create inverse dict if needed
-        if (opts.config_opt.MACO_InverseDictionary) inverdb=new database(DB_MAP);
+        if (opts.config_opt.MACO_InverseDictionary) inverdb=new inverse_index();
         break;
       }
 
@@ -107,11 +115,8 @@ namespace freeling {
         // add to database
         morfodb->add_database(key,data);
         
-        // add info to inverse dict entry if needed.
-        if (opts.config_opt.MACO_InverseDictionary)
-          for (list<pair<wstring,list<wstring> > >::const_iterator p=lems.begin(); p!=lems.end(); p++)
-            for (list<wstring>::const_iterator t=p->second.begin(); t!=p->second.end(); t++) 
-              inverdb->add_database(p->first+L"#"+*t, key);      
+        // add info to inverse index if needed.
+        if (inverdb!=NULL) inverdb->add(key,morfodb->stored_key(key),lems);
 
         break;
       }
@@ -122,6 +127,25 @@ namespace freeling {
 
     cfg.close();
 
+    // compute inverse index postings
+    if (inverdb!=NULL) inverdb->build();
+
+    // initial version, with no changes. Set before creating the
+    // affix and compound analyzers, which may already query us.
+    version *v = new version();
+    v->epoch = 0;
+    v->settled = make_shared<const changes>();
+    v->recent = v->settled;
+    current = shared_ptr<const version>(v);
+    epoch = 0;
+    instance = ++dictionary_instances;
+
+    // create annotation cache if required
+    wcache = NULL;
+    cache_hits = 0; cache_misses = 0;
+    if (opts.config_opt.MACO_WordCacheSize > 0)
+      wcache = new lru_cache<wstring,cached_annotation>(opts.config_opt.MACO_WordCacheSize);
+
     // create affix analyzer if required
     suf = NULL;
     if (not opts.config_opt.MACO_AffixFile.empty())
@@ -158,6 +182,7 @@ namespace freeling {
       // delete compound analyzer, if any
       delete(comp);
     #endif
+    delete wcache;
   }
 
 
@@ -243,34 +268,203 @@ namespace freeling {
   }
 
 
+  /////////////////////////////////////////////////////////////////////////////
+  /// Get current version of dictionary changes. The version last seen by
+  /// each thread is kept, and only reloaded when a writer publishes a new one,
+  /// so readers do not contend on the shared pointer.
+  /////////////////////////////////////////////////////////////////////////////
+
+  shared_ptr<const dictionary::version> dictionary::get_version() const {
+    static thread_local unsigned long seen_instance=0;
+    static thread_local shared_ptr<const version> seen;
+
+    if (seen_instance!=instance or seen->epoch!=epoch.load(memory_order_acquire)) {
+      seen = atomic_load(&current);
+      seen_instance = instance;
+    }
+    return seen;
+  }
+
+  /////////////////////////////////////////////////////////////////////////////
+  /// Look up a form in forms database, applying recent and
+  /// settled changes, in that order, before the loaded database.
+  /////////////////////////////////////////////////////////////////////////////
+
+  wstring dictionary::access(const wstring &key, const changes &recent, const changes &settled) const {
+    unordered_map<wstring,wstring>::const_iterator p = recent.forms.find(key);
+    if (p!=recent.forms.end()) return p->second;
+
+    p = settled.forms.find(key);
+    if (p!=settled.forms.end()) return p->second;
+
+    return morfodb->access_database(key);
+  }
+
+  /////////////////////////////////////////////////////////////////////////////
+  /// Look up forms for a lemma and tag, applying recent and settled
+  /// changes, in that order, before the loaded inverse index.
+  /////////////////////////////////////////////////////////////////////////////
+
+  void dictionary::access_inverse(const wstring &lemma, const wstring &tag, const changes &recent, const changes &settled,
+                                  vector<const wstring*> &out) const {
+    out.clear();
+    const vector<wstring> *fms = NULL;
+    if (not recent.inverse.empty() or not settled.inverse.empty()) {
+      wstring key = lemma+L"#"+tag;
+      unordered_map<wstring,vector<wstring> >::const_iterator p = recent.inverse.find(key);
+      if (p!=recent.inverse.end()) fms = &p->second;
+      else {
+        p = settled.inverse.find(key);
+        if (p!=settled.inverse.end()) fms = &p->second;
+      }
+    }
+
+    if (fms!=NULL) {
+      for (vector<wstring>::const_iterator f=fms->begin(); f!=fms->end(); f++) out.push_back(&(*f));
+    }
+    else 
+      inverdb->get(lemma,tag,out);
+  }
+
+  /////////////////////////////////////////////////////////////////////////////
+  /// Get id of a lemma or tag in the inverse index, adding it if new
+  /////////////////////////////////////////////////////////////////////////////
+
+  unsigned int dictionary::inverse_index::intern(unordered_map<wstring,unsigned int> &ids, const wstring &s) {
+    return ids.insert(make_pair(s,(unsigned int)ids.size())).first->second;
+  }
+
+  /////////////////////////////////////////////////////////////////////////////
+  /// Add a form and its (lemma, tags) pairs to the inverse index.
+  /////////////////////////////////////////////////////////////////////////////
+
+  void dictionary::inverse_index::add(const wstring &form, const wstring *stored, 
+                                      const list<pair<wstring,list<wstring> > > &lems) {
+    unsigned int id = forms.size();
+    if (stored==NULL) {
+      copies.push_back(form);
+      stored = &copies.back();
+    }
+    forms.push_back(stored);
+    for (list<pair<wstring,list<wstring> > >::const_iterator p=lems.begin(); p!=lems.end(); p++) {
+      unsigned long long lm = intern(lemmas,p->first);
+      for (list<wstring>::const_iterator t=p->second.begin(); t!=p->second.end(); t++) 
+        pending.push_back(make_pair((lm<<32) | intern(tags,*t), id));
+    }
+  }
+
+  /////////////////////////////////////////////////////////////////////////////
+  /// Build postings: sorting by pair keeps forms of each pair in loading order.
+  /////////////////////////////////////////////////////////////////////////////
+
+  void dictionary::inverse_index::build() {
+    sort(pending.begin(),pending.end());
+    form_ids.reserve(pending.size());
+    for (size_t i=0; i<pending.size(); i++) {
+      if (i==0 or pending[i].first!=pending[i-1].first) 
+        postings.insert(make_pair(pending[i].first, make_pair((unsigned int)form_ids.size(), 0u)));
+      postings[pending[i].first].second++;
+      form_ids.push_back(pending[i].second);
+    }
+    vector<pair<unsigned long long,unsigned int> >().swap(pending);
+  }
+
+  /////////////////////////////////////////////////////////////////////////////
+  /// Get forms for given lemma and tag from the inverse index
+  /////////////////////////////////////////////////////////////////////////////
+
+  void dictionary::inverse_index::get(const wstring &lemma, const wstring &tag, vector<const wstring*> &out) const {
+    unordered_map<wstring,unsigned int>::const_iterator l = lemmas.find(lemma);
+    if (l==lemmas.end()) return;
+    unordered_map<wstring,unsigned int>::const_iterator t = tags.find(tag);
+    if (t==tags.end()) return;
+
+    unordered_map<unsigned long long,pair<unsigned int,unsigned int> >::const_iterator p;
+    p = postings.find(((unsigned long long)l->second<<32) | t->second);
+    if (p==postings.end()) return;
+
+    for (unsigned int i=p->second.first; i<p->second.first+p->second.second; i++)
+      out.push_back(forms[form_ids[i]]);
+  }
+
+  /////////////////////////////////////////////////////////////////////////////
+  /// Publish a new version with given recent changes (taking ownership).
+  /// If there are too many recent changes, compact them into settled ones.
+  /// Caller must hold update_sem.
+  /////////////////////////////////////////////////////////////////////////////
+
+  void dictionary::publish(const shared_ptr<const version> &old, changes *recent) {
+    version *v = new version();
+    v->epoch = old->epoch + 1;
+
+    if (recent->forms.size()+recent->inverse.size() > RECENT_CHANGES_SIZE) {
+      TRACE(3,L"Compacting recent dictionary changes");
+      changes *settled = new changes(*old->settled);
+      for (unordered_map<wstring,wstring>::const_iterator p=recent->forms.begin(); p!=recent->forms.end(); p++) 
+        settled->forms[p->first] = p->second;
+      for (unordered_map<wstring,vector<wstring> >::const_iterator p=recent->inverse.begin(); p!=recent->inverse.end(); p++) 
+        settled->inverse[p->first] = p->second;
+      delete recent;
+      v->settled = shared_ptr<const changes>(settled);
+      v->recent = make_shared<const changes>();
+    }
+    else {
+      v->settled = old->settled;
+      v->recent = shared_ptr<const changes>(recent);
+    }
+
+    atomic_store(&current, shared_ptr<const version>(v));
+    epoch.store(v->epoch, memory_order_release);
+
+    // cached annotations may be outdated now
+    if (wcache!=NULL) wcache->clear_safe();
+  }
+
+  /////////////////////////////////////////////////////////////////////////////
+  /// Record in given changes that a form has a new analysis, for the inverse index
+  /////////////////////////////////////////////////////////////////////////////
+
+  void dictionary::add_inverse(const wstring &form, const analysis &an, changes &ch, const changes &settled) const {
+    vector<const wstring*> fms;
+    access_inverse(an.get_lemma(), an.get_tag(), ch, settled, fms);
+    vector<wstring> lf;
+    for (vector<const wstring*>::const_iterator f=fms.begin(); f!=fms.end(); f++) lf.push_back(**f);
+    lf.push_back(form);
+    ch.inverse[an.get_lemma()+L"#"+an.get_tag()].swap(lf);
+  }
+
   /////////////////////////////////////////////////////////////////////////////
   /// remove entry from dictionary
   /////////////////////////////////////////////////////////////////////////////
 
   void dictionary::remove_entry(const std::wstring &form) {
 
+    update_sem.lock();
+    shared_ptr<const version> v = atomic_load(&current);
+    // copy-on-write: changes are made on a private copy of the recent ones
+    changes *ch = new changes(*v->recent);
+
     // look for analysis in inverse dict and remove them.
     if (inverdb != NULL) {    
       list<analysis> la;
       search_form(form,la);
+      vector<const wstring*> fms;
       for (list<analysis>::iterator a=la.begin(); a!=la.end(); a++) {
-        // get list of forms for this analysis
-        wstring fms = inverdb->access_database(a->get_lemma()+L"#"+a->get_tag());
-        list<wstring> lf = util::wstring2list(fms,L" ");
-        // remove form from list
-        lf.remove(form);
-      
-        if (lf.empty()) 
-          // list is empty, remove entry
-          inverdb->remove_database(a->get_lemma()+L"#"+a->get_tag());
-        else
-          // forms remain, store reduced list.  
-          inverdb->replace_database(a->get_lemma()+L"#"+a->get_tag(), util::list2wstring(lf,L" "));
+        // get list of forms for this analysis, without the removed form
+        access_inverse(a->get_lemma(), a->get_tag(), *ch, *v->settled, fms);
+        vector<wstring> lf;
+        for (vector<const wstring*>::const_iterator f=fms.begin(); f!=fms.end(); f++) 
+          if (**f!=form) lf.push_back(**f);
+        // store reduced list (empty if no forms remain)
+        ch->inverse[a->get_lemma()+L"#"+a->get_tag()].swap(lf);
       }
     }
 
     // remove main entry
-    morfodb->remove_database(form);
+    ch->forms[form] = L"";
+
+    publish(v,ch);
+    update_sem.unlock();
   }
 
   /////////////////////////////////////////////////////////////////////////////
@@ -279,14 +473,18 @@ namespace freeling {
 
   void dictionary::add_analysis(const std::wstring &form, const analysis &newan) {
 
+    update_sem.lock();
+    shared_ptr<const version> v = atomic_load(&current);
+    // copy-on-write: changes are made on a private copy of the recent ones
+    changes *ch = new changes(*v->recent);
+
     // see if the form already exists
-    wstring data = morfodb->access_database(form);
+    wstring data = access(form, *ch, *v->settled);
 
     if (data.empty()) { //new form, add it
-      morfodb->add_database(form, newan.get_lemma()+L" "+newan.get_tag());
+      ch->forms[form] = newan.get_lemma()+L" "+newan.get_tag();
       // add pair to inverse dict if required
-      if (inverdb != NULL) 
-        inverdb->add_database(newan.get_lemma()+L"#"+newan.get_tag(), form);
+      if (inverdb != NULL) add_inverse(form, newan, *ch, *v->settled);
     }
 
     else { // known form. Add analysis to existing list.
@@ -323,12 +521,14 @@ namespace freeling {
       // if we added either a new pair, or a new tag to an existing lemma, update database
       if (not l_found or not t_found) {
         // Store modified list of lemmas and tags
-        morfodb->replace_database(form, util::list2wstring(lan,LEMMA_DIVIDER));
+        ch->forms[form] = util::list2wstring(lan,LEMMA_DIVIDER);
         // add pair to inverse dict if required
-        if (inverdb != NULL) 
-          inverdb->add_database(newan.get_lemma()+L"#"+newan.get_tag(), form);
+        if (inverdb != NULL) add_inverse(form, newan, *ch, *v->settled);
       }
     }
+
+    publish(v,ch);
+    update_sem.unlock();
   }
 
 
@@ -339,14 +539,36 @@ namespace freeling {
   list<wstring> dictionary::get_forms(const wstring &lemma, const wstring &tag) const {
     list<wstring> r;
 
-    if (inverdb != NULL) 
-      r = util::wstring2list(inverdb->access_database(lemma+L"#"+tag),L" ");
+    if (inverdb != NULL) {
+      vector<const wstring*> fms;
+      shared_ptr<const void> pin = get_forms(lemma,tag,fms);
+      for (vector<const wstring*>::const_iterator f=fms.begin(); f!=fms.end(); f++) r.push_back(**f);
+    }
     else
       WARNING(L"get_forms called but InverseDictionary was not loaded."); 
 
     return r;
   }
 
+  /////////////////////////////////////////////////////////////////////////////
+  /// Get possible forms for a lemma+pos, without copying them.
+  /// Returns the version of changes the forms were found in, which
+  /// owns any changed form pointed to.
+  /////////////////////////////////////////////////////////////////////////////
+
+  shared_ptr<const void> dictionary::get_forms(const wstring &lemma, const wstring &tag, vector<const wstring*> &fms) const {
+    fms.clear();
+    if (inverdb == NULL) {
+      WARNING(L"get_forms called but InverseDictionary was not loaded."); 
+      return shared_ptr<const void>();
+    }
+
+    shared_ptr<const version> v = get_version();
+    access_inverse(lemma, tag, *v->recent, *v->settled, fms);
+    return v;
+  }
+
+
   ////////////////////////////////////////////////////////////////
   /// Generate valid tag combinations for an ambiguous contraction
   ////////////////////////////////////////////////////////////////
@@ -383,7 +605,8 @@ namespace freeling {
     wstring key = util::lowercase(s);
 
     // search word in the active dictionary  
-    wstring data = morfodb->access_database(key);
+    shared_ptr<const version> v = get_version();
+    wstring data = access(key, *v->recent, *v->settled);
 
     if (not data.empty()) {
       // process the data string into analysis list
@@ -641,12 +864,91 @@ namespace freeling {
     annotate_word(w, lw, op);
   }
 
+  /////////////////////////////////////////////////////////////////////////////
+  ///  Annotate a word with no previous analysis. If the cache is enabled,
+  ///  the result for the same form and options is reused, since it does not
+  ///  depend on the context. Returns true iff the form is a contraction.
+  /////////////////////////////////////////////////////////////////////////////
+
+  bool dictionary::annotate_word_cached(word &w, list<word> &lw, const analyzer_invoke_options &opts) const {
+
+    if (wcache==NULL) return annotate_word(w,lw,opts);
+
+    // only options used by annotate_word are relevant
+    wstring key = w.get_form() + L"#" + wchar_t(L'0' + (opts.MACO_AffixAnalysis ? 1 : 0)
+                                                 + (opts.MACO_CompoundAnalysis ? 2 : 0)
+                                                 + (opts.MACO_RetokContractions ? 4 : 0));
+    cached_annotation ca;
+    unsigned long ep = get_version()->epoch;
+    bool found = wcache->find_safe(key,ca);
+    if (found and ca.epoch==ep) {
+      ++cache_hits;
+      TRACE(3,L"Found in cache: "+w.get_form());
+      w.set_analysis(ca.la);
+      if (ca.locked) w.lock_analysis();
+      w.set_analyzed_by(ca.analyzed_by);
+      lw = ca.components;
+      return ca.contraction;
+    }
+
+    ++cache_misses;
+    // entry computed before a dictionary update, discard it
+    if (found) wcache->erase_safe(key);
+
+    bool locked = w.is_locked_analysis();
+    unsigned by = w.get_analyzed_by();
+    ca.contraction = annotate_word(w,lw,opts);
+    ca.la.assign(w.begin(),w.end());
+    ca.locked = (w.is_locked_analysis() and not locked);
+    ca.analyzed_by = (w.get_analyzed_by() & ~by);
+    ca.components = lw;
+    ca.epoch = ep;
+    wcache->insert_safe(key,ca);
+    return ca.contraction;
+  }
+
+  ////////////////////////////////////////////////////////////////////////
+  /// get number of cache hits and misses so far
+  ////////////////////////////////////////////////////////////////////////
+
+  void dictionary::get_cache_stats(unsigned long &hits, unsigned long &misses) const {
+    hits = cache_hits;
+    misses = cache_misses;
+  }
+
   ////////////////////////////////////////////////////////////////////////
   /// dump dictionary to a buffer. Either full entries or keys only
   ////////////////////////////////////////////////////////////////////////
 
   void dictionary::dump_dictionary(std::wostream &buff, bool keysonly) const {
-    morfodb->dump_database(buff,keysonly);
+    shared_ptr<const version> v = get_version();
+    if (v->epoch==0) {
+      // no changes, dump loaded database
+      morfodb->dump_database(buff,keysonly);
+      return;
+    }
+
+    // dump loaded entries not affected by changes
+    wostringstream sdb;
+    morfodb->dump_database(sdb,keysonly);
+    wistringstream sin(sdb.str());
+    wstring line;
+    while (getline(sin,line)) {
+      wstring key=line.substr(0,line.find(L" "));
+      if (v->recent->forms.find(key)==v->recent->forms.end() and 
+          v->settled->forms.find(key)==v->settled->forms.end())
+        buff << line << endl;
+    }
+
+    // dump changed entries still present
+    set<wstring> done;
+    for (unordered_map<wstring,wstring>::const_iterator p=v->recent->forms.begin(); p!=v->recent->forms.end(); p++) {
+      done.insert(p->first);
+      if (not p->second.empty()) buff << p->first << (keysonly ? L"" : L" "+p->second) << endl;
+    }
+    for (unordered_map<wstring,wstring>::const_iterator p=v->settled->forms.begin(); p!=v->settled->forms.end(); p++) 
+      if (done.find(p->first)==done.end() and not p->second.empty()) 
+        buff << p->first << (keysonly ? L"" : L" "+p->second) << endl;
   }
 
 
@@ -667,7 +969,11 @@ namespace freeling {
         TRACE(1,L"Annotating word: "+pos->get_form());
 
         list<word> lw;
-        if (annotate_word(*pos,lw,opts)) { 
+        // words previously annotated as numbers are not cached, since
+        // the result depends on their existing analysis
+        bool contraction = (pos->get_n_analysis()==0 ? annotate_word_cached(*pos,lw,opts) 
+                                                     : annotate_word(*pos,lw,opts));
+        if (contraction) { 
           // word is a contraction. Create new tokens, fix sentence.
 
           TRACE(2,L"Contraction found, replacing... "+pos->get_form()
@@ -31,6 +31,7 @@
 #include "freeling/morfo/fex.h"
 #include "freeling/morfo/util.h"
 #include "freeling/morfo/traces.h"
+#include "freeling/morfo/status_pool.h"
 
 using namespace std;
 
@@ -157,7 +158,7 @@ namespace freeling {
     }
 
     // starting new sentence, create a new status to store features, and initialize it for each rule.
-    fex_status *st = new fex_status();
+    fex_status *st = status_pool<fex_status>::acquire();
     sent.set_processing_status((processor_status *)st);
     for (list<fex_rulepack>::const_iterator pack=packs.begin(); pack!=packs.end(); pack++)
       for (list<fex_rule>::const_iterator r=pack->rules.begin(); r!=pack->rules.end(); r++) 
@@ -194,12 +194,13 @@ namespace freeling {
         t = ((*s)==literal);
     }
     else if (function==L"matches") {
-      // make sure status contains a vector for regexp matches for this condition
-      if (st->re_result.find(cid)==st->re_result.end())
-        st->re_result.insert(make_pair(cid,vector<wstring>()));
-      // check regexp match, store result
-      for (s=target.begin(); s!=target.end() and not t; s++) 
-        t = match_re.search(*s,st->re_result[cid]);
+      // get (or create) status slot for regexp matches for this condition
+      pair<wstring,vector<freeling::regexp::span> > &res = st->re_result[cid];
+      // check regexp match, store matched string and substring spans
+      for (s=target.begin(); s!=target.end() and not t; s++) {
+        t = match_re.search(*s,res.second);
+        if (t) res.first = *s;
+      }
     }
 
     TRACE(4,L"   -- result is "+wstring(t!=negated? L"true" : L"false"));
@@ -281,7 +282,10 @@ namespace freeling {
     if (function!=L"matches") {
       ERROR_CRASH(L"Wrong use of subexpression in rule with no regex matching.");
     }
-    return st->re_result[cid][i];
+    const pair<wstring,vector<freeling::regexp::span> > &res = st->re_result[cid];
+    const freeling::regexp::span &sp = res.second[i];
+    if (sp.first<0) return L"";  // subexpression did not take part in the match
+    return res.first.substr(sp.first,sp.second);
   }
 
   ////////////////////////////////////////////////////////////////
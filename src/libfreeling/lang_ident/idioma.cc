@@ -135,6 +135,24 @@ namespace freeling {
   
   double idioma::get_threshold() const { return threshold; }
 
+  //////////////////////////////////////////////////////////
+  /// get order of ngram model
+  //////////////////////////////////////////////////////////
+
+  int idioma::get_order() const { return order; }
+
+  //////////////////////////////////////////////////////////
+  /// get phantom char used for initial states
+  //////////////////////////////////////////////////////////
+
+  wchar_t idioma::get_phantom() const { return phantom; }
+
+  //////////////////////////////////////////////////////////
+  /// get ngram model
+  //////////////////////////////////////////////////////////
+
+  const smoothingLD<wstring,wchar_t> &idioma::get_smoothing() const { return *smooth; }
+
   //////////////////////////////////////////////////////////
   /// Compute probabiltiy for given sequence according to 
   /// current model. Parameter "len" gets the actual length 
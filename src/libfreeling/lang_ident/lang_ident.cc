@@ -9,6 +9,8 @@
 
 #include <fstream>
 #include <sstream>
+#include <cmath>
+#include <algorithm>
 #include "freeling/morfo/configfile.h"
 #include "freeling/morfo/lang_ident.h"
 #include "freeling/morfo/util.h"
@@ -25,20 +27,21 @@ namespace freeling {
   /// Empty constructor (e.g. for using in training)
   /////////////////////////////////////////////////////////////////
 
-  lang_ident::lang_ident() {}
+  lang_ident::lang_ident() : stop_minlen(256), stop_margin(50) {}
 
   ///////////////////////////////////////////////////////////////////
   /// constructor, given a config file
   /////////////////////////////////////////////////////////////////
 
-  lang_ident::lang_ident(const wstring &idnFile) {
+  lang_ident::lang_ident(const wstring &idnFile) : stop_minlen(256), stop_margin(50) {
 
     wstring path=idnFile.substr(0,idnFile.find_last_of(L"/\\")+1);
 
     // config file
-    enum sections {LANGUAGES};
+    enum sections {LANGUAGES,EARLYSTOP};
     config_file cfg;  
     cfg.add_section(L"Languages",LANGUAGES);
+    cfg.add_section(L"EarlyStop",EARLYSTOP);
 
     if (not cfg.open(idnFile)) {
       ERROR_CRASH(L"Error opening file "+idnFile);
@@ -56,7 +59,18 @@ namespace freeling {
         wstring file;
         sin>>file; 
         // locate model file relative to main idnFile config file
-        add_language(util::absolute(file,path));
+        load_language(util::absolute(file,path));
+        break;
+      }
+
+      case EARLYSTOP: {
+        wistringstream sin;
+        sin.str(line);
+        wstring name;
+        sin>>name;
+        if (name==L"MinLength") sin>>stop_minlen;
+        else if (name==L"Margin") sin>>stop_margin;
+        else ERROR_CRASH(L"Unexpected EarlyStop option '"+name+L"'");
         break;
       }
 
@@ -65,6 +79,8 @@ namespace freeling {
     }
     cfg.close(); 
 
+    build_scorers();
+
     TRACE(1,L"Module sucessfully loaded");
   }
 
@@ -75,6 +91,8 @@ namespace freeling {
   lang_ident::~lang_ident() {
     for (map<wstring,idioma*>::iterator p=idiomes.begin(); p!=idiomes.end(); p++)
       delete p->second;
+    for (vector<lang_scorer*>::iterator s=scorers.begin(); s!=scorers.end(); s++)
+      delete *s;
   }
 
 
@@ -84,11 +102,51 @@ namespace freeling {
   ///////////////////////////////////////////////////////////////////
 
   void lang_ident::add_language(const wstring &modelFile) {
+    load_language(modelFile);
+    build_scorers();
+  }
+
+  ///////////////////////////////////////////////////////////////////
+  /// load a model for a new language, without updating scorers
+  ///////////////////////////////////////////////////////////////////
+
+  void lang_ident::load_language(const wstring &modelFile) {
     idioma *id = new idioma(modelFile);
     idiomes.insert(make_pair(id->get_language_code(),id));
     all_known_languages.insert(id->get_language_code());
   }
 
+  ///////////////////////////////////////////////////////////////////
+  /// Merge loaded models in combined scorers, grouping languages 
+  /// with the same order and phantom char.
+  ///////////////////////////////////////////////////////////////////
+
+  void lang_ident::build_scorers() {
+    for (vector<lang_scorer*>::iterator s=scorers.begin(); s!=scorers.end(); s++)
+      delete *s;
+    scorers.clear();
+    scorer_index.clear();
+
+    map<pair<int,wchar_t>,vector<const idioma*> > groups;
+    for (map<wstring,idioma*>::const_iterator k=idiomes.begin(); k!=idiomes.end(); k++) 
+      groups[make_pair(k->second->get_order(),k->second->get_phantom())].push_back(k->second);
+
+    for (map<pair<int,wchar_t>,vector<const idioma*> >::const_iterator g=groups.begin(); g!=groups.end(); g++) {
+      for (size_t i=0; i<g->second.size(); i++) 
+        scorer_index.insert(make_pair(g->second[i]->get_language_code(), make_pair(scorers.size(),i)));
+      scorers.push_back(new lang_scorer(g->second));
+    }
+  }
+
+  ///////////////////////////////////////////////////////////////////
+  /// set early stop parameters for identify_language 
+  ///////////////////////////////////////////////////////////////////
+
+  void lang_ident::set_early_stop(size_t minlen, double margin) {
+    stop_minlen = minlen;
+    stop_margin = margin;
+  }
+
   ///////////////////////////////////////////////////////////////////
   /// train a model for a language, store in modelFile, and add 
   /// it to the known languages list.
@@ -113,7 +171,7 @@ namespace freeling {
   wstring lang_ident::identify_language (const wstring &text, const set<wstring>& ls) const {
     /// get probabilities for all languages
     vector<pair<double,wstring> > result;
-    language_perplexities(result, text, ls);
+    language_perplexities(result, text, ls, true);
 
     /// return language above the threshold with best probabiltiy
     wstring best_l = L"none";
@@ -167,27 +225,56 @@ namespace freeling {
   /// given list (empty list--> all languages)
   ////////////////////////////////////////////////////////////////////////
 
-  void lang_ident::language_perplexities (vector<pair<double,wstring> > &result, const wstring &text, const set<wstring>& ls) const {
+  void lang_ident::language_perplexities (vector<pair<double,wstring> > &result, const wstring &text, 
+                                          const set<wstring>& ls, bool early_stop) const {
 
     const set<wstring> *langs = &ls;
   
     if (ls.empty()) langs = &all_known_languages;
 
     result.clear();
-    result.reserve(ls.size());
+    result.reserve(langs->size());
+
+    /// mark candidate languages in each scorer
+    vector<vector<bool> > active(scorers.size());
+    for (size_t s=0; s<scorers.size(); s++) 
+      active[s].assign(scorers[s]->num_languages(), false);
 
-    /// check each candidate language
     set<wstring>::const_iterator li;
+    bool any=false;
     for (li = langs->begin(); li!=langs->end(); li++) {
-      map<wstring,idioma*>::const_iterator k = idiomes.find(*li);
-      if (k==idiomes.end()) {
+      map<wstring,pair<size_t,size_t> >::const_iterator k = scorer_index.find(*li);
+      if (k==scorer_index.end()) {
         WARNING(L"Unknown language "+(*li)+L" given as identification candidate.");
       }
       else {
-        TRACE(3,L"Analyzing sequence for language "+k->first);
-        // compute probability, store result.
-        double prob = k->second->compute_perplexity(text);
-        result.push_back(make_pair(prob,k->first));
+        active[k->second.first][k->second.second] = true;
+        any = true;
+      }
+    }
+    if (not any) return;
+
+    /// score text once for each scorer with some candidate language
+    vector<vector<double> > logprob(scorers.size());
+    vector<size_t> len(scorers.size(),0);
+    for (size_t s=0; s<scorers.size(); s++) {
+      if (find(active[s].begin(), active[s].end(), true) == active[s].end()) continue;
+      TRACE(3,L"Analyzing sequence with scorer "<<s);
+      if (early_stop) 
+        len[s] = scorers[s]->score(text, active[s], logprob[s], stop_minlen, stop_margin);
+      else
+        len[s] = scorers[s]->score(text, active[s], logprob[s]);
+    }
+
+    /// compute perplexity for each candidate language, store result.
+    for (li = langs->begin(); li!=langs->end(); li++) {
+      map<wstring,pair<size_t,size_t> >::const_iterator k = scorer_index.find(*li);
+      if (k!=scorer_index.end()) {
+        size_t s = k->second.first;
+        double prob = logprob[s][k->second.second];
+        TRACE(4,L"   Sequence log probability for "+k->first+L"="+util::double2wstring(prob)+L"  len="+util::double2wstring(len[s]));
+        double perp = exp(-prob/len[s]);
+        result.push_back(make_pair(perp,k->first));
       }    
     }
   }
@@ -0,0 +1,332 @@
+//////////////////////////////////////////////////////////////////
+//
+//    Copyright (C) 2014   TALP Research Center
+//                         Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU Affero General Public License
+//    (GNU AGPL) as published by the Free Software Foundation; either
+//    version 3 of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+//    Affero General Public License for more details.
+//
+//    You should have received a copy of the GNU Affero General Public License 
+//    along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: Muntsa Padro (mpadro@lsi.upc.edu)
+//             TALP Research Center
+//             despatx Omega.S107 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+////////////////////////////////////////////////////////////////
+
+// /////////////////////// Class lang_scorer /////////////////////
+//
+//  Class that merges the ngram models of several languages and
+//  scores a text against all of them in a single pass.
+//
+// ////////////////////////////////////////////////////////////////
+
+#include <cwctype>
+#include <algorithm>
+
+#include "freeling/morfo/lang_scorer.h"
+#include "freeling/morfo/util.h"
+#include "freeling/morfo/traces.h"
+
+using namespace std;
+
+namespace freeling {
+
+#define MOD_TRACENAME L"LANG_SCORER"
+#define MOD_TRACECODE LANGIDENT_TRACE
+
+  /// base for polynomial ngram hashing. Hashes are computed left to right, 
+  /// so extending a ngram with one char is  h*HASH_BASE+c
+#define HASH_BASE 0x100000001b3ULL
+  /// multiplier to spread hash values over table slots
+#define HASH_MIX 0x9E3779B97F4A7C15ULL
+
+  ///////////////////////////////////////////////////////////////////
+  /// Constructor: merge ngram counts for all given languages in a
+  /// single table.
+  ///////////////////////////////////////////////////////////////////
+
+  lang_scorer::lang_scorer(const vector<const idioma*> &langs) {
+
+    order = langs.front()->get_order();
+    phantom = langs.front()->get_phantom();
+
+    // initial table size, grown as needed
+    rehash(1024);
+
+    // collect (entry, (language,logcount)) for all ngrams in all models
+    vector<pair<unsigned int,pair<unsigned int,double> > > obs;
+    for (unsigned int l=0; l<langs.size(); l++) {
+      if (langs[l]->get_order()!=(int)order or langs[l]->get_phantom()!=phantom)
+        ERROR_CRASH(L"Language models merged in a scorer must have the same order and phantom char");
+
+      const smoothingLD<wstring,wchar_t> &sm = langs[l]->get_smoothing();
+      alpha.push_back(sm.get_alpha());
+      notalpha.push_back(sm.get_notalpha());
+      unseen.push_back(sm.get_unseen());
+      nobs.push_back(sm.get_nobs());
+
+      const map<wstring,double> &counts = sm.get_counts();
+      for (map<wstring,double>::const_iterator c=counts.begin(); c!=counts.end(); c++) {
+        unsigned long long h = hash(c->first);
+        size_t p = probe(h, c->first.data(), c->first.size());
+        if (slots[p]<0) {
+          // new ngram, create entry
+          ngram_entry e;
+          e.hash = h;
+          e.key = keys.size();
+          e.keylen = c->first.size();
+          e.first = 0;
+          e.nscores = 0;
+          keys.insert(keys.end(), c->first.begin(), c->first.end());
+          slots[p] = entries.size();
+          entries.push_back(e);
+          // keep load factor under 1/2
+          if (entries.size()*2 > slots.size()) rehash(slots.size()*2);
+          p = probe(h, c->first.data(), c->first.size());
+        }
+        entries[slots[p]].nscores++;
+        obs.push_back(make_pair(slots[p], make_pair(l, c->second)));
+      }
+    }
+
+    // lay out scores contiguously for each entry. Languages were visited
+    // in order, so each entry gets its scores sorted by language.
+    unsigned int pos = 0;
+    for (vector<ngram_entry>::iterator e=entries.begin(); e!=entries.end(); e++) {
+      e->first = pos;
+      pos += e->nscores;
+      e->nscores = 0;
+    }
+    scores.resize(pos);
+    for (vector<pair<unsigned int,pair<unsigned int,double> > >::const_iterator o=obs.begin(); o!=obs.end(); o++) {
+      ngram_entry &e = entries[o->first];
+      scores[e.first + e.nscores] = o->second;
+      e.nscores++;
+    }
+
+    TRACE(3,L"Merged "<<langs.size()<<L" language models into "<<entries.size()<<L" ngrams");
+  }
+
+  ///////////////////////////////////////////////////////////////////
+  /// destructor
+  ///////////////////////////////////////////////////////////////////
+
+  lang_scorer::~lang_scorer() {}
+
+  ///////////////////////////////////////////////////////////////////
+  /// order of the ngram models
+  ///////////////////////////////////////////////////////////////////
+
+  size_t lang_scorer::get_order() const { return order; }
+
+  ///////////////////////////////////////////////////////////////////
+  /// phantom char of the ngram models
+  ///////////////////////////////////////////////////////////////////
+
+  wchar_t lang_scorer::get_phantom() const { return phantom; }
+
+  ///////////////////////////////////////////////////////////////////
+  /// number of merged languages
+  ///////////////////////////////////////////////////////////////////
+
+  size_t lang_scorer::num_languages() const { return alpha.size(); }
+
+  ///////////////////////////////////////////////////////////////////
+  /// hash of given string
+  ///////////////////////////////////////////////////////////////////
+
+  unsigned long long lang_scorer::hash(const wstring &s) {
+    unsigned long long h = 0;
+    for (wstring::const_iterator c=s.begin(); c!=s.end(); c++)
+      h = h*HASH_BASE + (unsigned long long)(*c);
+    return h;
+  }
+
+  ///////////////////////////////////////////////////////////////////
+  /// (re)build slots index with n slots (n must be a power of 2)
+  ///////////////////////////////////////////////////////////////////
+
+  void lang_scorer::rehash(size_t n) {
+    slots.assign(n,-1);
+    shift = 64;
+    while (n>1) { shift--; n >>= 1; }
+
+    for (size_t e=0; e<entries.size(); e++) 
+      slots[probe(entries[e].hash, &keys[entries[e].key], entries[e].keylen)] = e;
+  }
+
+  ///////////////////////////////////////////////////////////////////
+  /// slot holding the entry with given hash and chars, or the empty 
+  /// slot where it should be inserted.
+  ///////////////////////////////////////////////////////////////////
+
+  size_t lang_scorer::probe(unsigned long long h, const wchar_t *s, size_t len) const {
+    size_t mask = slots.size()-1;
+    size_t p = (h*HASH_MIX) >> shift;
+    while (slots[p]>=0) {
+      const ngram_entry &e = entries[slots[p]];
+      if (e.hash==h and e.keylen==len and equal(s, s+len, keys.begin()+e.key)) 
+        return p;
+      p = (p+1) & mask;
+    }
+    return p;
+  }
+
+  ///////////////////////////////////////////////////////////////////
+  /// locate entry with given hash and chars, -1 if not found
+  ///////////////////////////////////////////////////////////////////
+
+  int lang_scorer::find(unsigned long long h, const wchar_t *s, size_t len) const {
+    return slots[probe(h,s,len)];
+  }
+
+  ///////////////////////////////////////////////////////////////////
+  /// log count of given ngram entry for given language, -1 if not seen
+  ///////////////////////////////////////////////////////////////////
+
+  double lang_scorer::count(int e, unsigned int lang) const {
+    if (e<0) return -1;
+    const ngram_entry &en = entries[e];
+    for (unsigned int i=en.first; i<en.first+en.nscores; i++) 
+      if (scores[i].first==lang) return scores[i].second;
+    return -1;
+  }
+
+  ///////////////////////////////////////////////////////////////////
+  /// Compute log probability of given text for each active language.
+  /// The text is traversed as idioma::sequence_probability does
+  /// (same initial states, whitespace folding and lowercasing), and 
+  /// each transition is scored with LD smoothing for all languages.
+  ///////////////////////////////////////////////////////////////////
+
+  size_t lang_scorer::score(const wstring &text, const vector<bool> &active,
+                            vector<double> &logprob, size_t minlen, double margin) const {
+
+    size_t nlang = alpha.size();
+    logprob.assign(nlang, 0);
+    size_t nactive = 0;
+    for (size_t l=0; l<nlang; l++) if (active[l]) nactive++;
+    if (nactive==0) return 0;
+
+    // history length
+    size_t hl = order-1;
+    // current window: history plus next symbol
+    vector<wchar_t> win(order, phantom);
+    // hashes of history suffixes of length 0..hl, and of window suffixes of length 1..order
+    vector<unsigned long long> sufh(order,0), seqh(order,0);
+    // hashes of initial history suffixes (all phantoms)
+    vector<unsigned long long> inith(order,0);
+    for (size_t k=1; k<order; k++) inith[k] = inith[k-1]*HASH_BASE + phantom;
+    // position where each language was last scored
+    vector<size_t> done(nlang,0);
+
+    size_t i=0, n=text.size();
+    bool eof=false;
+    wchar_t z=0;
+    size_t len=0;
+    bool reset=true;
+
+    while (true) {
+      if (reset) {
+        // initial state: hl phantom chars plus the first non-blank char
+        fill(win.begin(), win.begin()+hl, phantom);
+        sufh = inith;
+        if (not eof) {
+          if (i<n) z=text[i++]; else eof=true;
+          while (not eof and (z==L' ' or z==L'\t' or z==L'\n')) {
+            if (i<n) z=text[i++]; else eof=true;
+          }
+          z = towlower(z);
+        }
+        reset = false;
+      }
+      if (eof) break;
+
+      win[hl] = z;
+      for (size_t k=0; k<order; k++) seqh[k] = sufh[k]*HASH_BASE + z;
+
+      // back off from longest ngram until all languages have a score for z
+      size_t stamp = len+1;
+      size_t nres = 0;
+      for (int k=hl; k>=0 and nres<nactive; k--) {
+        int e = find(seqh[k], &win[hl-k], k+1);
+        if (e<0) continue;
+
+        int he = -2;  // history entry, looked up only if needed
+        const ngram_entry &en = entries[e];
+        for (unsigned int s=en.first; s<en.first+en.nscores; s++) {
+          unsigned int l = scores[s].first;
+          if (not active[l] or done[l]==stamp) continue;
+
+          double ch;
+          if (k==0) ch = nobs[l];
+          else {
+            if (he==-2) he = find(sufh[k], &win[hl-k], k);
+            ch = count(he,l);
+          }
+          double p = notalpha[l] + scores[s].second - ch;
+          for (size_t b=k; b<hl; b++) p = alpha[l] + p;
+          logprob[l] += p;
+          done[l] = stamp;
+          nres++;
+        }
+      }
+      // languages that never saw z
+      if (nres<nactive) {
+        for (size_t l=0; l<nlang; l++) {
+          if (not active[l] or done[l]==stamp) continue;
+          double p = alpha[l] + unseen[l];
+          for (size_t b=0; b<hl; b++) p = alpha[l] + p;
+          logprob[l] += p;
+        }
+      }
+      len++;
+
+      // stop if the best language is already far enough from the rest
+      if (margin>0 and len>=minlen and len%64==0 and nactive>1) {
+        double best=0, second=0;
+        bool first=true, found=false;
+        for (size_t l=0; l<nlang; l++) {
+          if (not active[l]) continue;
+          if (first or logprob[l]>best) { second=best; found=not first; best=logprob[l]; first=false; }
+          else if (not found or logprob[l]>second) { second=logprob[l]; found=true; }
+        }
+        if (best-second >= margin) {
+          TRACE(3,L"Early stop after "<<len<<L" transitions, margin="<<best-second);
+          break;
+        }
+      }
+
+      if (z==L'\n') 
+        // end of paragraph, reset to initial state
+        reset = true;
+      else {
+        // shift window one position
+        for (size_t k=1; k<order; k++) sufh[k] = seqh[k-1];
+        for (size_t k=0; k<hl; k++) win[k] = win[k+1];
+        if (i<n) z=text[i++]; else eof=true;
+        // skip redundant whitespaces
+        if (hl>0 and (win[hl-1]==L' ' or win[hl-1]==L'\t')) {
+          while (not eof and (z==L' ' or z==L'\t')) {
+            if (i<n) z=text[i++]; else eof=true;
+          }
+        }
+        z = towlower(z);
+      }
+    }
+
+    return len;
+  }
+
+} // namespace
@@ -165,6 +165,8 @@ namespace freeling {
   float alternative::get_probability() const {return probability;}
   /// Whether the alternative is selected in the kbest path or not
   bool alternative::is_selected(int k) const {return (kbest.count(k) == 1);}
+  /// Get the largest kbest sequence index the alternative is selected in
+  int alternative::max_kbest() const {return (kbest.empty() ? 0 : *kbest.rbegin());}
   /// Clear the kbest selections
   void alternative::clear_selections() {kbest.clear();}
   /// Add a kbest selection
@@ -615,6 +617,48 @@ namespace freeling {
   parse_tree::parse_tree() : tree<node>() {}
   parse_tree::parse_tree(parse_tree::const_iterator p) : tree<node>(p) {}
   parse_tree::parse_tree(const node & n) : tree<node>(n) {}
+  /// copy, indexes must point to the new nodes
+  parse_tree::parse_tree(const parse_tree &t) : tree<node>(t) { rebuild_node_index(); }
+  /// move, nodes are relinked and indexes taken over
+  parse_tree::parse_tree(parse_tree &&t) : tree<node>(std::move(t)) { take_index(t); }
+  /// assignment
+  parse_tree& parse_tree::operator=(const parse_tree &t) {
+    if (this!=&t) {
+      tree<node>::operator=(t);
+      rebuild_node_index();
+    }
+    return *this;
+  }
+  /// move assignment
+  parse_tree& parse_tree::operator=(parse_tree &&t) {
+    if (this!=&t) {
+      tree<node>::operator=(std::move(t));
+      take_index(t);
+    }
+    return *this;
+  }
+  /// take over indexes from a tree whose nodes were moved to this one
+  void parse_tree::take_index(parse_tree &t) {
+    // nodes were copied (see tree<T>::adopt), rebuild indexes.
+    if (not t.empty()) {
+      rebuild_node_index();
+      return;
+    }
+
+    node_index.swap(t.node_index);
+    word_index.swap(t.word_index);
+    t.node_index.clear();
+    t.word_index.clear();
+    if (this->empty()) return;
+
+    // all nodes but the root keep their address, fix root entries
+    parse_tree::iterator old(&t), root=this->begin();
+    unordered_map<wstring,parse_tree::iterator>::iterator p = node_index.find(root->get_node_id());
+    if (p!=node_index.end() and p->second==old) p->second=root;
+    for (size_t i=0; i<word_index.size(); i++)
+      if (word_index[i]==old) word_index[i]=root;
+  }
+
   /// assign id's to nodes and build index
   void parse_tree::build_node_index(const wstring &sid) {
     parse_tree::iterator k;
@@ -630,6 +674,8 @@ namespace freeling {
   void parse_tree::rebuild_node_index() {
     node_index.clear();
     word_index.clear();
+    // an empty tree has no valid root node to visit
+    if (this->empty()) return;
     for (parse_tree::iterator k=this->begin(); k!=this->end(); ++k) {
       wstring id=k->get_node_id();
       if (id != L"-") node_index.insert(make_pair(id,k));
@@ -639,14 +685,14 @@ namespace freeling {
 
   /// get node with given index, normal iterator
   parse_tree::iterator parse_tree::get_node_by_id(const wstring & id) { 
-    map<wstring,parse_tree::iterator>::iterator p = node_index.find(id); 
+    unordered_map<wstring,parse_tree::iterator>::iterator p = node_index.find(id); 
     if (p!=node_index.end()) return p->second; 
     else return parse_tree::iterator(this->end());
   }
 
   /// get node with given index, const iterator
   parse_tree::const_iterator parse_tree::get_node_by_id(const wstring & id) const { 
-    map<wstring,parse_tree::iterator>::const_iterator p = node_index.find(id); 
+    unordered_map<wstring,parse_tree::iterator>::const_iterator p = node_index.find(id); 
     if (p!=node_index.end()) return p->second; 
     else return parse_tree::const_iterator(this->end());
   }
@@ -859,6 +905,43 @@ namespace freeling {
   /// Constructors for dep_tree
   dep_tree::dep_tree() : tree<depnode>() {}
   dep_tree::dep_tree(const depnode & n) : tree<depnode>(n) {}
+  /// copy, index must point to the new nodes
+  dep_tree::dep_tree(const dep_tree &t) : tree<depnode>(t) { rebuild_node_index(); }
+  /// move, nodes are relinked and index taken over
+  dep_tree::dep_tree(dep_tree &&t) : tree<depnode>(std::move(t)) { take_index(t); }
+  /// assignment
+  dep_tree& dep_tree::operator=(const dep_tree &t) {
+    if (this!=&t) {
+      tree<depnode>::operator=(t);
+      rebuild_node_index();
+    }
+    return *this;
+  }
+  /// move assignment
+  dep_tree& dep_tree::operator=(dep_tree &&t) {
+    if (this!=&t) {
+      tree<depnode>::operator=(std::move(t));
+      take_index(t);
+    }
+    return *this;
+  }
+  /// take over index from a tree whose nodes were moved to this one
+  void dep_tree::take_index(dep_tree &t) {
+    // nodes were copied (see tree<T>::adopt), rebuild index.
+    if (not t.empty()) {
+      rebuild_node_index();
+      return;
+    }
+
+    word_index.swap(t.word_index);
+    t.word_index.clear();
+    if (this->empty()) return;
+
+    // all nodes but the root keep their address, fix root entry
+    dep_tree::iterator old(&t), root=this->begin();
+    for (size_t i=0; i<word_index.size(); i++)
+      if (word_index[i]==old) word_index[i]=root;
+  }
 
   /// get depnode corresponding to word in given position, const iterator
   dep_tree::const_iterator dep_tree::get_node_by_pos(size_t pos) const { return word_index[pos]; }
@@ -884,6 +967,7 @@ namespace freeling {
   /// rebuild index maintaining word positions
   void dep_tree::rebuild_node_index() {
     word_index.clear();
+    if (this->empty()) return;
     for (dep_tree::iterator d=this->begin(); d!=this->end(); ++d) {
       if (d->has_word()) { 
         size_t pos=d->get_word().get_position();
@@ -949,6 +1033,7 @@ namespace freeling {
   ////////////////////////////////////////////////////////////////
 
   processor_status::processor_status() {}
+  void processor_status::release() { delete this; }
 
   ////////////////////////////////////////////////////////////////
   ///   Class argument stores information about a predicate argument
@@ -1140,7 +1225,8 @@ namespace freeling {
     best_seq = s.best_seq;
     // copy word list
     wpos = vector<word*>(s.size(),(word*)NULL);
-    map<const word*,word*> wps;
+    unordered_map<const word*,word*> wps;
+    wps.reserve(s.size());
     this->list<word>::clear(); 
     int i=0;
     for (sentence::const_iterator w=s.begin(); w!=s.end(); w++) {
@@ -1161,7 +1247,7 @@ namespace freeling {
           j++;
         }
       }
-      k->second.rebuild_node_index();
+      // (node indexes were already rebuilt by the copy)
     }
 
     // copy dependency trees, and fix links to parse_tree and words.
@@ -1231,7 +1317,12 @@ namespace freeling {
 
   /// Set the parse tree.
   void sentence::set_parse_tree(const parse_tree &tr, int k) {
+    // the copy rebuilds its own indexes
     pts[k]=tr;
+  }
+  /// Set the parse tree, taking over its nodes
+  void sentence::set_parse_tree(parse_tree &&tr, int k) {
+    pts[k]=std::move(tr);
     pts[k].rebuild_node_index();
   }
   /// Obtain the parse tree.
@@ -1245,9 +1336,16 @@ namespace freeling {
   }
   /// Find out whether the sentence is parsed.
   bool sentence::is_parsed() const {return not pts.empty();}
+  /// Find out whether there is a parse tree for k-th best sequence.
+  bool sentence::has_parse_tree(int k) const {return pts.find(k)!=pts.end();}
   /// Set the dependency tree.
   void sentence::set_dep_tree(const dep_tree &tr, int k) {
+    // the copy rebuilds its own index
     dts[k]=tr;
+  }
+  /// Set the dependency tree, taking over its nodes
+  void sentence::set_dep_tree(dep_tree &&tr, int k) {
+    dts[k]=std::move(tr);
     dts[k].rebuild_node_index();
   }
   /// Obtain the parse dependency tree
@@ -1261,6 +1359,8 @@ namespace freeling {
   }
   /// Find out whether the sentence is dependency parsed.
   bool sentence::is_dep_parsed() const {return not dts.empty();}
+  /// Find out whether there is a dependency tree for k-th best sequence.
+  bool sentence::has_dep_tree(int k) const {return dts.find(k)!=dts.end();}
   /// obtain list of words (useful for perl APIs)
   vector<word> sentence::get_words() const {
     vector<word> v;
@@ -1277,7 +1377,7 @@ namespace freeling {
     if (status.empty()) return; 
     processor_status *s=status.back(); 
     status.pop_back(); 
-    delete s;
+    s->release();
   }
 
   /// obtain iterators (useful for perl/java APIs)
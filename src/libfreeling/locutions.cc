@@ -73,6 +73,10 @@ namespace freeling {
     Tags = NULL;
     OnlySelected = false;
 
+    // create trie root
+    trie.push_back(mw_node());
+    trie[0].complete = false;
+
     if (not locFile.empty()) { // if no file given, wait for later manual locution loading
 
       enum sections {TAGSET, MULTIWORDS, ONLYSELECTED};
@@ -154,8 +158,7 @@ namespace freeling {
 
   void locutions::add_locution(const std::wstring &line) {
 
-    wstring prefix, key, lemma, tag;
-    wstring::size_type p;   
+    wstring key, lemma, tag;
 
     wistringstream sin;
     sin.str(line);
@@ -176,20 +179,45 @@ namespace freeling {
     if (t[0].empty()) t[0]=L"I";
     data += L"|"+t[0];
   
-    // store multiword in multiwords map
-    locut.insert(make_pair(key,data));
-  
-    // store all its prefixes (xxx_, xxx_yyy_, xxx_yyy_zzz_, ...) in prefixes map 
-    prefix=L"";
-    p = key.find_first_of(L"_");
-    while (p!=wstring::npos) {
-    
-      prefix += key.substr(0,p+1);                                 
-      prefixes.insert(prefix);  
-    
-      key = key.substr(p+1);
-      p = key.find_first_of(L"_");
-    }  
+    // walk the trie through multiword components (xxx, yyy, zzz...),
+    // creating nodes for prefixes not seen yet.
+    int n=0;
+    wstring::size_type b=0;
+    while (b!=wstring::npos) {
+      wstring::size_type p = key.find(L'_',b);
+      wstring comp = key.substr(b, p==wstring::npos ? wstring::npos : p-b);
+      b = (p==wstring::npos ? p : p+1);
+
+      // intern component
+      unordered_map<wstring,int>::const_iterator sy = symbols.find(comp);
+      int sym;
+      if (sy!=symbols.end()) sym = sy->second;
+      else {
+        sym = symbols.size();
+        symbols.insert(make_pair(comp,sym));
+        if (comp.size()>=2 and comp[0]==L'<' and comp[comp.size()-1]==L'>') 
+          lemma_symbols.insert(make_pair(comp.substr(1,comp.size()-2),sym));
+      }
+
+      // follow or create transition
+      unsigned long long tr = ((unsigned long long)n<<32) | (unsigned int)sym;
+      unordered_map<unsigned long long,int>::const_iterator nx = transitions.find(tr);
+      if (nx!=transitions.end()) n = nx->second;
+      else {
+        mw_node nd;
+        nd.key = (n==0 ? comp : trie[n].key+L"_"+comp);
+        nd.complete = false;
+        trie.push_back(nd);
+        transitions.insert(make_pair(tr,(int)trie.size()-1));
+        n = trie.size()-1;
+      }
+    }
+
+    // store multiword data in final node (first entry wins)
+    if (not trie[n].complete) {
+      trie[n].complete = true;
+      trie[n].data = data;
+    }
   }
 
 
@@ -209,17 +237,63 @@ namespace freeling {
   ///  Auxiliar for ComputeToken
   ///////////////////////////////////////////////////////////////
 
-  bool locutions::check(const wstring &s, set<wstring> &acc, bool &mw, bool &pref, locutions_status *st) const {  
-    if (locut.find(s)!=locut.end()) {
-      acc.insert(s); 
+  int locutions::next_node_symbol(int n, int sym) const {
+    unordered_map<unsigned long long,int>::const_iterator nx = transitions.find(((unsigned long long)n<<32) | (unsigned int)sym);
+    return (nx==transitions.end() ? -1 : nx->second);
+  }
+
+  ///////////////////////////////////////////////////////////////
+  ///  Auxiliar for ComputeToken: find trie node reached from
+  ///  node n with given component. Returns -1 if none.
+  ///  Components containing '_' (e.g. multiwords built by previous 
+  ///  modules) span several transitions.
+  ///////////////////////////////////////////////////////////////
+
+  int locutions::next_node(int n, const wstring &comp) const {
+    if (comp.find(L'_')==wstring::npos) {
+      unordered_map<wstring,int>::const_iterator sy = symbols.find(comp);
+      return (sy==symbols.end() ? -1 : next_node_symbol(n,sy->second));
+    }
+
+    wstring::size_type b=0;
+    while (b!=wstring::npos and n>=0) {
+      wstring::size_type p = comp.find(L'_',b);
+      n = next_node(n, comp.substr(b, p==wstring::npos ? wstring::npos : p-b));
+      b = (p==wstring::npos ? p : p+1);
+    }
+    return n;
+  }
+
+  ///////////////////////////////////////////////////////////////
+  ///  Auxiliar for ComputeToken: find trie node reached from
+  ///  node n with lemma component <lemma>. Returns -1 if none.
+  ///////////////////////////////////////////////////////////////
+
+  int locutions::next_node_lemma(int n, const wstring &lemma) const {
+    if (lemma.find(L'_')!=wstring::npos) 
+      return next_node(n, L"<"+lemma+L">");
+
+    unordered_map<wstring,int>::const_iterator sy = lemma_symbols.find(lemma);
+    return (sy==lemma_symbols.end() ? -1 : next_node_symbol(n,sy->second));
+  }
+
+  ///////////////////////////////////////////////////////////////
+  ///  Auxiliar for ComputeToken: add reached node to accumulator
+  ///////////////////////////////////////////////////////////////
+
+  bool locutions::check(int n, set<int> &acc, bool &mw, bool &pref, locutions_status *st) const {  
+    if (n<0) return (mw or pref);
+
+    acc.insert(n); 
+    if (trie[n].complete) {
       st->longest_mw=acc;
       st->over_longest=0;
-      TRACE(3,L"  Added MW: "+s);
+      TRACE(3,L"  Added MW: "+trie[n].key);
       mw=true;
     }
-    else if (prefixes.find(s+L"_")!=prefixes.end()) {
-      acc.insert(s); 
-      TRACE(3,L"  Added PRF: "+s);
+    else {
+      // non-complete nodes are always a prefix of some multiword
+      TRACE(3,L"  Added PRF: "+trie[n].key);
       pref=true;
     }
     return (mw or pref);
@@ -237,29 +311,27 @@ namespace freeling {
     // store component
     st->components.push_back(j);
 
-    wstring form, lem, tag;
-    form = j->get_lc_form();
+    wstring tag;
+    const wstring &form = j->get_lc_form();
   
     int token = TK_other;
 
     // look for first analysis matching some locution or prefix
-    set<wstring> acc;
+    set<int> acc;
     bool mw=false; bool pref=false;
 
-    wstring wcard=L"*";
+    // start from trie root if nothing accumulated yet
+    set<int> from = st->acc_mw;
+    if (from.empty()) from.insert(0);
+
+    const wstring wcard=L"*";
     if (j->size() == 0) {
       // if no analysis, check only the form
       TRACE(3,L"checking ("+form+L")");
-      if (st->acc_mw.empty()) {
-        check(form,acc,mw,pref,st); 
-        check(wcard,acc,mw,pref,st); 
-      }
-      else {
-        for (set<wstring>::const_iterator i=st->acc_mw.begin(); i!=st->acc_mw.end(); i++) {
-          TRACE(3,L"   acc_mw: ["+(*i)+L"]");
-          check((*i)+L"_"+form,acc,mw,pref,st); 
-          check((*i)+L"_"+wcard,acc,mw,pref,st); 
-        }
+      for (set<int>::const_iterator i=from.begin(); i!=from.end(); i++) {
+        TRACE(3,L"   acc_mw: ["+trie[*i].key+L"]");
+        check(next_node(*i,form),acc,mw,pref,st); 
+        check(next_node(*i,wcard),acc,mw,pref,st); 
       }
     }
     else { 
@@ -274,35 +346,22 @@ namespace freeling {
       }
       for (word::iterator a=first; a!=last; a++) {
         bool bm=false,bp=false;
-        lem = L"<"+a->get_lemma()+L">";
         tag = a->get_tag();
 	
         if (Tags!=NULL) tag=Tags->get_short_tag(tag);
-        TRACE(3,L"checking ("+form+L","+lem+L","+tag+L")");
+        TRACE(3,L"checking ("+form+L",<"+a->get_lemma()+L">,"+tag+L")");
       
-        if (st->acc_mw.empty()) {
-          check(form,acc,bm,bp,st); 
-          check(lem,acc,bm,bp,st);  
-          check(wcard,acc,bm,bp,st);  
-          if (check(tag,acc,bm,bp,st)) {
+        for (set<int>::const_iterator i=from.begin(); i!=from.end(); i++) {
+          TRACE(3,L"   acc_mw: ["+trie[*i].key+L"]");
+          check(next_node(*i,form),acc,bm,bp,st); 
+          check(next_node_lemma(*i,a->get_lemma()),acc,bm,bp,st);  
+          check(next_node(*i,wcard),acc,bm,bp,st);  
+          if (check(next_node(*i,tag),acc,bm,bp,st))  {
             j->unselect_all_analysis(); 
             a->mark_selected(); 
           }
           mw=mw||bm; pref=pref||bp; 
         }
-        else {
-          for (set<wstring>::const_iterator i=st->acc_mw.begin(); i!=st->acc_mw.end(); i++) {
-            TRACE(3,L"   acc_mw: ["+(*i)+L"]");
-            check((*i)+L"_"+form,acc,bm,bp,st); 
-            check((*i)+L"_"+lem,acc,bm,bp,st);  
-            check((*i)+L"_"+wcard,acc,bm,bp,st);  
-            if (check((*i)+L"_"+tag,acc,bm,bp,st))  {
-              j->unselect_all_analysis(); 
-              a->mark_selected(); 
-            }
-            mw=mw||bm; pref=pref||bp; 
-          }
-        }
       }
     }
 
@@ -314,7 +373,7 @@ namespace freeling {
     st->over_longest++;
     st->acc_mw = acc;
 
-    TRACE(3,L"Encoded word: ["+form+L","+lem+L","+tag+L"] token="+util::int2wstring(token));
+    TRACE(3,L"Encoded word: ["+form+L","+tag+L"] token="+util::int2wstring(token));
     return (token);
   }
 
@@ -341,8 +400,8 @@ namespace freeling {
 
 #ifdef VERBOSE
     TRACE(3,L"State actions completed. LMWs are:");
-    for (set<wstring>::iterator m=st->longest_mw.begin(); m!=st->longest_mw.end(); m++)
-      TRACE(3,L"                                "+*m);
+    for (set<int>::iterator m=st->longest_mw.begin(); m!=st->longest_mw.end(); m++)
+      TRACE(3,L"                                "+trie[*m].key);
 #endif
 
   }
@@ -355,7 +414,6 @@ namespace freeling {
   bool locutions::ValidMultiWord(const word & w, locutions_status *st) const {
 
     wstring lemma,tag,check,par;
-    map<wstring,wstring>::const_iterator mw_data;
     unsigned int nc;
     list<analysis> la;
     bool valid=false;
@@ -367,21 +425,26 @@ namespace freeling {
   
     TRACE(3,L" longest_mw #candidates: ("+util::int2wstring(st->longest_mw.size())+L")");
 
+    // sort candidates by key, so analysis are always added in the same order
+    map<wstring,int> cands;
+    for (set<int>::iterator m=st->longest_mw.begin(); m!=st->longest_mw.end(); m++ ) 
+      cands.insert(make_pair(trie[*m].key,*m));
+
     // consider all possible matching MWs
-    for (set<wstring>::iterator m=st->longest_mw.begin(); m!=st->longest_mw.end(); m++ ) {
+    for (map<wstring,int>::iterator m=cands.begin(); m!=cands.end(); m++ ) {
 
-      wstring form=*m;
+      const wstring &form = m->first;
+      const mw_node &mw_data = trie[m->second];
 
-      if (locut.find(form)!=locut.end()) {  // only bother if it's a real MW, not a prefix.
+      if (mw_data.complete) {  // only bother if it's a real MW, not a prefix.
     
         TRACE(3,L" matched locution: ("+form+L")");
       
         // MW matched, recover its tags and add them to the list.
-        mw_data=locut.find(form);
-        wstring::size_type p= mw_data->second.find(L"|");
-        wstring tags=mw_data->second.substr(0,p);
+        wstring::size_type p= mw_data.data.find(L"|");
+        wstring tags=mw_data.data.substr(0,p);
         list<wstring> ldata = util::wstring2list(tags,L"#");
-        wstring amb=mw_data->second.substr(p+1);
+        wstring amb=mw_data.data.substr(p+1);
         ambiguous = ambiguous or (amb==L"A");
 
         TRACE(4,L"   found entry  ("+tags+L")");
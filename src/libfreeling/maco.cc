@@ -166,6 +166,15 @@ namespace freeling {
     else current_invoke_options.MACO_CompoundAnalysis = comp;
   }
 
+  ///////////////////////////////////////////////////////////////
+  ///  get hits and misses of the dictionary annotation cache
+  ///////////////////////////////////////////////////////////////  
+
+  void maco::get_word_cache_stats(unsigned long &hits, unsigned long &misses) const {
+    hits = 0; misses = 0;
+    if (dico!=NULL) dico->get_cache_stats(hits,misses);
+  }
+
   ///////////////////////////////////////////////////////////////
   ///  Apply cascade of analyzers to given sentence, according to given options
   ///////////////////////////////////////////////////////////////  
@@ -0,0 +1,343 @@
+//////////////////////////////////////////////////////////////////
+//
+//    FreeLing - Open Source Language Analyzers
+//
+//    Copyright (C) 2014   TALP Research Center
+//                         Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU Affero General Public
+//    License as published by the Free Software Foundation; either
+//    version 3 of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Affero General Public License for more details.
+//
+//    You should have received a copy of the GNU Affero General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: Lluis Padro (padro@lsi.upc.es)
+//             TALP Research Center
+//             despatx C6.212 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+////////////////////////////////////////////////////////////////
+
+#include <map>
+#include <vector>
+#include <unordered_map>
+#include <sstream>
+#include <cstdlib>
+#include <cmath>
+
+#define BOOST_SYSTEM_NO_DEPRECATED
+#include <boost/thread/mutex.hpp>
+
+#ifdef __GNUG__
+#include <cxxabi.h>
+#endif
+
+#include "freeling/morfo/metrics.h"
+#include "freeling/morfo/util.h"
+
+using namespace std;
+
+namespace freeling {
+
+  atomic<bool> metrics::enabled(false);
+
+  namespace {
+
+    typedef unsigned long long counter;
+
+    /// Latency histogram buckets: exact up to 7us, then 8 buckets
+    /// per power of two (relative error under 12.5%)
+    const int SUB_BITS = 3;
+    const int SUB_COUNT = 1<<SUB_BITS;
+    const int NBUCKETS = SUB_COUNT*(64-SUB_BITS+1);
+
+    int bucket_of(counter v) {
+      if (v < (counter)SUB_COUNT) return v;
+      int e = 0;
+      for (counter x=v; x>1; x>>=1) e++;
+      int sub = (v >> (e-SUB_BITS)) & (SUB_COUNT-1);
+      return SUB_COUNT*(e-SUB_BITS+1) + sub;
+    }
+
+    counter bucket_low(int b) {
+      if (b < SUB_COUNT) return b;
+      int e = b/SUB_COUNT + SUB_BITS - 1;
+      counter sub = b % SUB_COUNT;
+      return (SUB_COUNT + sub) << (e-SUB_BITS);
+    }
+
+    counter bucket_high(int b) {
+      if (b+1 >= NBUCKETS) return ~(counter)0;
+      return bucket_low(b+1)-1;
+    }
+
+    /// counters are written only by the thread owning them, so
+    /// a plain load+store is enough (no locked instruction)
+    inline void add(atomic<counter> &c, counter v) {
+      c.store(c.load(memory_order_relaxed)+v, memory_order_relaxed);
+    }
+
+    /// counters of one module in one thread
+    class module_stats {
+    public:
+      string name;
+      atomic<counter> calls, sentences, tokens, usecs, max_usecs;
+      atomic<counter> hist[NBUCKETS];
+
+      module_stats(const string &n) : name(n) { clear(); }
+      void clear() {
+        calls.store(0); sentences.store(0); tokens.store(0);
+        usecs.store(0); max_usecs.store(0);
+        for (int b=0; b<NBUCKETS; b++) hist[b].store(0);
+      }
+    };
+
+    /// counters of all modules in one thread. Only the owner thread adds
+    /// modules, holding the mutex so exports can walk the map safely.
+    class thread_counters {
+    public:
+      boost::mutex sem;
+      unordered_map<const char*, module_stats*> mods;
+      ~thread_counters() {
+        for (unordered_map<const char*, module_stats*>::iterator m=mods.begin(); m!=mods.end(); m++)
+          delete m->second;
+      }
+    };
+
+    /// all per-thread counters. Counters of finished threads are kept,
+    /// and handed to new threads, so short-lived workers do not pile up.
+    class registry {
+    public:
+      boost::mutex sem;
+      list<thread_counters*> all;
+      vector<thread_counters*> unused;
+
+      thread_counters* acquire() {
+        boost::mutex::scoped_lock lock(sem);
+        if (unused.empty()) {
+          all.push_back(new thread_counters());
+          return all.back();
+        }
+        thread_counters *tc = unused.back();
+        unused.pop_back();
+        return tc;
+      }
+      void release(thread_counters *tc) {
+        boost::mutex::scoped_lock lock(sem);
+        unused.push_back(tc);
+      }
+    };
+
+    /// never destroyed, since threads may still release counters at exit
+    registry& get_registry() {
+      static registry *r = new registry();
+      return *r;
+    }
+
+    /// counters of calling thread
+    class holder {
+    public:
+      thread_counters *tc;
+      holder() : tc(get_registry().acquire()) {}
+      ~holder() { get_registry().release(tc); }
+    };
+
+    thread_counters& local_counters() {
+      static thread_local holder h;
+      return *h.tc;
+    }
+
+    /// readable module name
+    string module_name(const char *m, bool is_type) {
+      string name = m;
+#ifdef __GNUG__
+      if (is_type) {
+        int status;
+        char *d = abi::__cxa_demangle(m, NULL, NULL, &status);
+        if (status==0 and d!=NULL) name = d;
+        free(d);
+      }
+#endif
+      if (name.compare(0,10,"freeling::")==0) name = name.substr(10);
+      return name;
+    }
+
+    /// escape a string for a Prometheus label or a JSON string
+    string quoted(const string &s) {
+      string r;
+      for (size_t i=0; i<s.size(); i++) {
+        if (s[i]=='"' or s[i]=='\\') r += '\\';
+        r += s[i];
+      }
+      return "\"" + r + "\"";
+    }
+
+    /// totals of one module over all threads
+    class module_totals {
+    public:
+      counter calls, sentences, tokens, usecs, max_usecs;
+      vector<counter> hist;
+      module_totals() : calls(0), sentences(0), tokens(0), usecs(0), max_usecs(0), hist(NBUCKETS,0) {}
+
+      /// upper bound of the bucket holding the given quantile
+      counter quantile(double q) const {
+        if (calls==0) return 0;
+        counter target = (counter)ceil(q*calls);
+        counter acc=0;
+        for (int b=0; b<NBUCKETS; b++) {
+          acc += hist[b];
+          if (acc >= target) return min(bucket_high(b), max_usecs);
+        }
+        return max_usecs;
+      }
+    };
+
+    void collect(map<string,module_totals> &res) {
+      registry &r = get_registry();
+      boost::mutex::scoped_lock lock(r.sem);
+      for (list<thread_counters*>::iterator t=r.all.begin(); t!=r.all.end(); t++) {
+        boost::mutex::scoped_lock tlock((*t)->sem);
+        for (unordered_map<const char*, module_stats*>::iterator m=(*t)->mods.begin(); m!=(*t)->mods.end(); m++) {
+          const module_stats &st = *m->second;
+          module_totals &tot = res[st.name];
+          tot.calls += st.calls.load(memory_order_relaxed);
+          tot.sentences += st.sentences.load(memory_order_relaxed);
+          tot.tokens += st.tokens.load(memory_order_relaxed);
+          tot.usecs += st.usecs.load(memory_order_relaxed);
+          tot.max_usecs = max(tot.max_usecs, st.max_usecs.load(memory_order_relaxed));
+          for (int b=0; b<NBUCKETS; b++) tot.hist[b] += st.hist[b].load(memory_order_relaxed);
+        }
+      }
+    }
+
+    const double QUANTILES[] = {0.5, 0.9, 0.99};
+    const int NQUANTILES = 3;
+  }
+
+  ///////////////////////////////////////////////////////////////
+  /// turn recording on or off
+  ///////////////////////////////////////////////////////////////
+
+  void metrics::enable(bool b) {
+    enabled.store(b, memory_order_relaxed);
+  }
+
+  ///////////////////////////////////////////////////////////////
+  /// add a call of given module to the counters of calling thread
+  ///////////////////////////////////////////////////////////////
+
+  void metrics::record(const char *module, bool is_type, unsigned long us,
+                       unsigned long nsent, unsigned long ntok) {
+    thread_counters &tc = local_counters();
+    unordered_map<const char*, module_stats*>::iterator m = tc.mods.find(module);
+    module_stats *st;
+    if (m!=tc.mods.end()) st = m->second;
+    else {
+      st = new module_stats(module_name(module,is_type));
+      boost::mutex::scoped_lock lock(tc.sem);
+      tc.mods.insert(make_pair(module,st));
+    }
+
+    add(st->calls, 1);
+    add(st->sentences, nsent);
+    add(st->tokens, ntok);
+    add(st->usecs, us);
+    if (us > st->max_usecs.load(memory_order_relaxed)) st->max_usecs.store(us, memory_order_relaxed);
+    add(st->hist[bucket_of(us)], 1);
+  }
+
+  ///////////////////////////////////////////////////////////////
+  /// set all counters to zero. Calls being recorded by other
+  /// threads at the same time may survive the reset.
+  ///////////////////////////////////////////////////////////////
+
+  void metrics::reset() {
+    registry &r = get_registry();
+    boost::mutex::scoped_lock lock(r.sem);
+    for (list<thread_counters*>::iterator t=r.all.begin(); t!=r.all.end(); t++) {
+      boost::mutex::scoped_lock tlock((*t)->sem);
+      for (unordered_map<const char*, module_stats*>::iterator m=(*t)->mods.begin(); m!=(*t)->mods.end(); m++)
+        m->second->clear();
+    }
+  }
+
+  ///////////////////////////////////////////////////////////////
+  /// dump counters in Prometheus text exposition format
+  ///////////////////////////////////////////////////////////////
+
+  wstring metrics::to_prometheus() {
+    map<string,module_totals> res;
+    collect(res);
+
+    ostringstream out;
+    out << "# HELP freeling_module_calls_total Calls to each FreeLing module." << endl;
+    out << "# TYPE freeling_module_calls_total counter" << endl;
+    for (map<string,module_totals>::const_iterator m=res.begin(); m!=res.end(); m++)
+      out << "freeling_module_calls_total{module=" << quoted(m->first) << "} " << m->second.calls << endl;
+
+    out << "# HELP freeling_module_sentences_total Sentences processed by each FreeLing module." << endl;
+    out << "# TYPE freeling_module_sentences_total counter" << endl;
+    for (map<string,module_totals>::const_iterator m=res.begin(); m!=res.end(); m++)
+      out << "freeling_module_sentences_total{module=" << quoted(m->first) << "} " << m->second.sentences << endl;
+
+    out << "# HELP freeling_module_tokens_total Tokens processed by each FreeLing module." << endl;
+    out << "# TYPE freeling_module_tokens_total counter" << endl;
+    for (map<string,module_totals>::const_iterator m=res.begin(); m!=res.end(); m++)
+      out << "freeling_module_tokens_total{module=" << quoted(m->first) << "} " << m->second.tokens << endl;
+
+    out << "# HELP freeling_module_latency_seconds Wall time per call of each FreeLing module." << endl;
+    out << "# TYPE freeling_module_latency_seconds summary" << endl;
+    for (map<string,module_totals>::const_iterator m=res.begin(); m!=res.end(); m++) {
+      for (int q=0; q<NQUANTILES; q++)
+        out << "freeling_module_latency_seconds{module=" << quoted(m->first) << ",quantile=\"" << QUANTILES[q] << "\"} "
+            << m->second.quantile(QUANTILES[q])/1e6 << endl;
+      out << "freeling_module_latency_seconds_sum{module=" << quoted(m->first) << "} " << m->second.usecs/1e6 << endl;
+      out << "freeling_module_latency_seconds_count{module=" << quoted(m->first) << "} " << m->second.calls << endl;
+    }
+
+    out << "# HELP freeling_module_latency_max_seconds Longest call of each FreeLing module." << endl;
+    out << "# TYPE freeling_module_latency_max_seconds gauge" << endl;
+    for (map<string,module_totals>::const_iterator m=res.begin(); m!=res.end(); m++)
+      out << "freeling_module_latency_max_seconds{module=" << quoted(m->first) << "} " << m->second.max_usecs/1e6 << endl;
+
+    return util::string2wstring(out.str());
+  }
+
+  ///////////////////////////////////////////////////////////////
+  /// dump counters as a JSON object
+  ///////////////////////////////////////////////////////////////
+
+  wstring metrics::to_json() {
+    map<string,module_totals> res;
+    collect(res);
+
+    ostringstream out;
+    out << "{\"modules\": {";
+    for (map<string,module_totals>::const_iterator m=res.begin(); m!=res.end(); m++) {
+      if (m!=res.begin()) out << ",";
+      const module_totals &t = m->second;
+      out << quoted(m->first) << ": {"
+          << "\"calls\": " << t.calls << ", "
+          << "\"sentences\": " << t.sentences << ", "
+          << "\"tokens\": " << t.tokens << ", "
+          << "\"seconds\": " << t.usecs/1e6 << ", "
+          << "\"latency_us\": {"
+          << "\"p50\": " << t.quantile(0.5) << ", "
+          << "\"p90\": " << t.quantile(0.9) << ", "
+          << "\"p99\": " << t.quantile(0.99) << ", "
+          << "\"max\": " << t.max_usecs << "}}";
+    }
+    out << "}}";
+
+    return util::string2wstring(out.str());
+  }
+
+} // namespace
@@ -0,0 +1,127 @@
+//////////////////////////////////////////////////////////////////
+//
+//    FreeLing - Open Source Language Analyzers
+//
+//    Copyright (C) 2014   TALP Research Center
+//                         Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU Affero General Public
+//    License as published by the Free Software Foundation; either
+//    version 3 of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Affero General Public License for more details.
+//
+//    You should have received a copy of the GNU Affero General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: Lluis Padro (padro@lsi.upc.es)
+//             TALP Research Center
+//             despatx C6.212 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+////////////////////////////////////////////////////////////////
+
+#include <map>
+
+#include <boost/filesystem.hpp>
+
+#include "freeling/morfo/model_registry.h"
+#include "freeling/morfo/util.h"
+
+using namespace std;
+
+namespace freeling {
+
+  namespace {
+
+    /// a model and the mutex guarding its creation
+    class entry {
+    public:
+      weak_ptr<void> model;
+      shared_ptr<boost::mutex> sem;
+    };
+
+    typedef map<pair<string,wstring>, entry> entry_map;
+
+    /// registry state, never destroyed since models may be released at exit
+    boost::mutex& registry_sem() {
+      static boost::mutex *sem = new boost::mutex();
+      return *sem;
+    }
+    entry_map& entries() {
+      static entry_map *m = new entry_map();
+      return *m;
+    }
+  }
+
+  ///////////////////////////////////////////////////////////////
+  /// mutex serializing the creation of the model with given key.
+  /// Forget entries of freed models nobody is loading.
+  ///////////////////////////////////////////////////////////////
+
+  shared_ptr<boost::mutex> model_registry::key_lock(const char *type, const wstring &key) {
+    boost::mutex::scoped_lock lock(registry_sem());
+    entry_map &em = entries();
+
+    entry_map::iterator e = em.begin();
+    while (e!=em.end()) {
+      if (e->second.model.expired() and e->second.sem.use_count()==1) e = em.erase(e);
+      else ++e;
+    }
+
+    entry &en = em[make_pair(string(type),key)];
+    if (not en.sem) en.sem = make_shared<boost::mutex>();
+    return en.sem;
+  }
+
+  ///////////////////////////////////////////////////////////////
+  /// model stored under given key, if still alive
+  ///////////////////////////////////////////////////////////////
+
+  shared_ptr<void> model_registry::find(const char *type, const wstring &key) {
+    boost::mutex::scoped_lock lock(registry_sem());
+    entry_map::const_iterator e = entries().find(make_pair(string(type),key));
+    if (e==entries().end()) return shared_ptr<void>();
+    return e->second.model.lock();
+  }
+
+  ///////////////////////////////////////////////////////////////
+  /// remember model under given key
+  ///////////////////////////////////////////////////////////////
+
+  void model_registry::store(const char *type, const wstring &key, const shared_ptr<void> &model) {
+    boost::mutex::scoped_lock lock(registry_sem());
+    entries()[make_pair(string(type),key)].model = model;
+  }
+
+  ///////////////////////////////////////////////////////////////
+  /// number of models currently held by someone
+  ///////////////////////////////////////////////////////////////
+
+  size_t model_registry::size() {
+    boost::mutex::scoped_lock lock(registry_sem());
+    size_t n=0;
+    for (entry_map::const_iterator e=entries().begin(); e!=entries().end(); e++)
+      if (not e->second.model.expired()) n++;
+    return n;
+  }
+
+  ///////////////////////////////////////////////////////////////
+  /// canonical form of a file name. If the file can not be
+  /// resolved, the name is returned as given.
+  ///////////////////////////////////////////////////////////////
+
+  wstring model_registry::canonical(const wstring &fname) {
+    if (fname.empty()) return fname;
+    boost::system::error_code ec;
+    boost::filesystem::path p = boost::filesystem::canonical(util::wstring2string(fname), ec);
+    if (ec) return fname;
+    return util::string2wstring(p.string());
+  }
+
+} // namespace
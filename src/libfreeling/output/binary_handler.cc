@@ -0,0 +1,272 @@
+//////////////////////////////////////////////////////////////////
+//
+//    FreeLing - Open Source Language Analyzers
+//
+//    Copyright (C) 2014   TALP Research Center
+//                         Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU Affero General Public
+//    License as published by the Free Software Foundation; either
+//    version 3 of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Affero General Public License for more details.
+//
+//    You should have received a copy of the GNU Affero General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: Lluis Padro (padro@lsi.upc.es)
+//             TALP Research Center
+//             despatx C6.212 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+////////////////////////////////////////////////////////////////
+
+#include <cstring>
+#include <algorithm>
+#include "freeling/morfo/util.h"
+#include "freeling/morfo/traces.h"
+#include "freeling/output/binary_handler.h"
+
+using namespace std;
+using namespace freeling;
+using namespace freeling::io;
+
+#undef MOD_TRACENAME
+#undef MOD_TRACECODE
+#define MOD_TRACENAME L"BINARY_HANDLER"
+#define MOD_TRACECODE OUTPUT_TRACE
+
+const string binary_handler::Magic = "FLBN";
+const unsigned char binary_handler::Version = 1;
+
+//---------------------------------------------
+// Constructor/destructor
+//---------------------------------------------
+
+binary_handler::binary_handler() {}
+binary_handler::~binary_handler() {}
+
+
+/////////////////////////////////////////////////////
+///   byte locale
+/////////////////////////////////////////////////////
+
+namespace {
+
+  /// converts each wide character in 0-255 to the byte with 
+  /// the same value and back, regardless of the locale encoding
+  class byte_codecvt : public codecvt<wchar_t,char,mbstate_t> {
+  protected:
+    result do_out(mbstate_t &st, const wchar_t *from, const wchar_t *from_end, const wchar_t *&from_next,
+                  char *to, char *to_end, char *&to_next) const {
+      while (from<from_end and to<to_end and (unsigned long)(*from)<=0xFF) 
+        *to++ = (char)(unsigned char)(*from++);
+      from_next = from; 
+      to_next = to;
+      if (from==from_end) return ok;
+      else if (to==to_end) return partial;
+      else return error;
+    }
+
+    result do_in(mbstate_t &st, const char *from, const char *from_end, const char *&from_next,
+                 wchar_t *to, wchar_t *to_end, wchar_t *&to_next) const {
+      while (from<from_end and to<to_end) 
+        *to++ = (wchar_t)(unsigned char)(*from++);
+      from_next = from;
+      to_next = to;
+      return (from==from_end ? ok : partial);
+    }
+
+    result do_unshift(mbstate_t &st, char *to, char *to_end, char *&to_next) const {
+      to_next = to;
+      return noconv;
+    }
+
+    int do_length(mbstate_t &st, const char *from, const char *from_end, size_t max) const {
+      return (int)min((size_t)(from_end-from), max);
+    }
+
+    int do_encoding() const throw() { return 1; }
+    int do_max_length() const throw() { return 1; }
+    bool do_always_noconv() const throw() { return false; }
+  };
+}
+
+//---------------------------------------------
+// locale with one byte per wide character
+//---------------------------------------------
+
+locale binary_handler::byte_locale(const locale &base) {
+  return locale(base, new byte_codecvt());
+}
+
+
+/////////////////////////////////////////////////////
+///   encoder
+/////////////////////////////////////////////////////
+
+binary_handler::encoder::encoder() {}
+
+//---------------------------------------------
+// unsigned integers as LEB128 varints
+//---------------------------------------------
+
+void binary_handler::encoder::put_uint(unsigned long long x) {
+  while (x>=0x80) {
+    buff.push_back((char)((x & 0x7F) | 0x80));
+    x >>= 7;
+  }
+  buff.push_back((char)x);
+}
+
+//---------------------------------------------
+// signed integers, zigzag encoded so small negatives stay short
+//---------------------------------------------
+
+void binary_handler::encoder::put_int(long long x) {
+  put_uint(((unsigned long long)x << 1) ^ (unsigned long long)(x >> 63));
+}
+
+void binary_handler::encoder::put_bool(bool b) { buff.push_back(b ? 1 : 0); }
+
+//---------------------------------------------
+// doubles as 8 little-endian bytes
+//---------------------------------------------
+
+void binary_handler::encoder::put_double(double d) {
+  unsigned long long x;
+  memcpy(&x, &d, sizeof(x));
+  for (int i=0; i<8; i++) {
+    buff.push_back((char)(x & 0xFF));
+    x >>= 8;
+  }
+}
+
+//---------------------------------------------
+// strings: reference to previous occurrence (index+1),
+// or 0 followed by length and UTF-8 bytes.
+//---------------------------------------------
+
+void binary_handler::encoder::put_string(const wstring &s) {
+  map<wstring,size_t>::const_iterator p = strings.find(s);
+  if (p!=strings.end()) {
+    put_uint(p->second+1);
+    return;
+  }
+
+  string u = util::wstring2string(s);
+  put_uint(0);
+  put_uint(u.size());
+  buff.append(u);
+  strings.insert(make_pair(s,strings.size()));
+}
+
+//---------------------------------------------
+// write header and payload to given stream
+//---------------------------------------------
+
+void binary_handler::encoder::write_message(ostream &sout, MessageType type) const {
+  encoder len;
+  len.put_uint(buff.size());
+
+  sout.write(Magic.data(), Magic.size());
+  sout.put((char)Version);
+  sout.put((char)type);
+  sout.write(len.buff.data(), len.buff.size());
+  sout.write(buff.data(), buff.size());
+}
+
+
+/////////////////////////////////////////////////////
+///   decoder
+/////////////////////////////////////////////////////
+
+binary_handler::decoder::decoder(const string &payload) : buff(payload), pos(0) {}
+
+unsigned char binary_handler::decoder::next_byte() {
+  if (pos>=buff.size()) 
+    ERROR_CRASH(L"Truncated binary message.");
+  return (unsigned char)buff[pos++];
+}
+
+unsigned long long binary_handler::decoder::get_uint() {
+  unsigned long long x=0;
+  int shift=0;
+  unsigned char b;
+  do {
+    b = next_byte();
+    x |= (unsigned long long)(b & 0x7F) << shift;
+    shift += 7;
+  } while (b & 0x80);
+  return x;
+}
+
+long long binary_handler::decoder::get_int() {
+  unsigned long long x = get_uint();
+  return (long long)(x >> 1) ^ -(long long)(x & 1);
+}
+
+bool binary_handler::decoder::get_bool() { return next_byte()!=0; }
+
+double binary_handler::decoder::get_double() {
+  unsigned long long x=0;
+  for (int i=0; i<8; i++) 
+    x |= (unsigned long long)next_byte() << (8*i);
+  double d;
+  memcpy(&d, &x, sizeof(d));
+  return d;
+}
+
+wstring binary_handler::decoder::get_string() {
+  size_t ref = get_uint();
+  if (ref>0) {
+    if (ref>strings.size()) 
+      ERROR_CRASH(L"Invalid string reference in binary message.");
+    return strings[ref-1];
+  }
+
+  size_t len = get_uint();
+  if (pos+len>buff.size()) 
+    ERROR_CRASH(L"Truncated binary message.");
+  strings.push_back(util::string2wstring(buff.substr(pos,len)));
+  pos += len;
+  return strings.back();
+}
+
+//---------------------------------------------
+// read header and payload of next message in stream
+//---------------------------------------------
+
+bool binary_handler::decoder::read_message(istream &sin, MessageType &type, string &payload) {
+
+  char head[6];
+  if (not sin.read(head, 6)) return false;
+
+  if (string(head,4)!=Magic) 
+    ERROR_CRASH(L"Invalid binary message header.");
+  if ((unsigned char)head[4]!=Version) 
+    ERROR_CRASH(L"Unsupported binary format version "+util::int2wstring((unsigned char)head[4]));
+  type = (MessageType)head[5];
+
+  // payload length
+  unsigned long long len=0;
+  int shift=0;
+  int b;
+  do {
+    b = sin.get();
+    if (b==EOF) ERROR_CRASH(L"Truncated binary message.");
+    len |= (unsigned long long)(b & 0x7F) << shift;
+    shift += 7;
+  } while (b & 0x80);
+
+  payload.resize(len);
+  if (len>0 and not sin.read(&payload[0], len)) 
+    ERROR_CRASH(L"Truncated binary message.");
+
+  return true;
+}
@@ -0,0 +1,429 @@
+//////////////////////////////////////////////////////////////////
+//
+//    FreeLing - Open Source Language Analyzers
+//
+//    Copyright (C) 2014   TALP Research Center
+//                         Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU Affero General Public
+//    License as published by the Free Software Foundation; either
+//    version 3 of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Affero General Public License for more details.
+//
+//    You should have received a copy of the GNU Affero General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: Lluis Padro (padro@lsi.upc.es)
+//             TALP Research Center
+//             despatx C6.212 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+////////////////////////////////////////////////////////////////
+
+#include <sstream>
+#include "freeling/morfo/traces.h"
+#include "freeling/output/input_binary.h"
+
+using namespace std;
+using namespace freeling;
+using namespace freeling::io;
+
+#undef MOD_TRACENAME
+#undef MOD_TRACECODE
+#define MOD_TRACENAME L"INPUT_BINARY"
+#define MOD_TRACECODE OUTPUT_TRACE
+
+
+//---------------------------------------------
+// Constructor
+//---------------------------------------------
+
+input_binary::input_binary() : input_handler(), binary_handler() {}
+
+//---------------------------------------------
+// Destructor
+//---------------------------------------------
+
+input_binary::~input_binary() {}
+
+
+//---------------------------------------------
+// decode one analysis
+//---------------------------------------------
+
+analysis input_binary::decode_analysis(decoder &dec) const {
+
+  wstring lemma = dec.get_string();
+  wstring tag = dec.get_string();
+  analysis a(lemma,tag);
+  a.set_prob(dec.get_double());
+  a.set_distance(dec.get_double());
+
+  list<pair<wstring,double> > senses;
+  size_t n = dec.get_uint();
+  for (size_t i=0; i<n; i++) {
+    wstring sns = dec.get_string();
+    senses.push_back(make_pair(sns,dec.get_double()));
+  }
+  a.set_senses(senses);
+
+  list<word> rtk;
+  n = dec.get_uint();
+  for (size_t i=0; i<n; i++) 
+    rtk.push_back(decode_word(dec));
+  if (not rtk.empty()) a.set_retokenizable(rtk);
+
+  n = dec.get_uint();
+  for (size_t i=0; i<n; i++) 
+    a.mark_selected(dec.get_int());
+
+  n = dec.get_uint();
+  for (size_t i=0; i<n; i++) 
+    a.user.push_back(dec.get_string());
+
+  return a;
+}
+
+
+//---------------------------------------------
+// decode one word
+//---------------------------------------------
+
+word input_binary::decode_word(decoder &dec) const {
+
+  wstring form = dec.get_string();
+  wstring phform = dec.get_string();
+  unsigned long start = dec.get_uint();
+  unsigned long finish = dec.get_uint();
+  size_t pos = dec.get_uint();
+  unsigned mask = dec.get_uint();
+  bool lck_an = dec.get_bool();
+  bool lck_mw = dec.get_bool();
+  bool amb_mw = dec.get_bool();
+
+  list<word> mw;
+  size_t n = dec.get_uint();
+  for (size_t i=0; i<n; i++) 
+    mw.push_back(decode_word(dec));
+
+  word w = (mw.empty() ? word(form) : word(form,mw));
+  w.set_ph_form(phform);
+  w.set_span(start,finish);
+  w.set_position(pos);
+  w.set_analyzed_by(mask);
+  if (lck_an) w.lock_analysis();
+  if (lck_mw) w.lock_multiwords();
+  w.set_ambiguous_mw(amb_mw);
+
+  n = dec.get_uint();
+  for (size_t i=0; i<n; i++) {
+    wstring f = dec.get_string();
+    int d = dec.get_int();
+    alternative alt(f,d);
+    alt.set_probability(dec.get_double());
+    size_t ns = dec.get_uint();
+    for (size_t j=0; j<ns; j++)
+      alt.add_selection(dec.get_int());
+    w.add_alternative(alt);
+  }
+
+  n = dec.get_uint();
+  for (size_t i=0; i<n; i++) 
+    w.user.push_back(dec.get_string());
+
+  // analysis are added as they are, keeping their kbest selections
+  n = dec.get_uint();
+  for (size_t i=0; i<n; i++) 
+    w.push_back(decode_analysis(dec));
+
+  return w;
+}
+
+
+//---------------------------------------------
+// decode node information common to parse and dependency trees
+//---------------------------------------------
+
+node input_binary::decode_node(decoder &dec, sentence &s) const {
+
+  node nd;
+  nd.set_node_id(dec.get_string());
+  nd.set_label(dec.get_string());
+  nd.set_head(dec.get_bool());
+  nd.set_chunk(dec.get_int());
+  size_t pos = dec.get_uint();
+  if (pos>0) {
+    if (pos>s.size()) ERROR_CRASH(L"Invalid word reference in binary message.");
+    nd.set_word(s[pos-1]);
+  }
+  size_t n = dec.get_uint();
+  for (size_t i=0; i<n; i++) 
+    nd.user.push_back(dec.get_string());
+
+  return nd;
+}
+
+
+//---------------------------------------------
+// decode a parse tree 
+//---------------------------------------------
+
+void input_binary::decode_parse_tree(decoder &dec, sentence &s, parse_tree &t) const {
+
+  t = parse_tree(decode_node(dec,s));
+  size_t n = dec.get_uint();
+  for (size_t i=0; i<n; i++) {
+    parse_tree child;
+    decode_parse_tree(dec,s,child);
+    t.add_child(child);
+  }
+}
+
+
+//---------------------------------------------
+// decode a dependency tree 
+//---------------------------------------------
+
+void input_binary::decode_dep_tree(decoder &dec, sentence &s, 
+                                   const vector<parse_tree::iterator> &ptindex,
+                                   dep_tree &t) const {
+
+  depnode dn(decode_node(dec,s));
+  size_t lk = dec.get_uint();
+  if (lk>0) {
+    if (lk>ptindex.size()) ERROR_CRASH(L"Invalid parse tree link in binary message.");
+    dn.set_link(ptindex[lk-1]);
+  }
+
+  t = dep_tree(dn);
+  size_t n = dec.get_uint();
+  for (size_t i=0; i<n; i++) {
+    dep_tree child;
+    decode_dep_tree(dec,s,ptindex,child);
+    t.add_child(child);
+  }
+}
+
+
+//---------------------------------------------
+// decode a sentence 
+//---------------------------------------------
+
+void input_binary::decode_sentence(decoder &dec, sentence &s) const {
+
+  s.clear();
+  s.set_sentence_id(dec.get_string());
+  s.set_is_tagged(dec.get_bool());
+  s.set_best_seq(dec.get_int());
+
+  size_t n = dec.get_uint();
+  for (size_t i=0; i<n; i++) 
+    s.push_back(decode_word(dec));
+
+  n = dec.get_uint();
+  for (size_t i=0; i<n; i++) {
+    int k = dec.get_int();
+    parse_tree pt;
+    decode_parse_tree(dec,s,pt);
+    s.set_parse_tree(pt,k);
+  }
+
+  n = dec.get_uint();
+  for (size_t i=0; i<n; i++) {
+    int k = dec.get_int();
+    // index nodes in the sentence parse tree, to restore links
+    vector<parse_tree::iterator> ptindex;
+    if (s.has_parse_tree(k)) {
+      parse_tree &pt = s.get_parse_tree(k);
+      for (parse_tree::iterator p=pt.begin(); p!=pt.end(); ++p) 
+        ptindex.push_back(p);
+    }
+    dep_tree dt;
+    decode_dep_tree(dec,s,ptindex,dt);
+    s.set_dep_tree(dt,k);
+  }
+
+  n = dec.get_uint();
+  for (size_t i=0; i<n; i++) {
+    int pos = dec.get_int();
+    wstring sense = dec.get_string();
+    predicate pr(pos,sense);
+    size_t na = dec.get_uint();
+    for (size_t j=0; j<na; j++) {
+      int apos = dec.get_int();
+      pr.add_argument(apos, dec.get_string());
+    }
+    s.add_predicate(pr);
+  }
+}
+
+
+//---------------------------------------------
+// decode a paragraph 
+//---------------------------------------------
+
+void input_binary::decode_paragraph(decoder &dec, paragraph &p) const {
+
+  p.set_paragraph_id(dec.get_string());
+  size_t n = dec.get_uint();
+  for (size_t i=0; i<n; i++) {
+    p.push_back(sentence());
+    decode_sentence(dec,p.back());
+  }
+}
+
+
+//---------------------------------------------
+// read next sentence from a byte stream
+//---------------------------------------------
+
+bool input_binary::read_sentence(istream &sin, sentence &s) const {
+
+  MessageType type;
+  string payload;
+  if (not decoder::read_message(sin,type,payload)) return false;
+  if (type!=BIN_SENTENCE) 
+    ERROR_CRASH(L"Expected a sentence in binary stream, but found a document. Use read_document instead.");
+
+  decoder dec(payload);
+  decode_sentence(dec,s);
+  return true;
+}
+
+
+//---------------------------------------------
+// read a document from a byte stream.  If the stream holds
+// sentences instead, they are loaded as a single paragraph
+//---------------------------------------------
+
+bool input_binary::read_document(istream &sin, document &doc) const {
+
+  doc.clear();
+
+  MessageType type;
+  string payload;
+  if (not decoder::read_message(sin,type,payload)) return false;
+
+  if (type==BIN_DOCUMENT) {
+    decoder dec(payload);
+    size_t n = dec.get_uint();
+    for (size_t i=0; i<n; i++) {
+      doc.push_back(paragraph());
+      decode_paragraph(dec,doc.back());
+    }
+  }
+  else {
+    doc.push_back(paragraph());
+    do {
+      if (type!=BIN_SENTENCE) ERROR_CRASH(L"Unexpected message type in binary stream.");
+      decoder dec(payload);
+      doc.back().push_back(sentence());
+      decode_sentence(dec,doc.back().back());
+    } while (decoder::read_message(sin,type,payload));
+  }
+
+  return true;
+}
+
+
+//---------------------------------------------
+// convert a wide string holding one byte per character
+//---------------------------------------------
+
+string input_binary::narrow(const wstring &lines) {
+  string bytes(lines.size(),' ');
+  for (size_t i=0; i<lines.size(); i++) 
+    bytes[i] = to_byte(lines[i]);
+  return bytes;
+}
+
+//---------------------------------------------
+// byte held by a wide character. Larger values mean the 
+// text was decoded with some locale other than byte_locale
+//---------------------------------------------
+
+char input_binary::to_byte(wchar_t c) {
+  if ((unsigned long)c > 0xFF) 
+    ERROR_CRASH(L"Invalid byte in binary input. Wide streams holding binary messages must use binary_handler::byte_locale.");
+  return (char)(unsigned char)c;
+}
+
+
+//---------------------------------------------
+// load sentences from a wide string. Documents found are
+// flattened into the sentence list.
+//---------------------------------------------
+
+void input_binary::input_sentences(const wstring &lines, list<sentence> &ls) const {
+
+  ls.clear();
+  istringstream sin(narrow(lines));
+  MessageType type;
+  string payload;
+  while (decoder::read_message(sin,type,payload)) {
+    decoder dec(payload);
+    if (type==BIN_SENTENCE) {
+      ls.push_back(sentence());
+      decode_sentence(dec,ls.back());
+    }
+    else {
+      size_t n = dec.get_uint();
+      for (size_t i=0; i<n; i++) {
+        paragraph p;
+        decode_paragraph(dec,p);
+        ls.splice(ls.end(),p);
+      }
+    }
+  }
+}
+
+
+//---------------------------------------------
+// load next sentence from a wide stream
+//---------------------------------------------
+
+bool input_binary::input_sentence(wistream &is, sentence &s) const {
+
+  // collect bytes of next message: header, length and payload
+  string raw;
+  wchar_t c;
+  while (raw.size()<6 and is.get(c)) raw.push_back(to_byte(c));
+  if (raw.size()<6) return false;
+
+  unsigned long long len=0;
+  int shift=0;
+  do {
+    if (not is.get(c)) ERROR_CRASH(L"Truncated binary message.");
+    raw.push_back(to_byte(c));
+    len |= (unsigned long long)(c & 0x7F) << shift;
+    shift += 7;
+  } while (c & 0x80);
+
+  for (unsigned long long i=0; i<len; i++) {
+    if (not is.get(c)) ERROR_CRASH(L"Truncated binary message.");
+    raw.push_back(to_byte(c));
+  }
+
+  istringstream sin(raw);
+  return read_sentence(sin,s);
+}
+
+
+//---------------------------------------------
+// load a document from a wide string
+//---------------------------------------------
+
+void input_binary::input_document(const wstring &lines, document &doc) const {
+
+  istringstream sin(narrow(lines));
+  if (not read_document(sin,doc)) {
+    doc.clear();
+    doc.push_back(paragraph());
+  }
+}
@@ -140,11 +140,39 @@ input_conll::~input_conll() {}
 void input_conll::input_sentences (const wstring &lines, list<sentence> &ls) const {
 
   ls.clear();
+  wistringstream ss(lines);
   conll_sentence cs;
+  while (read_conll_sentence(ss,cs)) {
+    // Convert cs from conll_sentence to freeling::sentence
+    ls.push_back(sentence());
+    conll2freeling(cs,ls.back());
+  }
+}
 
-  wistringstream ss(lines);
+//---------------------------------------------
+// load next sentence in CoNLL format from a stream
+//---------------------------------------------
+
+bool input_conll::input_sentence (wistream &is, sentence &s) const {
+
+  s.clear();
+  conll_sentence cs;
+  if (not read_conll_sentence(is,cs)) return false;
+
+  conll2freeling(cs,s);
+  return true;
+}
+
+//---------------------------------------------
+// read token lines up to next blank line into 'cs'.
+// Returns false if no sentence was found.
+//---------------------------------------------
+
+bool input_conll::read_conll_sentence (wistream &is, conll_sentence &cs) const {
+
+  cs.clear();
   wstring line;
-  while (getline(ss,line)) {
+  while (getline(is,line)) {
     if (not line.empty()) {
       // token line, add fields to vector
       wistringstream sl(line);
@@ -159,16 +187,13 @@ void input_conll::input_sentences (const wstring &lines, list<sentence> &ls) con
       cs.add_token(token);
     }
 
-    else {
-      // end of sentence. Convert cs from conll_sentence to freeling::sentence
-      sentence s;
-      conll2freeling(cs,s);
-      // add completed sentence to result
-      ls.push_back(s);
-      // clear and go for next sentence
-      cs.clear();
-    } 
+    else if (cs.size()>0) 
+      // end of sentence.
+      return true;
   }
+
+  // stream ended. Accept a last sentence not followed by a blank line 
+  return cs.size()>0;
 }
 
 //---------------------------------------------
@@ -185,37 +210,16 @@ void input_conll::input_document(const wstring &lines, document &doc) const {
   int nment = 0;
   conll_sentence cs;
   wistringstream ss(lines);
-  wstring line;
-  while (getline(ss,line)) {
-    if (not line.empty()) {
-      // token line, add fields to vector
-      wistringstream sl(line);
-
-      // read fields into 'token'
-      wstring field;
-      vector<wstring> token;
-      while (sl>>field) 
-        token.push_back(field);
-
-      // add token to conll_sentence
-      cs.add_token(token);
-    }
-
-    else {
-      // end of sentence. Convert cs from conll_sentence to freeling::sentence
-      sentence s;
-      // add ident to sentence
-      s.set_sentence_id(util::int2wstring(nsent));
-      nsent++;
-      // add sentence to document
-      doc.back().push_back(s);
-
-      // extract information from columns into sentence
-      conll2freeling(cs,doc.back().back(),doc,nment); 
-
-      // clear and go for next sentence
-      cs.clear();
-    } 
+  while (read_conll_sentence(ss,cs)) {
+    sentence s;
+    // add ident to sentence
+    s.set_sentence_id(util::int2wstring(nsent));
+    nsent++;
+    // add sentence to document
+    doc.back().push_back(s);
+
+    // extract information from columns into sentence
+    conll2freeling(cs,doc.back().back(),doc,nment); 
   }
 }
 
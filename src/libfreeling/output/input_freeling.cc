@@ -66,37 +66,69 @@ void input_freeling::input_sentences (const wstring &lines, list<sentence> &ls)
 
   size_t sp=0;
   while (getline(sin,line)) {
-    wstringstream lin;
-    lin.str(line);
-
     if (line.empty()) { 
       ls.push_back(s);
       s.clear();
     }
+    else 
+      s.push_back(read_word(line,sp));
+  }
+}
 
-    else {
-      wstring form; 
-      lin>>form;
-      word w(form);
-      // simulate span from input 
-      size_t sp1 = sp; 
-      size_t sp2 = sp + form.length(); 
-      sp = sp2 + 1; 
-      w.set_span(sp1,sp2);
-      
-      wstring lemma,tag;
-      double prob;
-      while (lin>>lemma>>tag>>prob) {
-	analysis a(lemma,tag);
-	a.set_prob(prob);
-	w.add_analysis(a);
-      }
-      w.select_all_analysis();
-      s.push_back(w);
-    }
+
+//---------------------------------------------
+// load next sentence in Freeling format from a stream.
+// Simulated spans run across sentences, as in input_sentences, 
+// so the offset reached is kept in the stream itself.
+//---------------------------------------------
+
+bool input_freeling::input_sentence (wistream &is, sentence &s) const {
+
+  static const int offset_slot = ios_base::xalloc();
+  long &offset = is.iword(offset_slot);
+
+  s.clear();
+  wstring line;
+  size_t sp=offset;
+  bool found=false;
+  while (not found and getline(is,line)) {
+    if (not line.empty()) 
+      s.push_back(read_word(line,sp));
+    else 
+      found = not s.empty();
   }
+
+  offset = sp;
+  // if the stream ended, accept a last sentence not followed by a blank line 
+  return not s.empty();
 }
 
 
+//---------------------------------------------
+// build a word from a line in Freeling format
+//---------------------------------------------
 
+word input_freeling::read_word (const wstring &line, size_t &sp) const {
 
+  wstringstream lin;
+  lin.str(line);
+
+  wstring form; 
+  lin>>form;
+  word w(form);
+  // simulate span from input 
+  size_t sp1 = sp; 
+  size_t sp2 = sp + form.length(); 
+  sp = sp2 + 1; 
+  w.set_span(sp1,sp2);
+      
+  wstring lemma,tag;
+  double prob;
+  while (lin>>lemma>>tag>>prob) {
+    analysis a(lemma,tag);
+    a.set_prob(prob);
+    w.add_analysis(a);
+  }
+  w.select_all_analysis();
+  return w;
+}
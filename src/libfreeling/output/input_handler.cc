@@ -59,3 +59,52 @@ void input_handler::input_document(const wstring &lines, document &doc) const {
 
   input_sentences(lines,doc.back());
 }
+
+
+///---------------------------------------------
+/// Default input_sentence, unless child defines it.
+/// Collects lines up to next blank line and parses them
+/// with input_sentences, so only one sentence is kept in memory.
+///---------------------------------------------
+
+bool input_handler::input_sentence(wistream &is, sentence &s) const {
+
+  s.clear();
+
+  wstring text, line;
+  bool found=false;
+  while (getline(is,line)) {
+    if (not line.empty()) {
+      text += line;
+      text += L'\n';
+      found = true;
+    }
+    else if (found) break;
+  }
+  if (not found) return false;
+
+  // make sure sentence is closed, even if the stream ended without a blank line
+  text += L'\n';
+  list<sentence> ls;
+  input_sentences(text,ls);
+  if (not ls.empty()) s = ls.front();
+  return true;
+}
+
+
+///---------------------------------------------
+/// Load a batch of at most 'maxsent' sentences from a stream.
+///---------------------------------------------
+
+bool input_handler::input_sentences(wistream &is, list<sentence> &ls, size_t maxsent) const {
+
+  ls.clear();
+  while (maxsent==0 or ls.size()<maxsent) {
+    ls.push_back(sentence());
+    if (not input_sentence(is,ls.back())) {
+      ls.pop_back();
+      return false;
+    }
+  }
+  return true;
+}
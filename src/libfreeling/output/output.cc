@@ -35,6 +35,7 @@
 #include "freeling/output/output_xml.h"
 #include "freeling/output/output_naf.h"
 #include "freeling/output/output_train.h"
+#include "freeling/output/output_binary.h"
 
 #include "freeling/morfo/configfile.h"
 #include "freeling/morfo/traces.h"
@@ -90,6 +91,8 @@ using namespace freeling::io;
       who = new output_json(cfgFile);
     else if (output_type==L"train")  
       who = new output_train();
+    else if (output_type==L"binary")  
+      who = new output_binary();
     else {
       ERROR_CRASH (L"Unknown or missing output handler type '"+output_type+L"' in file "+cfgFile);
     }
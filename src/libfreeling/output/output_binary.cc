@@ -0,0 +1,308 @@
+//////////////////////////////////////////////////////////////////
+//
+//    FreeLing - Open Source Language Analyzers
+//
+//    Copyright (C) 2014   TALP Research Center
+//                         Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU Affero General Public
+//    License as published by the Free Software Foundation; either
+//    version 3 of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Affero General Public License for more details.
+//
+//    You should have received a copy of the GNU Affero General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: Lluis Padro (padro@lsi.upc.es)
+//             TALP Research Center
+//             despatx C6.212 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+////////////////////////////////////////////////////////////////
+
+#include <sstream>
+#include "freeling/morfo/traces.h"
+#include "freeling/output/output_binary.h"
+
+using namespace std;
+using namespace freeling;
+using namespace freeling::io;
+
+#undef MOD_TRACENAME
+#undef MOD_TRACECODE
+#define MOD_TRACENAME L"OUTPUT_BINARY"
+#define MOD_TRACECODE OUTPUT_TRACE
+
+
+//---------------------------------------------
+// Constructor
+//---------------------------------------------
+
+output_binary::output_binary() : output_handler(), binary_handler() {}
+
+//---------------------------------------------
+// Destructor
+//---------------------------------------------
+
+output_binary::~output_binary() {}
+
+
+//---------------------------------------------
+// encode one analysis
+//---------------------------------------------
+
+void output_binary::encode_analysis(encoder &enc, const analysis &a) const {
+
+  enc.put_string(a.get_lemma());
+  enc.put_string(a.get_tag());
+  enc.put_double(a.get_prob());
+  enc.put_double(a.get_distance());
+
+  const list<pair<wstring,double> > &senses = a.get_senses();
+  enc.put_uint(senses.size());
+  for (list<pair<wstring,double> >::const_iterator s=senses.begin(); s!=senses.end(); s++) {
+    enc.put_string(s->first);
+    enc.put_double(s->second);
+  }
+
+  const list<word> &rtk = a.get_retokenizable();
+  enc.put_uint(rtk.size());
+  for (list<word>::const_iterator w=rtk.begin(); w!=rtk.end(); w++) 
+    encode_word(enc,*w);
+
+  // k-best sequences where this analysis is selected
+  list<int> sel;
+  for (int k=0; k<=a.max_kbest(); k++) 
+    if (a.is_selected(k)) sel.push_back(k);
+  enc.put_uint(sel.size());
+  for (list<int>::const_iterator k=sel.begin(); k!=sel.end(); k++) 
+    enc.put_int(*k);
+
+  enc.put_uint(a.user.size());
+  for (size_t i=0; i<a.user.size(); i++) 
+    enc.put_string(a.user[i]);
+}
+
+
+//---------------------------------------------
+// encode one word (recursive for multiwords and retokenizations)
+//---------------------------------------------
+
+void output_binary::encode_word(encoder &enc, const word &w) const {
+
+  enc.put_string(w.get_form());
+  enc.put_string(w.get_ph_form());
+  enc.put_uint(w.get_span_start());
+  enc.put_uint(w.get_span_finish());
+  enc.put_uint(w.get_position());
+  enc.put_uint(w.get_analyzed_by());
+  enc.put_bool(w.is_locked_analysis());
+  enc.put_bool(w.is_locked_multiwords());
+  enc.put_bool(w.is_ambiguous_mw());
+
+  const list<word> &mw = w.get_words_mw();
+  enc.put_uint(mw.size());
+  for (list<word>::const_iterator m=mw.begin(); m!=mw.end(); m++) 
+    encode_word(enc,*m);
+
+  // alternatives, with the corrector kbest sequences selecting them
+  enc.put_uint(w.get_alternatives().size());
+  for (list<alternative>::const_iterator a=w.alternatives_begin(); a!=w.alternatives_end(); a++) {
+    enc.put_string(a->get_form());
+    enc.put_int(a->get_distance());
+    enc.put_double(a->get_probability());
+    list<int> sel;
+    for (int k=0; k<=a->max_kbest(); k++)
+      if (a->is_selected(k)) sel.push_back(k);
+    enc.put_uint(sel.size());
+    for (list<int>::const_iterator k=sel.begin(); k!=sel.end(); k++) 
+      enc.put_int(*k);
+  }
+
+  enc.put_uint(w.user.size());
+  for (size_t i=0; i<w.user.size(); i++) 
+    enc.put_string(w.user[i]);
+
+  enc.put_uint(w.size());
+  for (word::const_iterator a=w.analysis_begin(); a!=w.analysis_end(); a++)
+    encode_analysis(enc,*a);
+}
+
+
+//---------------------------------------------
+// encode node information common to parse and dependency trees
+//---------------------------------------------
+
+void output_binary::encode_node(encoder &enc, const node &n) const {
+
+  enc.put_string(n.get_node_id());
+  enc.put_string(n.get_label());
+  enc.put_bool(n.is_head());
+  enc.put_int(n.get_chunk_ord());
+  // word position, shifted so zero means no word
+  enc.put_uint(n.has_word() ? n.get_word().get_position()+1 : 0);
+  enc.put_uint(n.user.size());
+  for (size_t i=0; i<n.user.size(); i++) 
+    enc.put_string(n.user[i]);
+}
+
+
+//---------------------------------------------
+// encode a parse tree, in preorder
+//---------------------------------------------
+
+void output_binary::encode_parse_tree(encoder &enc, parse_tree::const_iterator n) const {
+
+  encode_node(enc,*n);
+  enc.put_uint(n.num_children());
+  for (parse_tree::const_sibling_iterator d=n.sibling_begin(); d!=n.sibling_end(); ++d)
+    encode_parse_tree(enc,d);
+}
+
+
+//---------------------------------------------
+// encode a dependency tree, in preorder.  Links to the
+// parse tree are stored as preorder indexes of that tree.
+//---------------------------------------------
+
+void output_binary::encode_dep_tree(encoder &enc, dep_tree::const_iterator n, 
+                                    const map<const node*,size_t> &ptindex) const {
+
+  encode_node(enc,*n);
+
+  size_t lk = 0;
+  if (n->has_link()) {
+    map<const node*,size_t>::const_iterator p = ptindex.find(&(*(n->get_link())));
+    if (p!=ptindex.end()) lk = p->second+1;
+  }
+  enc.put_uint(lk);
+
+  enc.put_uint(n.num_children());
+  for (dep_tree::const_sibling_iterator d=n.sibling_begin(); d!=n.sibling_end(); ++d)
+    encode_dep_tree(enc,d,ptindex);
+}
+
+
+//---------------------------------------------
+// encode a sentence 
+//---------------------------------------------
+
+void output_binary::encode_sentence(encoder &enc, const sentence &s) const {
+
+  enc.put_string(s.get_sentence_id());
+  enc.put_bool(s.is_tagged());
+  enc.put_int(s.get_best_seq());
+
+  enc.put_uint(s.size());
+  for (sentence::const_iterator w=s.begin(); w!=s.end(); w++) 
+    encode_word(enc,*w);
+
+  // trees may exist for any of the kbest sequences
+  int nk = max((int)s.num_kbest(), s.get_best_seq()+1);
+
+  list<int> ks;
+  for (int k=0; k<nk; k++) 
+    if (s.has_parse_tree(k)) ks.push_back(k);
+  enc.put_uint(ks.size());
+  for (list<int>::const_iterator k=ks.begin(); k!=ks.end(); k++) {
+    enc.put_int(*k);
+    encode_parse_tree(enc, s.get_parse_tree(*k).begin());
+  }
+
+  ks.clear();
+  for (int k=0; k<nk; k++) 
+    if (s.has_dep_tree(k)) ks.push_back(k);
+  enc.put_uint(ks.size());
+  for (list<int>::const_iterator k=ks.begin(); k!=ks.end(); k++) {
+    // index parse tree nodes, to encode links
+    map<const node*,size_t> ptindex;
+    if (s.has_parse_tree(*k)) {
+      size_t i=0;
+      const parse_tree &pt = s.get_parse_tree(*k);
+      for (parse_tree::const_preorder_iterator p=pt.begin(); p!=pt.end(); ++p) 
+        ptindex.insert(make_pair(&(*p),i++));
+    }
+    enc.put_int(*k);
+    encode_dep_tree(enc, s.get_dep_tree(*k).begin(), ptindex);
+  }
+
+  const sentence::predicates &preds = s.get_predicates();
+  enc.put_uint(preds.size());
+  for (sentence::predicates::const_iterator p=preds.begin(); p!=preds.end(); p++) {
+    enc.put_int(p->get_position());
+    enc.put_string(p->get_sense());
+    enc.put_uint(p->size());
+    for (predicate::const_iterator a=p->begin(); a!=p->end(); a++) {
+      enc.put_int(a->get_position());
+      enc.put_string(a->get_role());
+    }
+  }
+}
+
+
+//---------------------------------------------
+// write sentences to a byte stream
+//---------------------------------------------
+
+void output_binary::write_sentences(ostream &sout, const list<sentence> &ls) const {
+
+  for (list<sentence>::const_iterator s=ls.begin(); s!=ls.end(); s++) {
+    encoder enc;
+    encode_sentence(enc,*s);
+    enc.write_message(sout,BIN_SENTENCE);
+  }
+}
+
+
+//---------------------------------------------
+// write a document to a byte stream
+//---------------------------------------------
+
+void output_binary::write_document(ostream &sout, const document &doc) const {
+
+  encoder enc;
+  enc.put_uint(doc.size());
+  for (document::const_iterator p=doc.begin(); p!=doc.end(); p++) {
+    enc.put_string(p->get_paragraph_id());
+    enc.put_uint(p->size());
+    for (paragraph::const_iterator s=p->begin(); s!=p->end(); s++) 
+      encode_sentence(enc,*s);
+  }
+  enc.write_message(sout,BIN_DOCUMENT);
+}
+
+
+//---------------------------------------------
+// copy bytes to a wide stream, one byte per character
+//---------------------------------------------
+
+void output_binary::widen(wostream &sout, const string &bytes) {
+  for (string::const_iterator c=bytes.begin(); c!=bytes.end(); c++) 
+    sout.put((wchar_t)(unsigned char)(*c));
+}
+
+//---------------------------------------------
+// print sentences to a wide stream
+//---------------------------------------------
+
+void output_binary::PrintResults (wostream &sout, const list<sentence> &ls) const {
+  ostringstream buff;
+  write_sentences(buff,ls);
+  widen(sout,buff.str());
+}
+
+//---------------------------------------------
+// print document to a wide stream
+//---------------------------------------------
+
+void output_binary::PrintResults (wostream &sout, const document &doc) const {
+  ostringstream buff;
+  write_document(buff,doc);
+  widen(sout,buff.str());
+}
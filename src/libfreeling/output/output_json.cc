@@ -31,6 +31,8 @@
 ///  Auxiliary functions to print several analysis results
 //////////////////////////////////////////////////////////
 
+#include <cwchar>
+
 #include "freeling/morfo/util.h"
 #include "freeling/morfo/configfile.h"
 #include "freeling/output/output_json.h"
@@ -55,6 +57,7 @@ output_json::output_json() {
   // default values
   AllAnalysis = false;
   AllSenses = false;
+  JsonLines = false;
 }
 
 //---------------------------------------------
@@ -75,6 +78,7 @@ output_json::output_json(const wstring &cfgFile) {
   // default values
   AllAnalysis = false;
   AllSenses = false;
+  JsonLines = false;
   
   wstring line; 
   while (cfg.get_content_line(line)) {
@@ -102,6 +106,7 @@ output_json::output_json(const wstring &cfgFile) {
       bool b = (val==L"true" or val==L"yes" or val==L"y" or val==L"on");
       if (key == L"AllAnalysis") AllAnalysis=b;
       else if (key == L"AllSenses") AllSenses=b;
+      else if (key == L"JsonLines") JsonLines=b;
       else WARNING(L"Invalid option '"+key+L"' in output_xml config file '"+cfgFile+L"'");
       break;
     }
@@ -122,17 +127,120 @@ output_json::~output_json() {}
 
 
 //---------------------------------------------
-// auxiliary to print one word analysis in json
+// activate/deactivate JSONL output
+//---------------------------------------------
+
+void output_json::output_jsonl(bool b) {JsonLines=b;}
+
+
+//---------------------------------------------
+// Streaming json emitter. Writes tokens directly to
+// the output stream, with the same layout that
+// nlohmann::json::dump produces, so no DOM is needed.
+//---------------------------------------------
+
+class output_json::json_writer {
+public:
+  /// indent<0 produces compact output
+  json_writer(wostream &o, int ind) : out(o), indent(ind), after_key(false) {}
+
+  void begin_object() { open(L'{'); }
+  void end_object() { close(L'}'); }
+  void begin_array() { open(L'['); }
+  void end_array() { close(L']'); }
+
+  /// keys are escaped as values are, since some come from tagset files
+  void key(const wchar_t *k) { key(k, k+wcslen(k)); }
+  void key(const wstring &k) { key(k.data(), k.data()+k.size()); }
+
+  void value(const wstring &v) { separator(); escape(v.data(), v.data()+v.size()); }
+  void value(const wchar_t *v) { value(wstring(v)); }
+  void value(bool b) { separator(); out << (b ? L"true" : L"false"); }
+  void value(double d) { 
+    separator(); 
+    // use nlohmann number formatting to get the same representation
+    out << util::string2wstring(jsn::json(d).dump()); 
+  }
+
+  template<class T> void field(const wchar_t *k, const T &v) { key(k); value(v); }
+  void field(const wstring &k, const wstring &v) { key(k); value(v); }
+
+private:
+  wostream &out;
+  int indent;
+  bool after_key;
+  vector<size_t> nelem;
+
+  // print comma and line break needed before a new element
+  void separator() {
+    if (after_key) { after_key=false; return; }
+    if (nelem.empty()) return;
+    if (nelem.back()>0) out << L',';
+    newline(nelem.size());
+    nelem.back()++;
+  }
+
+  void newline(size_t depth) {
+    if (indent<0) return;
+    out << L'\n' << wstring(depth*indent, L' ');
+  }
+
+  void open(wchar_t c) {
+    separator();
+    out << c;
+    nelem.push_back(0);
+  }
+
+  void close(wchar_t c) {
+    size_t n = nelem.back();
+    nelem.pop_back();
+    if (n>0) newline(nelem.size());
+    out << c;
+  }
+
+  void key(const wchar_t *b, const wchar_t *e) {
+    separator();
+    escape(b, e);
+    out << (indent<0 ? L":" : L": ");
+    after_key = true;
+  }
+
+  void escape(const wchar_t *b, const wchar_t *e) {
+    out << L'"';
+    for (const wchar_t *c=b; c!=e; c++) {
+      switch (*c) {
+      case L'"': out << L"\\\""; break;
+      case L'\\': out << L"\\\\"; break;
+      case L'\b': out << L"\\b"; break;
+      case L'\f': out << L"\\f"; break;
+      case L'\n': out << L"\\n"; break;
+      case L'\r': out << L"\\r"; break;
+      case L'\t': out << L"\\t"; break;
+      default:
+        if (*c < 0x20) {
+          wchar_t buff[8];
+          swprintf(buff, 8, L"\\u%04x", (unsigned int)*c);
+          out << buff;
+        }
+        else out << *c;
+      }
+    }
+    out << L'"';
+  }
+};
+
+
+//---------------------------------------------
+// auxiliary to print one word analysis fields in json
 //---------------------------------------------
 
-jsn::ordered_json output_json::json_analysis(const analysis &a, bool print_sel_status, bool print_probs) const {
+void output_json::write_analysis(json_writer &js, const analysis &a, bool print_sel_status, bool print_probs) const {
 
-  jsn::ordered_json an;
-  wstring lemma = a.get_lemma();
-  wstring tag = a.get_tag();
+  const wstring &lemma = a.get_lemma();
+  const wstring &tag = a.get_tag();
 
-  an["lemma"] = util::wstring2string(lemma);
-  an["tag"] = util::wstring2string(tag); 
+  js.field(L"lemma", lemma);
+  js.field(L"tag", tag); 
   
   if (Tags!=NULL) {
     if (lemma.find(L"+")!=wstring::npos) { // is a retokenizable analysis
@@ -142,164 +250,170 @@ jsn::ordered_json output_json::json_analysis(const analysis &a, bool print_sel_s
 	shtag += L"+" + Tags->get_short_tag(*t);
 	msd += L"+" + Tags->get_msd_string(*t);
       }
-      an["ctag"] = jsn::json(util::wstring2string(shtag.substr(1)));
-      an["msd"] = jsn::json(util::wstring2string(msd.substr(1)));
+      js.field(L"ctag", shtag.substr(1));
+      js.field(L"msd", msd.substr(1));
     }
     
     else { // not retokenizable
-      an["ctag"] = jsn::json(util::wstring2string(Tags->get_short_tag(tag)));
+      js.field(L"ctag", Tags->get_short_tag(tag));
       list<pair<wstring,wstring> > feats = Tags->get_msd_features(tag);
       for (list<pair<wstring,wstring> >::iterator f=feats.begin(); f!=feats.end(); f++) 
-	an[freeling::util::wstring2string(f->first)] = jsn::json(util::wstring2string(f->second));
+	js.field(f->first, f->second);
     }
   }
 
-  if (print_probs and a.get_prob()>=0) an["prob"] = jsn::json(a.get_prob());
-  if (print_sel_status and a.is_selected()) an["selected"] = jsn::json(true);
-
-  return an;
+  if (print_probs and a.get_prob()>=0) js.field(L"prob", a.get_prob());
+  if (print_sel_status and a.is_selected()) js.field(L"selected", true);
 }
 
   
 //---------------------------------------------
-// print sentences in list
+// print one sentence
 //---------------------------------------------
 
-jsn::ordered_json output_json::json_Sentences (const list<sentence> &ls) const {
+void output_json::write_Sentence (json_writer &js, const sentence &s) const {
 
-  
-  jsn::ordered_json sentlist = json::array();
-  if (ls.empty()) return sentlist;
-    
-  for (list<sentence>::const_iterator s=ls.begin(); s!=ls.end(); s++) {
-    
-    if (s->empty()) continue;
-    
-    int best = s->get_best_seq();
-    
-    jsn::ordered_json sent;
-    sent["id"] = jsn::json(util::wstring2string(s->get_sentence_id()));
-    jsn::ordered_json tokens = json::array();
+  int best = s.get_best_seq();
     
-    for (sentence::const_iterator w=s->begin(); w!=s->end(); w++) {
-      // basic token stuff
-      jsn::ordered_json token;
-      token["id"] = jsn::json(util::wstring2string(get_token_id(s->get_sentence_id(),w->get_position()+1)));
-      token["begin"] = jsn::json(util::wstring2string(util::wstring_from(w->get_span_start())));
-      token["end"] = jsn::json(util::wstring2string(util::wstring_from(w->get_span_finish())));
-      token["form"] = jsn::json(util::wstring2string(w->get_form()));
-      if (not w->get_ph_form().empty())
-	token["phon"] = jsn::json(util::wstring2string(w->get_ph_form()));
+  js.begin_object();
+  js.field(L"id", s.get_sentence_id());
+
+  js.key(L"tokens");
+  js.begin_array();
+  for (sentence::const_iterator w=s.begin(); w!=s.end(); w++) {
+
+    // no analysis, nothing to print
+    if (w->empty()) continue;
+
+    // basic token stuff
+    js.begin_object();
+    js.field(L"id", get_token_id(s.get_sentence_id(),w->get_position()+1));
+    js.field(L"begin", util::wstring_from(w->get_span_start()));
+    js.field(L"end", util::wstring_from(w->get_span_finish()));
+    js.field(L"form", w->get_form());
+    if (not w->get_ph_form().empty())
+      js.field(L"phon", w->get_ph_form());
       
-      // no analysis, nothing else to add
-      if (w->empty()) continue;
-
-      if (not s->is_tagged()) {
-        // morpho output (all analysis)
-	jsn::ordered_json anlist = json::array();	
-        for (word::const_iterator a=w->begin(); a!=w->end(); a++) {
-          if (a->is_retokenizable()) {
-            const list <word> &rtk = a->get_retokenizable();
-            list <analysis> la=compute_retokenization(rtk, rtk.begin(), L"", L"");
-            for (list<analysis>::iterator aa=la.begin(); aa!=la.end(); aa++) {
-              double p=a->get_prob();
-              if (p>=0) aa->set_prob(p/la.size());
-              else aa->set_prob(-1.0);
-              anlist.push_back(json_analysis(*aa,false,true));
-            }
-          }
-          else {
-	    anlist.push_back(json_analysis(*a,false,true));
+    if (not s.is_tagged()) {
+      // morpho output (all analysis)
+      js.key(L"analysis");
+      js.begin_array();
+      for (word::const_iterator a=w->begin(); a!=w->end(); a++) {
+        if (a->is_retokenizable()) {
+          const list <word> &rtk = a->get_retokenizable();
+          list <analysis> la=compute_retokenization(rtk, rtk.begin(), L"", L"");
+          for (list<analysis>::iterator aa=la.begin(); aa!=la.end(); aa++) {
+            double p=a->get_prob();
+            if (p>=0) aa->set_prob(p/la.size());
+            else aa->set_prob(-1.0);
+            js.begin_object();
+            write_analysis(js,*aa,false,true);
+            js.end_object();
           }
         }
-	token["analysis"] = anlist;
+        else {
+          js.begin_object();
+          write_analysis(js,*a,false,true);
+          js.end_object();
+        }
       }
+      js.end_array();
+    }
       
+    else {
+      //  tagger output
+      if (w->selected_begin(best)->is_retokenizable()) {
+        const list <word> &rtk = w->selected_begin(best)->get_retokenizable();
+        list <analysis> la=compute_retokenization(rtk, rtk.begin(), L"", L"");
+        write_analysis(js,*(la.begin()),false,false);
+      }
       else {
-	//  tagger output
-	jsn::ordered_json an;
-	if (w->selected_begin(best)->is_retokenizable()) {
-	  const list <word> &rtk = w->selected_begin(best)->get_retokenizable();
-	  list <analysis> la=compute_retokenization(rtk, rtk.begin(), L"", L"");
-	  an = json_analysis(*(la.begin()),false,false);
-        }
-        else {
-          an = json_analysis(*(w->selected_begin(best)),false,false);
-	}
-
-	for (auto &x : an.items()) {
-	  token[x.key()] = x.value();
-	}
+        write_analysis(js,*(w->selected_begin(best)),false,false);
+      }
 	
-	// NEC output, if any
-	wstring nec=L"";
-	if (w->get_tag(best)==L"NP00SP0") nec=L"PER";
-	else if (w->get_tag(best)==L"NP00G00") nec=L"LOC";
-	else if (w->get_tag(best)==L"NP00O00") nec=L"ORG";
-	else if (w->get_tag(best)==L"NP00V00") nec=L"MISC";
-	if (not nec.empty())
-	  token["nec"] = jsn::json(util::wstring2string(nec));
+      // NEC output, if any
+      wstring nec=L"";
+      if (w->get_tag(best)==L"NP00SP0") nec=L"PER";
+      else if (w->get_tag(best)==L"NP00G00") nec=L"LOC";
+      else if (w->get_tag(best)==L"NP00O00") nec=L"ORG";
+      else if (w->get_tag(best)==L"NP00V00") nec=L"MISC";
+      if (not nec.empty())
+        js.field(L"nec", nec);
 	
-	// WSD output, if any
-	if (not w->get_senses(best).empty())
-	  token["wn"] = jsn::json(util::wstring2string(w->get_senses(best).begin()->first));
+      // WSD output, if any
+      if (not w->get_senses(best).empty())
+        js.field(L"wn", w->get_senses(best).begin()->first);
 	
-	if (AllAnalysis) {
-	  jsn::ordered_json anlist = json::array();
-
-	  for (word::const_iterator a=w->begin(); a!=w->end(); a++) {
-	    jsn::ordered_json mrf;
-	    mrf["lemma"] = jsn::json(util::wstring2string(a->get_lemma()));
-	    mrf["tag"] = jsn::json(util::wstring2string(a->get_tag()));
-	    if (Tags!=NULL) {
-	      mrf["ctag"] = jsn::json(util::wstring2string(Tags->get_short_tag(a->get_tag())));
-	      list<pair<wstring,wstring> > feats = Tags->get_msd_features(a->get_tag());
-	      for (list<pair<wstring,wstring> >::iterator f=feats.begin(); f!=feats.end(); f++) 
-		mrf[freeling::util::wstring2string(f->first)] = jsn::json(util::wstring2string(f->second));
-	    }
-	    if (a->is_selected()) mrf["selected"] = jsn::json(true);
-
-	    anlist.push_back(mrf);
-	  }
-	  token["analysis"] = anlist;
-	}
+      if (AllAnalysis) {
+        js.key(L"analysis");
+        js.begin_array();
+        for (word::const_iterator a=w->begin(); a!=w->end(); a++) {
+          js.begin_object();
+          js.field(L"lemma", a->get_lemma());
+          js.field(L"tag", a->get_tag());
+          if (Tags!=NULL) {
+            js.field(L"ctag", Tags->get_short_tag(a->get_tag()));
+            list<pair<wstring,wstring> > feats = Tags->get_msd_features(a->get_tag());
+            for (list<pair<wstring,wstring> >::iterator f=feats.begin(); f!=feats.end(); f++) 
+              js.field(f->first, f->second);
+          }
+          if (a->is_selected()) js.field(L"selected", true);
+          js.end_object();
+        }
+        js.end_array();
+      }
 	
-	if (AllSenses and not w->get_senses(best).empty()) {
-	  jsn::ordered_json senses = json::array();
-	  for (list<pair<wstring,double> >::const_iterator s=w->get_senses(best).begin(); s!=w->get_senses(best).end(); s++) {
-	    jsn::ordered_json sns;
-	    sns["wn"] = util::wstring2string(s->first);
-	    sns["pgrank"] = s->second;
-	    senses.push_back(sns);
-	  }
-	  token["senses"] = senses;
-	}
+      if (AllSenses and not w->get_senses(best).empty()) {
+        js.key(L"senses");
+        js.begin_array();
+        for (list<pair<wstring,double> >::const_iterator sn=w->get_senses(best).begin(); sn!=w->get_senses(best).end(); sn++) {
+          js.begin_object();
+          js.field(L"wn", sn->first);
+          js.field(L"pgrank", sn->second);
+          js.end_object();
+        }
+        js.end_array();
       }
-
-      tokens.push_back(token);
     }
 
-    sent["tokens"] = tokens;
+    js.end_object();
+  }
+  js.end_array();
     
-    // print parse tree, if any
-    if (s->is_parsed()) {
-      sent["constituents"] = json_Tree (s->get_sentence_id(), s->get_parse_tree(s->get_best_seq()).begin()); 
+  // print parse tree, if any
+  if (s.is_parsed()) {
+    js.key(L"constituents");
+    write_Tree (js, s.get_sentence_id(), s.get_parse_tree(s.get_best_seq()).begin()); 
+  }
+
+  //  print dependency tree, if any
+  if (s.is_dep_parsed()) {
+    js.key(L"dependencies");
+    js.begin_array();
+    write_DepTree (js, s.get_sentence_id(), s.get_dep_tree(s.get_best_seq()).begin());
+    js.end_array();
+
+    // predicates, if any
+    if (not s.get_predicates().empty()) {        
+      js.key(L"predicates");
+      write_PredArgs(js, s);
     }
+  }
 
-    //  print dependency tree, if any
-    if (s->is_dep_parsed()) {
-      sent["dependencies"].push_back(json_DepTree (s->get_sentence_id(), s->get_dep_tree(s->get_best_seq()).begin()));
+  js.end_object();
+}
 
-      // predicates, if any
-      if (not s->get_predicates().empty()) {        
-        sent ["predicates"] = json_PredArgs(*s);
-      }
-    }
 
-    sentlist.push_back(sent);
-  }
+//---------------------------------------------
+// print sentences in list
+//---------------------------------------------
 
-  return sentlist;
+void output_json::write_Sentences (json_writer &js, const list<sentence> &ls) const {
+
+  js.begin_array();
+  for (list<sentence>::const_iterator s=ls.begin(); s!=ls.end(); s++) 
+    if (not s->empty()) write_Sentence(js,*s);
+  js.end_array();
 }
 
 
@@ -307,31 +421,30 @@ jsn::ordered_json output_json::json_Sentences (const list<sentence> &ls) const {
 // print parse tree
 //--------------------------------------------
 
-jsn::ordered_json output_json::json_Tree (const std::wstring &sid, parse_tree::const_iterator n) const {
+void output_json::write_Tree (json_writer &js, const std::wstring &sid, parse_tree::const_iterator n) const {
 
-  jsn::ordered_json tree;
+  js.begin_object();
   if (n.num_children () == 0) {
-    tree["leaf"] = jsn::json(true);
-    tree["head"] = n->is_head();
-    tree["token"] = jsn::json(util::wstring2string(get_token_id(sid,n->get_word().get_position()+1)));
-    tree["word"] = jsn::json(util::wstring2string(n->get_word().get_form()));
+    js.field(L"leaf", true);
+    js.field(L"head", n->is_head());
+    js.field(L"token", get_token_id(sid,n->get_word().get_position()+1));
+    js.field(L"word", n->get_word().get_form());
   }
   else {
-    tree["leaf"] = jsn::json(false);
-    tree["label"] = jsn::json(util::wstring2string(n->get_label()));
-    tree["head"] = n->is_head();
+    js.field(L"leaf", false);
+    js.field(L"label", n->get_label());
+    js.field(L"head", n->is_head());
     
-    jsn::ordered_json children = json::array();
+    js.key(L"children");
+    js.begin_array();
     parse_tree::const_sibling_iterator d = n.sibling_begin (); 
     while (d != n.sibling_end ()) {
-      children.push_back(json_Tree(sid, d));
+      write_Tree(js, sid, d);
       d++;
     }
-
-    tree["children"] = children;
+    js.end_array();
   }
-
-  return tree;
+  js.end_object();
 }
 
 
@@ -339,26 +452,24 @@ jsn::ordered_json output_json::json_Tree (const std::wstring &sid, parse_tree::c
 // print dependency tree
 //---------------------------------------------
 
-jsn::ordered_json output_json::json_DepTree (const std::wstring &sid, dep_tree::const_iterator n) const {
+void output_json::write_DepTree (json_writer &js, const std::wstring &sid, dep_tree::const_iterator n) const {
 
-  jsn::ordered_json tree;
+  js.begin_object();
   
   if (n.num_children () == 0) {
-    tree["token"] = jsn::json(util::wstring2string(get_token_id(sid,n->get_word().get_position()+1)));
-    tree["function"] = jsn::json(util::wstring2string(n->get_label()));
-    tree["word"] = jsn::json(util::wstring2string(n->get_word().get_form()));
+    js.field(L"token", get_token_id(sid,n->get_word().get_position()+1));
+    js.field(L"function", n->get_label());
+    js.field(L"word", n->get_word().get_form());
   }
   else {
     if (n->get_label()==L"VIRTUAL_ROOT") 
-      tree["token"] = jsn::json("VIRTUAL_ROOT");
+      js.field(L"token", L"VIRTUAL_ROOT");
     else {
-      tree["token"] = jsn::json(util::wstring2string(get_token_id(sid,n->get_word().get_position()+1)));
-      tree["function"] = jsn::json(util::wstring2string(n->get_label()));
-      tree["word"] = jsn::json(util::wstring2string(n->get_word().get_form()));
+      js.field(L"token", get_token_id(sid,n->get_word().get_position()+1));
+      js.field(L"function", n->get_label());
+      js.field(L"word", n->get_word().get_form());
     }
 
-    jsn::ordered_json chld = json::array();
-
     // Sort children. Chunks first, then by their word position.
     // (this is just for aesthetic reasons)
     list<dep_tree::const_sibling_iterator> children;
@@ -367,26 +478,25 @@ jsn::ordered_json output_json::json_DepTree (const std::wstring &sid, dep_tree::
     children.sort(ascending_position);
 
     // print children in the right order
+    js.key(L"children");
+    js.begin_array();
     list<dep_tree::const_sibling_iterator>::const_iterator ch=children.begin();
     while (ch != children.end()) {      
-      chld.push_back(json_DepTree(sid, (*ch)));
+      write_DepTree(js, sid, (*ch));
       ch++;
     }
-
-    tree["children"] = chld;
+    js.end_array();
   }
 
-  return tree;
+  js.end_object();
 }
 
 //---------------------------------------------
 // print predicate-argument structure of the sentence
 //---------------------------------------------
 
-jsn::ordered_json output_json::json_PredArgs(const sentence &s) const {
+void output_json::write_PredArgs(json_writer &js, const sentence &s) const {
 
-  jsn::ordered_json preds = json::array();
-  
   const dep_tree & dt = s.get_dep_tree(s.get_best_seq());
   wstring sid = s.get_sentence_id();
 
@@ -412,53 +522,53 @@ jsn::ordered_json output_json::json_PredArgs(const sentence &s) const {
   }
 
   // print all predicates, referring to entities as their arguments
+  js.begin_array();
   int npred=1;
   for (sentence::predicates::const_iterator pred=s.get_predicates().begin(); 
        pred!=s.get_predicates().end(); 
        pred++) {
 
-    jsn::ordered_json prd;
-    prd["id"] = jsn::json(util::wstring2string(get_token_id(sid,npred,L"P")));
-    prd["head_token"] = jsn::json(util::wstring2string(get_token_id(sid,pred->get_position()+1)));
-    prd["sense"] = jsn::json(util::wstring2string(pred->get_sense()));
-    prd["words"] = jsn::json(util::wstring2string(s[pred->get_position()].get_form()));
+    js.begin_object();
+    js.field(L"id", get_token_id(sid,npred,L"P"));
+    js.field(L"head_token", get_token_id(sid,pred->get_position()+1));
+    js.field(L"sense", pred->get_sense());
+    js.field(L"words", s[pred->get_position()].get_form());
     
     if (not pred->empty()) {
-      jsn::ordered_json args = json::array();
+      js.key(L"arguments");
+      js.begin_array();
       for (predicate::const_iterator a=pred->begin(); a!=pred->end(); a++) {
-	jsn::ordered_json arg;
-	arg["role"] =  jsn::json(util::wstring2string(a->get_role()));
-	arg["words"] =  jsn::json(util::wstring2string(arg_words[a->get_position()]));
-	arg["head_token"] =  jsn::json(util::wstring2string(get_token_id(sid,a->get_position()+1)));
-	arg["from"] =  jsn::json(util::wstring2string(get_token_id(sid,arg_span[a->get_position()].first+1)));
-	arg["to"] =  jsn::json(util::wstring2string(get_token_id(sid,arg_span[a->get_position()].second+1)));	
-	args.push_back(arg);
+        js.begin_object();
+        js.field(L"role", a->get_role());
+        js.field(L"words", arg_words[a->get_position()]);
+        js.field(L"head_token", get_token_id(sid,a->get_position()+1));
+        js.field(L"from", get_token_id(sid,arg_span[a->get_position()].first+1));
+        js.field(L"to", get_token_id(sid,arg_span[a->get_position()].second+1));
+        js.end_object();
       }
-
-      prd["arguments"] = args;
+      js.end_array();
     }
 
-    preds.push_back(prd);
+    js.end_object();
     npred++;
   }
-
-  return preds;
+  js.end_array();
 }
 
 //---------------------------------------------
 // print coreference information of the document
 //---------------------------------------------
 
-jsn::ordered_json output_json::json_Corefs(const document &doc) const {
+void output_json::write_Corefs(json_writer &js, const document &doc) const {
 
-  jsn::ordered_json corefs = json::array();
-  
+  js.begin_array();
   for (list<int>::const_iterator g=doc.get_groups().begin(); g!=doc.get_groups().end(); g++) {
     
-    jsn::ordered_json group;
-    group["id"] = jsn::json("co"+std::to_string(*g+1));
+    js.begin_object();
+    js.field(L"id", L"co"+util::int2wstring(*g+1));
     
-    jsn::ordered_json ments = json::array();
+    js.key(L"mentions");
+    js.begin_array();
     list<int> mentions = doc.get_coref_id_mentions(*g);
     int nm=1;
     for (list<int>::iterator m=mentions.begin(); m!=mentions.end(); m++) {
@@ -471,22 +581,19 @@ jsn::ordered_json output_json::json_Corefs(const document &doc) const {
       for (j=ment.get_pos_begin()+1; j<=ment.get_pos_end(); j++) 
         words = words + L" " + sent[j].get_form();
 
-      jsn::ordered_json mt;
-      mt["id"] = jsn::json("m"+std::to_string(*g+1)+"."+std::to_string(nm));
-      mt["from"] = jsn::json(util::wstring2string(get_token_id(sid,ment.get_pos_begin()+1)));
-      mt["to"] = jsn::json(util::wstring2string(get_token_id(sid,ment.get_pos_end()+1)));
-      mt["words"] = jsn::json(util::wstring2string(words));      
-
-      ments.push_back(mt);
+      js.begin_object();
+      js.field(L"id", L"m"+util::int2wstring(*g+1)+L"."+util::int2wstring(nm));
+      js.field(L"from", get_token_id(sid,ment.get_pos_begin()+1));
+      js.field(L"to", get_token_id(sid,ment.get_pos_end()+1));
+      js.field(L"words", words);
+      js.end_object();
       nm++;
     }
+    js.end_array();
 
-    group["mentions"] = ments;
-
-    corefs.push_back(group);     
+    js.end_object();
   }
-
-  return corefs;
+  js.end_array();
 }
 
 
@@ -495,64 +602,62 @@ jsn::ordered_json output_json::json_Corefs(const document &doc) const {
 // print semantic graph of the document 
 //----------------------------------------------------------
 
-jsn::ordered_json output_json::json_Semgraph(const document &doc) const {
+void output_json::write_Semgraph(json_writer &js, const document &doc) const {
 
-  jsn::ordered_json semgr;
+  js.begin_object();
   
-  jsn::ordered_json entities = json::array();
-  
-  int ne=0;
+  js.key(L"entities");
+  js.begin_array();
   for (vector<semgraph::SG_entity>::const_iterator e=doc.get_semantic_graph().get_entities().begin();
        e!=doc.get_semantic_graph().get_entities().end();
        e++) {
     // skip non NE entities that are not argument to any predicate
     if (not doc.get_semantic_graph().is_argument(e->get_id())) continue;
     
-    jsn::ordered_json entity;
-    entity["id"] = jsn::json(util::wstring2string(e->get_id()));
-    entity["lemma"] = jsn::json(util::wstring2string(e->get_lemma()));
-    if (not e->get_semclass().empty()) entity["class"] = jsn::json(util::wstring2string(e->get_semclass()));
-    if (not e->get_sense().empty()) entity["sense"] = jsn::json(util::wstring2string(e->get_sense()));
+    js.begin_object();
+    js.field(L"id", e->get_id());
+    js.field(L"lemma", e->get_lemma());
+    if (not e->get_semclass().empty()) js.field(L"class", e->get_semclass());
+    if (not e->get_sense().empty()) js.field(L"sense", e->get_sense());
     
-    jsn::ordered_json mentions = json::array();
+    js.key(L"mentions");
+    js.begin_array();
     for (vector<semgraph::SG_mention>::const_iterator m=e->get_mentions().begin(); m!=e->get_mentions().end(); m++) {
-      jsn::ordered_json ment;
-      ment["id"] =  jsn::json(util::wstring2string(get_token_id(m->get_sentence_id(),util::wstring2int(m->get_id())) ));
-      ment["words"] =  jsn::json(util::wstring2string(util::list2wstring(m->get_words(),L" ")));
-      mentions.push_back(ment);
+      js.begin_object();
+      js.field(L"id", get_token_id(m->get_sentence_id(),util::wstring2int(m->get_id())));
+      js.field(L"words", util::list2wstring(m->get_words(),L" "));
+      js.end_object();
     }
-    entity["mentions"] = mentions;
+    js.end_array();
     
     const list<wstring> &syns = e->get_synonyms();
     if (not syns.empty()) {
-      jsn::ordered_json synonyms = json::array();
-      for (list<wstring>::const_iterator s=syns.begin(); s!=syns.end(); ++s) {
-	synonyms.push_back(util::wstring2string(*s));
-      }
-      entity["synonyms"] = synonyms;
+      js.key(L"synonyms");
+      js.begin_array();
+      for (list<wstring>::const_iterator s=syns.begin(); s!=syns.end(); ++s) 
+        js.value(*s);
+      js.end_array();
     }
     
     const list<pair<wstring,wstring> > &uris = e->get_URIs();
     if (not uris.empty()) {
-      jsn::ordered_json urilist = json::array();
+      js.key(L"URIs");
+      js.begin_array();
       for (list<pair<wstring,wstring> >::const_iterator s=uris.begin(); s!=uris.end(); ++s) {
-	jsn::ordered_json uri;
-	uri["knowledgeBase"] = jsn::json(util::wstring2string(s->first));
-	uri["URI"] = jsn::json(util::wstring2string(s->second));
-	urilist.push_back(uri);
+        js.begin_object();
+        js.field(L"knowledgeBase", s->first);
+        js.field(L"URI", s->second);
+        js.end_object();
       }
-      entity["URIs"] = urilist;
+      js.end_array();
     }
     
-    ne++;
-    entities.push_back(entity); 
+    js.end_object();
   }
-  
-  semgr["entities"] = entities;
+  js.end_array();
 
-  jsn::ordered_json frames = json::array();
-    
-  int nf=0;
+  js.key(L"frames");
+  js.begin_array();
   for (vector<semgraph::SG_frame>::const_iterator f=doc.get_semantic_graph().get_frames().begin();
        f!=doc.get_semantic_graph().get_frames().end();
        f++) {
@@ -560,85 +665,115 @@ jsn::ordered_json output_json::json_Semgraph(const document &doc) const {
     // skip argless nominal predicates
     if (not doc.get_semantic_graph().has_arguments(f->get_id())) continue;
 
-    jsn::ordered_json frame;
-    frame["id"] = jsn::json(util::wstring2string( f->get_id()));
-    frame["token"] = jsn::json(util::wstring2string(get_token_id(f->get_sentence_id(),util::wstring2int(f->get_token_id()))));
-    frame["lemma"] = jsn::json(util::wstring2string(f->get_lemma()));
-    frame["sense"] = jsn::json(util::wstring2string(f->get_sense() ));
+    js.begin_object();
+    js.field(L"id", f->get_id());
+    js.field(L"token", get_token_id(f->get_sentence_id(),util::wstring2int(f->get_token_id())));
+    js.field(L"lemma", f->get_lemma());
+    js.field(L"sense", f->get_sense());
 
-    jsn::ordered_json args = json::array();
+    js.key(L"arguments");
+    js.begin_array();
     for (vector<semgraph::SG_argument>::const_iterator a=f->get_arguments().begin(); 
 	 a!=f->get_arguments().end();
 	 a++) {
-      jsn::ordered_json arg;
-      arg["role"] = jsn::json(util::wstring2string(a->get_role()));
-      arg["entity"] = jsn::json(util::wstring2string(a->get_entity()));
-      args.push_back(arg);
+      js.begin_object();
+      js.field(L"role", a->get_role());
+      js.field(L"entity", a->get_entity());
+      js.end_object();
     }
-    frame["arguments"] = args;
+    js.end_array();
     
     const list<wstring> &syns = f->get_synonyms();
     if (not syns.empty()) {
-      jsn::ordered_json synonyms = json::array();
-      for (list<wstring>::const_iterator s=syns.begin(); s!=syns.end(); ++s) {
-	synonyms.push_back(util::wstring2string(*s));
-      }
-      frame["synonyms"] = synonyms;
+      js.key(L"synonyms");
+      js.begin_array();
+      for (list<wstring>::const_iterator s=syns.begin(); s!=syns.end(); ++s) 
+        js.value(*s);
+      js.end_array();
     }
     
     const list<pair<wstring,wstring> > &uris = f->get_URIs();
     if (not uris.empty()) {
-      jsn::ordered_json urilist = json::array();
+      js.key(L"URIs");
+      js.begin_array();
       for (list<pair<wstring,wstring> >::const_iterator s=uris.begin(); s!=uris.end(); ++s) {	
-	jsn::ordered_json uri;
-	uri["knowledgeBase"] = jsn::json(util::wstring2string(s->first));
-	uri["URI"] = jsn::json(util::wstring2string(s->second));
-	urilist.push_back(uri);
+        js.begin_object();
+        js.field(L"knowledgeBase", s->first);
+        js.field(L"URI", s->second);
+        js.end_object();
       }
-      frame["URIs"] = urilist;
+      js.end_array();
     }
     
-    frames.push_back(frame);
-    nf++;
+    js.end_object();
   }
-
-  semgr["frames"] = frames;
+  js.end_array();
   
-  return semgr;
+  js.end_object();
 }
 
 
 //---------------------------------------------
-// get json object for whole document
+// print whole document
 //---------------------------------------------
 
-jsn::ordered_json output_json::json_Document(const document &doc) const {
+void output_json::write_Document(json_writer &js, const document &doc) const {
 
-  jsn::ordered_json tot;  
-  if (doc.empty()) return tot;
+  js.begin_object();
 
-  jsn::ordered_json pars = json::array();
+  js.key(L"paragraphs");
+  js.begin_array();
   for (document::const_iterator p=doc.begin(); p!=doc.end(); p++) {
-    jsn::ordered_json par;
-    par["sentences"] = json_Sentences(*p);
-    pars.push_back(par);
+    js.begin_object();
+    js.key(L"sentences");
+    write_Sentences(js,*p);
+    js.end_object();
   }
-  tot["paragraphs"] = pars;
+  js.end_array();
   
   if (doc.get_num_groups()>0) {
     // there are coreferences, print them
-    tot["coreferences"] = json_Corefs(doc);
+    js.key(L"coreferences");
+    write_Corefs(js,doc);
   }
   
   // print semantic graph if there is one
   if (not doc.get_semantic_graph().empty()) {
-    tot["semantic_graph"] = json_Semgraph(doc);
+    js.key(L"semantic_graph");
+    write_Semgraph(js,doc);
   }
 
-  return tot;
+  js.end_object();
 }
 
 
+//---------------------------------------------
+// get json object for sentence list
+//---------------------------------------------
+
+jsn::ordered_json output_json::json_Sentences (const list<sentence> &ls) const {
+
+  wostringstream sout;
+  json_writer js(sout,-1);
+  write_Sentences(js,ls);
+  return jsn::ordered_json::parse(util::wstring2string(sout.str()));
+}
+
+
+//---------------------------------------------
+// get json object for whole document
+//---------------------------------------------
+
+jsn::ordered_json output_json::json_Document(const document &doc) const {
+
+  if (doc.empty()) return jsn::ordered_json();
+
+  wostringstream sout;
+  json_writer js(sout,-1);
+  write_Document(js,doc);
+  return jsn::ordered_json::parse(util::wstring2string(sout.str()));
+}
+
 
 //---------------------------------------------
 // print obtained analysis in json
@@ -648,9 +783,20 @@ void output_json::PrintResults (wostream &sout, const list<sentence> &ls) const
 
   if (ls.empty()) return;
   
-  jsn::ordered_json sents = json_Sentences(ls);
-  sout << util::string2wstring(sents.dump(3)) << endl;
-
+  if (JsonLines) {
+    // one compact json object per line, one line per sentence
+    json_writer js(sout,-1);
+    for (list<sentence>::const_iterator s=ls.begin(); s!=ls.end(); s++) {
+      if (s->empty()) continue;
+      write_Sentence(js,*s);
+      sout << endl;
+    }
+  }
+  else {
+    json_writer js(sout,3);
+    write_Sentences(js,ls);
+    sout << endl;
+  }
 }
 
 
@@ -662,9 +808,7 @@ void output_json::PrintResults(wostream &sout, const document &doc) const {
 
   if (doc.empty()) return;
 
-  jsn::ordered_json res = json_Document(doc);  
-  sout << util::string2wstring(res.dump(3)) << endl;
+  json_writer js(sout, JsonLines ? -1 : 3);
+  write_Document(js,doc);
+  sout << endl;
 }
-
-
-
@@ -41,6 +41,9 @@
 #define MOD_TRACENAME L"PHONETICS"
 #define MOD_TRACECODE PHONETICS_TRACE
 
+/// maximum number of words kept in the cache of each ruleset
+#define PH_CACHE_SIZE 50000
+
 using namespace std;
 
 namespace freeling {
@@ -89,7 +92,7 @@ namespace freeling {
         if (cfg.at_section_start()) { 
           // starting new <Rules> section, create new ruleset
           RuleSets.push_back(rule_set());
-          Cache.push_back(new safe_map<wstring,wstring>());
+          Cache.push_back(new lru_cache<wstring,wstring>(PH_CACHE_SIZE));
         }
 
         // add rule to current rule set
@@ -128,7 +131,7 @@ namespace freeling {
   ///////////////////////////////////////////////////////////////
 
   phonetics::~phonetics() {
-    vector<safe_map<wstring,wstring>*>::iterator p;
+    vector<lru_cache<wstring,wstring>*>::iterator p;
     for (p=Cache.begin(); p!=Cache.end(); p++) delete (*p);
   }
 
@@ -188,6 +191,16 @@ namespace freeling {
     newrule.env.replace(e,1,L"("+newrule.from+L")");
     newrule.re_env = freeling::regexp(newrule.env);
 
+    // Find out what must be in a word for the rule to match, so the regexp
+    // is not run on words that can not match. Give up if "from" contains 
+    // regexp syntax (the rule is then always tried).
+    if (newrule.from[0]==L'[') {
+      wstring chars = newrule.from.substr(1,newrule.from.size()-2);
+      if (chars.find_first_of(L"[]^-\\")==wstring::npos) newrule.trigger = chars;
+    }
+    else if (newrule.from.find_first_of(L"\\^$.|?*+()[]{}")==wstring::npos)
+      newrule.trigger = newrule.from;
+
     TRACE(4,L"Loaded rule ("+newrule.from+L","+newrule.to+L","+newrule.env+L")");
     // store the resulting rule.
     RuleSets[rs].Rules.push_back(newrule);
@@ -224,13 +237,14 @@ namespace freeling {
           sound = ch;
         }
         else {  // word not in cache. Compute sound and store it in the cache
+          wstring input = sound;
           vector<ph_rule>::const_iterator r;
           for (r=RuleSets[rs].Rules.begin(); r!=RuleSets[rs].Rules.end(); r++) {
             TRACE(4,L"Appling rule ("+r->from+L"/"+r->to+L"/"+r->env+L") to word '"+word+L"'");
             apply_rule(*r,sound);
             TRACE(4,L"  result: "+sound);
           }
-          Cache[rs]->insert_safe(word,sound);
+          Cache[rs]->insert_safe(input,sound);
         }
         TRACE(4,L"End rule set application");
       }
@@ -250,6 +264,13 @@ namespace freeling {
   
     if (rul.from==rul.to) return;  // nothing to do.
 
+    // skip rules that can not match this text
+    if (not rul.trigger.empty()) {
+      if (rul.from[0]==L'[' ? text.find_first_of(rul.trigger)==wstring::npos 
+                            : text.find(rul.trigger)==wstring::npos) 
+        return;
+    }
+
     vector<wstring> mch;
     vector<int> pos;
 
@@ -29,6 +29,7 @@
 #include <fstream>
 #include <sstream>
 #include <set>
+#include <algorithm>
 
 #include "freeling/morfo/configfile.h"
 #include "freeling/morfo/probabilities.h"
@@ -81,6 +82,8 @@ namespace freeling {
     wstring ftags;
     double sumUnk=0; double sumSing=0;
     long_suff=0;
+    suff_nodes.push_back(suffix_node());  // trie root
+    suff_nodes[0].present = false;
     wstring line;
     while (cfg.get_content_line(line)) {
     
@@ -167,7 +170,7 @@ namespace freeling {
           double probab=util::wstring2double(frq)/count;
           temp_map.insert(make_pair(tag,probab));
         }
-        unk_suffs.insert(make_pair(key,temp_map));
+        add_suffix(key,temp_map);
         break;
       } 
 
@@ -381,9 +384,11 @@ namespace freeling {
       double norm=0;
       double* p = new double[w.size()];
       int i=0;
+      vector<int> path;
+      suffix_path(w.get_form(), path);
       for (word::iterator li=w.begin(); li!=w.end(); li++) {
         // suffix-based prob
-        p[i] = compute_probability(li->get_tag(), li->get_prob(), w.get_form());
+        p[i] = compute_probability(li->get_tag(), li->get_prob(), path);
         norm += p[i];
         i++;
       }
@@ -402,37 +407,73 @@ namespace freeling {
 
 
   /////////////////////////////////////////////////////////////////////////////
-  /// Compute probability of a tag given a word suffix.
+  /// Add a suffix to the suffix trie. The trie is built on reversed 
+  /// suffixes, so all suffixes of a word are found in one walk from its end.
   /////////////////////////////////////////////////////////////////////////////
 
-  double probabilities::compute_probability(const std::wstring &tag, double prob, const std::wstring &s) const {
-    map<wstring,map<wstring,double> >::const_iterator is;
-    map<wstring,double>::const_iterator it;
+  void probabilities::add_suffix(const wstring &suf, const map<wstring,double> &tags) {
+    int node=0;
+    for (wstring::const_reverse_iterator c=suf.rbegin(); c!=suf.rend(); c++) {
+      unsigned long long key = ((unsigned long long)node<<32) | (unsigned int)(*c);
+      unordered_map<unsigned long long,int>::const_iterator t = suff_trans.find(key);
+      if (t!=suff_trans.end()) node = t->second;
+      else {
+        suff_nodes.push_back(suffix_node());
+        suff_nodes.back().present = false;
+        suff_trans.insert(make_pair(key, suff_nodes.size()-1));
+        node = suff_nodes.size()-1;
+      }
+    }
+
+    // if suffix was repeated in the file, keep first occurrence
+    if (suff_nodes[node].present) return;
+    suff_nodes[node].present = true;
+
+    for (map<wstring,double>::const_iterator t=tags.begin(); t!=tags.end(); t++) {
+      map<wstring,int>::const_iterator id = suff_tags.insert(make_pair(t->first,(int)suff_tags.size())).first;
+      suff_nodes[node].probs.push_back(make_pair(id->second,t->second));
+    }
+    sort(suff_nodes[node].probs.begin(), suff_nodes[node].probs.end());
+  }
+
+  /////////////////////////////////////////////////////////////////////////////
+  /// Get trie nodes for the suffixes of given word, shortest first, 
+  /// stopping at the first suffix not in the model.
+  /////////////////////////////////////////////////////////////////////////////
+
+  void probabilities::suffix_path(const wstring &s, vector<int> &path) const {
+    path.clear();
+    int node=0;
+    for (wstring::const_reverse_iterator c=s.rbegin(); c!=s.rend(); c++) {
+      unordered_map<unsigned long long,int>::const_iterator t = suff_trans.find(((unsigned long long)node<<32) | (unsigned int)(*c));
+      if (t==suff_trans.end() or not suff_nodes[t->second].present) break;
+      node = t->second;
+      path.push_back(node);
+    }
+  }
+
+  /////////////////////////////////////////////////////////////////////////////
+  /// Compute probability of a tag given the suffixes of a word 
+  /// (as obtained by suffix_path)
+  /////////////////////////////////////////////////////////////////////////////
+
+  double probabilities::compute_probability(const std::wstring &tag, double prob, const vector<int> &path) const {
     double x,pt;
 
     x=prob;  
-    int spos=s.size();
-    bool found=true;
+    map<wstring,int>::const_iterator id = suff_tags.find(tag);
 
     TRACE(4,L" suffixes. Tag "+tag+L" initial prob="+util::double2wstring(x));
-    while (spos>0 && found) {
-      spos--;
-      // get tag probability list for current suffix
-      is = unk_suffs.find(s.substr(spos));
-      found = (is != unk_suffs.end());
-      if (found) {
-        // search tag in suffix probability list. 
-        it = (is->second).find(tag);
-        if (it != (is->second).end()) {
-          pt = it->second;
-          TRACE(4,L"       found prob for sufix -"+s.substr(spos));
-        }
-        else {
-          pt = 0;
-          TRACE(4,L"       NO prob found for sufix -"+s.substr(spos));
-        }
-        x = (pt+theeta*x)/(1+theeta);
+    for (vector<int>::const_iterator n=path.begin(); n!=path.end(); n++) {
+      // search tag in suffix probability list. 
+      pt = 0;
+      if (id!=suff_tags.end()) {
+        const vector<pair<int,double> > &pr = suff_nodes[*n].probs;
+        vector<pair<int,double> >::const_iterator it = lower_bound(pr.begin(), pr.end(), make_pair(id->second,-1.0));
+        if (it!=pr.end() and it->first==id->second) pt = it->second;
       }
+      TRACE(4,L"       "+wstring(pt>0 ? L"found" : L"NO")+L" prob for sufix of length "+util::int2wstring(n-path.begin()+1));
+      x = (pt+theeta*x)/(1+theeta);
     }
     TRACE(4,L"             final prob="+util::double2wstring(x));
     return x;
@@ -451,6 +492,9 @@ namespace freeling {
     TRACE(2,L"Applying guesser");
 
     wstring form=w.get_lc_form();
+    // get suffixes of the word in the model
+    vector<int> path;
+    suffix_path(form, path);
   
     // mass = mass assigned so far.  This gives some more probability to the 
     // preassigned tags than to those computed from suffixes.
@@ -476,7 +520,7 @@ namespace freeling {
     
       // if we don't have it, consider including it in the list
       if (!hasit) {      
-        double p = compute_probability(t->first,t->second,form);
+        double p = compute_probability(t->first,t->second,path);
         a.init(form,t->first);
         a.set_prob(p);
       
@@ -33,6 +33,7 @@
 #include "freeling/regexp.h"
 #include <locale>
 #include <iostream>
+#include <stdexcept>
 
 using namespace std;
 
@@ -52,7 +53,7 @@ namespace freeling {
   /// Constructor
   ///////////////////////////////////////////////
 
-  regexp::regexp (const wstring &expr, bool icase) {
+  regexp::regexp (const wstring &expr, bool icase) : expression(expr), warned(false) {
 #if defined USE_XPRESSIVE_REGEX
     /// Some people might want to use boost::xpressive instead of boost::regex
     try {
@@ -84,7 +85,20 @@ namespace freeling {
   /// Copy constructor
   ///////////////////////////////////////////////
 
-  regexp::regexp (const regexp &r) : re(r.re) {}
+  regexp::regexp (const regexp &r) : re(r.re), expression(r.expression), warned(false) {}
+
+  ///////////////////////////////////////////////
+  /// Assignment
+  ///////////////////////////////////////////////
+
+  regexp& regexp::operator=(const regexp &r) {
+    if (this!=&r) {
+      re = r.re;
+      expression = r.expression;
+      warned = false;
+    }
+    return *this;
+  }
 
   ///////////////////////////////////////////////
   /// Destructor 
@@ -92,15 +106,62 @@ namespace freeling {
 
   regexp::~regexp () {}
 
+  ///////////////////////////////////////////////
+  /// get source expression
+  ///////////////////////////////////////////////
+
+  const wstring & regexp::get_expression() const { return expression; }
+
+  ///////////////////////////////////////////////
+  /// private function: report that the engine complexity bounds were
+  /// exceeded. Only the first time for each expression, so that hostile
+  /// input can not flood the log.
+  ///////////////////////////////////////////////
+
+  void regexp::complexity_exceeded() const {
+    if (not warned.exchange(true))
+      wcerr << L"Warning: matching complexity exceeded, no match assumed for regular expression: " << expression 
+            << L" (further occurrences not reported)" << endl;
+  }
+
+  ///////////////////////////////////////////////
+  /// private function: call the engine to search. Both engines
+  /// throw a runtime_error when a backtracking search exceeds their
+  /// complexity bounds. Consider it a failed match rather than
+  /// letting a pathological input abort the whole analysis.
+  ///////////////////////////////////////////////
+
+  bool regexp::run_search(wstring::const_iterator i1, wstring::const_iterator i2, match_type &what, bool continuous) const {
+    try {
+      return (continuous ? SEARCH(i1,i2,what,re,CONTINUOUS) : SEARCH(i1,i2,what,re));
+    }
+    catch (const std::runtime_error &e) {
+      complexity_exceeded();
+      return false;
+    }
+  }
+
+  ///////////////////////////////////////////////
+  /// private function: call the engine to match whole string.
+  ///////////////////////////////////////////////
+
+  bool regexp::run_match(wstring::const_iterator i1, wstring::const_iterator i2, match_type &what) const {
+    try {
+      return MATCH(i1,i2,what,re);
+    }
+    catch (const std::runtime_error &e) {
+      complexity_exceeded();
+      return false;
+    }
+  }
+
   ///////////////////////////////////////////////
   /// Search for a partial match in a string
   ///////////////////////////////////////////////
 
   bool regexp::search(const wstring &in, bool continuous) const {
-    if (continuous) 
-      return SEARCH(in.begin(), in.end(), re, CONTINUOUS);
-    else 
-      return SEARCH(in.begin(), in.end(), re);
+    match_type what;
+    return run_search(in.begin(), in.end(), what, continuous);
   }
 
   ///////////////////////////////////////////////
@@ -130,9 +191,7 @@ namespace freeling {
     match_type what;
     out.clear();
 
-    bool ok =  (continuous ? SEARCH(i1,i2,what,re,CONTINUOUS)
-                : SEARCH(i1,i2,what,re));
-
+    bool ok = run_search(i1,i2,what,continuous);
     if (ok) extract_matches(what,out);
     return ok;
   }
@@ -147,20 +206,46 @@ namespace freeling {
     out.clear();
     pos.clear();
 
-    bool ok = (continuous ? SEARCH(i1,i2,what,re,CONTINUOUS) 
-               : SEARCH(i1,i2,what,re));
-
+    bool ok = run_search(i1,i2,what,continuous);
     if (ok) extract_matches(what,out,pos);
     return ok;
   }
 
+  ///////////////////////////////////////////////
+  /// Search for a partial match in a string, return sub match spans
+  ///////////////////////////////////////////////
+
+  bool regexp::search (const wstring &in, vector<span> &out, bool continuous) const {
+    match_type what;
+    out.clear();
+
+    bool ok = run_search(in.begin(),in.end(),what,continuous);
+    if (ok) extract_matches(what,out);
+    return ok;
+  }
+
+  ///////////////////////////////////////////////
+  /// Search for a partial match in a string, return sub match spans
+  /// (positions are relative to i1)
+  ///////////////////////////////////////////////
+
+  bool regexp::search (wstring::const_iterator i1, wstring::const_iterator i2, 
+                       vector<span> &out, bool continuous) const {
+    match_type what;
+    out.clear();
+
+    bool ok = run_search(i1,i2,what,continuous);
+    if (ok) extract_matches(what,out);
+    return ok;
+  }
 
   ///////////////////////////////////////////////
   /// Search for a whole match in a string
   ///////////////////////////////////////////////
 
   bool regexp::match(const wstring &in) const {
-    return MATCH(in.begin(),in.end(),re);
+    match_type what;
+    return run_match(in.begin(),in.end(),what);
   }
 
   ///////////////////////////////////////////////
@@ -172,7 +257,21 @@ namespace freeling {
     match_type what;
     out.clear();
 
-    bool ok = MATCH(in.begin(),in.end(),what,re);
+    bool ok = run_match(in.begin(),in.end(),what);
+    if (ok) extract_matches(what,out);
+    return ok;
+  }
+
+  ///////////////////////////////////////////////
+  /// Search for a whole match in a string, return sub match spans
+  ///////////////////////////////////////////////
+
+  bool regexp::match(const wstring &in, vector<span> &out) const {
+
+    match_type what;
+    out.clear();
+
+    bool ok = run_match(in.begin(),in.end(),what);
     if (ok) extract_matches(what,out);
     return ok;
   }
@@ -198,4 +297,290 @@ namespace freeling {
     }
   }
 
+  ///////////////////////////////////////////////
+  /// private function: convert internal match list to vector<span>
+  ///////////////////////////////////////////////
+
+  void regexp::extract_matches(const match_type &what, vector<span> &out) const {
+    for (size_t i=0; i<what.size(); ++i) {
+      if (what[i].matched) out.push_back(span(what.position(i), what.length(i)));
+      else out.push_back(span(-1,0));
+    }
+  }
+
+
+  ///////////////////////////////////////////////
+  /// Constructor of an empty set
+  ///////////////////////////////////////////////
+
+  regexp_set::regexp_set() : linked(true) {
+    children.push_back(vector<pair<wchar_t,int> >());
+    ending.push_back(vector<int>());
+    fail.push_back(0);
+    found.push_back(vector<int>());
+  }
+
+  ///////////////////////////////////////////////
+  /// Destructor
+  ///////////////////////////////////////////////
+
+  regexp_set::~regexp_set() {}
+
+  ///////////////////////////////////////////////
+  /// Add an expression to the set, return its identifier
+  ///////////////////////////////////////////////
+
+  int regexp_set::add(const wstring &expr, bool icase) {
+    int id = exprs.size();
+    exprs.push_back(regexp(expr,icase));
+
+    wstring lit = required_literal(expr,icase);
+    if (lit.empty()) {
+      unfiltered.push_back(id);
+      return id;
+    }
+
+    // insert literal in the automaton
+    int node=0;
+    for (size_t i=0; i<lit.size(); i++) {
+      unsigned long long t = ((unsigned long long)node<<32) | (unsigned int)lit[i];
+      unordered_map<unsigned long long,int>::const_iterator p=trans.find(t);
+      if (p!=trans.end()) node=p->second;
+      else {
+        int n = children.size();
+        children.push_back(vector<pair<wchar_t,int> >());
+        ending.push_back(vector<int>());
+        children[node].push_back(make_pair(lit[i],n));
+        trans.insert(make_pair(t,n));
+        node=n;
+      }
+    }
+    ending[node].push_back(id);
+
+    // links are rebuilt when the set is next searched
+    linked = false;
+    return id;
+  }
+
+  ///////////////////////////////////////////////
+  /// Number of expressions in the set
+  ///////////////////////////////////////////////
+
+  size_t regexp_set::size() const { return exprs.size(); }
+
+  ///////////////////////////////////////////////
+  /// Get expression with given identifier
+  ///////////////////////////////////////////////
+
+  const regexp & regexp_set::get(int id) const { return exprs[id]; }
+
+  ///////////////////////////////////////////////
+  /// Recompute failure links (breadth first) and the expressions
+  /// recognized at each node of the automaton, unless they are 
+  /// up to date. Safe to call from concurrent searches.
+  ///////////////////////////////////////////////
+
+  void regexp_set::build_links() const {
+    if (linked) return;
+    boost::mutex::scoped_lock lock(link_sem);
+    if (linked) return;
+
+    size_t n=children.size();
+    fail.assign(n,0);
+    found.assign(n,vector<int>());
+    found[0]=ending[0];
+
+    vector<int> queue;
+    queue.push_back(0);
+    for (size_t q=0; q<queue.size(); q++) {
+      int u=queue[q];
+      for (size_t k=0; k<children[u].size(); k++) {
+        wchar_t c=children[u][k].first;
+        int v=children[u][k].second;
+        if (u!=0) {
+          // longest proper suffix of v's string that is also in the automaton
+          int f=fail[u];
+          while (f!=0 and trans.find(((unsigned long long)f<<32)|(unsigned int)c)==trans.end()) f=fail[f];
+          unordered_map<unsigned long long,int>::const_iterator p=trans.find(((unsigned long long)f<<32)|(unsigned int)c);
+          fail[v] = (p!=trans.end() ? p->second : 0);
+        }
+        found[v]=ending[v];
+        found[v].insert(found[v].end(), found[fail[v]].begin(), found[fail[v]].end());
+        queue.push_back(v);
+      }
+    }
+    linked = true;
+  }
+
+  ///////////////////////////////////////////////
+  /// Mark expressions that may match the string: those whose
+  /// literal occurs in it, plus those without literal.
+  ///////////////////////////////////////////////
+
+  void regexp_set::candidates(const wstring &in, vector<bool> &cand) const {
+    build_links();
+
+    cand.assign(exprs.size(),false);
+    for (size_t i=0; i<unfiltered.size(); i++) cand[unfiltered[i]]=true;
+
+    int node=0;
+    for (wstring::const_iterator c=in.begin(); c!=in.end(); c++) {
+      unordered_map<unsigned long long,int>::const_iterator p;
+      while ((p=trans.find(((unsigned long long)node<<32)|(unsigned int)(*c)))==trans.end() and node!=0) 
+        node=fail[node];
+      if (p!=trans.end()) node=p->second;
+      for (size_t k=0; k<found[node].size(); k++) cand[found[node][k]]=true;
+    }
+  }
+
+  ///////////////////////////////////////////////
+  /// Find the first expression that matches the whole string
+  ///////////////////////////////////////////////
+
+  int regexp_set::match_first(const wstring &in, vector<wstring> &out) const {
+    vector<bool> cand;
+    candidates(in,cand);
+    for (size_t i=0; i<exprs.size(); i++) 
+      if (cand[i] and exprs[i].match(in,out)) return i;
+    out.clear();
+    return -1;
+  }
+
+  ///////////////////////////////////////////////
+  /// Find all expressions with a partial match in the string
+  ///////////////////////////////////////////////
+
+  void regexp_set::search_all(const wstring &in, vector<int> &ids) const {
+    vector<bool> cand;
+    candidates(in,cand);
+    ids.clear();
+    for (size_t i=0; i<exprs.size(); i++) 
+      if (cand[i] and exprs[i].search(in)) ids.push_back(i);
+  }
+
+  ///////////////////////////////////////////////
+  /// Find the longest literal that any match of the expression
+  /// must contain. Only literals outside groups are considered,
+  /// and any construct not understood makes it give up (returning
+  /// an empty string, which means the expression is always checked).
+  ///////////////////////////////////////////////
+
+  wstring regexp_set::required_literal(const wstring &expr, bool icase) {
+    // case-insensitive literals can not be located by exact search
+    if (icase) return L"";
+
+    wstring best, run;
+    int depth=0;
+    bool last_lit=false;  // whether last atom was a literal char in current run
+    size_t i=0;
+    while (i<expr.size()) {
+      wchar_t c=expr[i];
+
+      if (c==L'\\') {
+        if (i+1>=expr.size()) return L"";
+        wchar_t e=expr[i+1];
+        if (not iswalnum(e) and e!=L'_') {
+          // escaped symbol, it is a literal char
+          if (depth==0) { run.push_back(e); last_lit=true; }
+          else { run.clear(); last_lit=false; }
+          i+=2;
+        }
+        else if (e==L'Q' or e==L'E' or iswdigit(e)) return L"";  // quoting, backrefs: give up
+        else {
+          // character class escape (\d, \w, \p{..}, \x{..}, ...)
+          if (run.size()>best.size()) best=run;
+          run.clear(); last_lit=false;
+          i+=2;
+          if (i<expr.size() and expr[i]==L'{') {
+            size_t k=expr.find(L'}',i);
+            if (k==wstring::npos) return L"";
+            i=k+1;
+          }
+        }
+      }
+
+      else if (c==L'[') {
+        // skip bracket expression, including nested [:class:] items
+        if (run.size()>best.size()) best=run;
+        run.clear(); last_lit=false;
+        size_t k=i+1;
+        if (k<expr.size() and expr[k]==L'^') k++;
+        if (k<expr.size() and expr[k]==L']') k++;
+        while (k<expr.size() and expr[k]!=L']') {
+          if (expr[k]==L'\\') k+=2;
+          else if (expr[k]==L'[' and k+1<expr.size() and (expr[k+1]==L':' or expr[k+1]==L'=' or expr[k+1]==L'.')) {
+            size_t e=expr.find(wstring(1,expr[k+1])+L"]",k+2);
+            if (e==wstring::npos) return L"";
+            k=e+2;
+          }
+          else k++;
+        }
+        if (k>=expr.size()) return L"";
+        i=k+1;
+      }
+
+      else if (c==L'(') {
+        // inline modifiers may change case sensitivity or syntax: give up
+        if (i+1<expr.size() and expr[i+1]==L'?' and i+2<expr.size() 
+            and expr[i+2]!=L':' and expr[i+2]!=L'=' and expr[i+2]!=L'!' and expr[i+2]!=L'<')
+          return L"";
+        if (run.size()>best.size()) best=run;
+        run.clear(); last_lit=false;
+        depth++;
+        i++;
+      }
+
+      else if (c==L')') {
+        if (depth==0) return L"";
+        depth--;
+        run.clear(); last_lit=false;
+        i++;
+      }
+
+      else if (c==L'|') {
+        // top level alternative: nothing is required
+        if (depth==0) return L"";
+        run.clear(); last_lit=false;
+        i++;
+      }
+
+      else if (c==L'*' or c==L'?' or c==L'{') {
+        // previous atom may be absent (or repeated): it can not be part of the literal
+        if (last_lit) run.erase(run.size()-1);
+        if (run.size()>best.size()) best=run;
+        run.clear(); last_lit=false;
+        if (c==L'{') {
+          size_t k=expr.find(L'}',i);
+          if (k==wstring::npos) return L"";
+          i=k+1;
+        }
+        else i++;
+      }
+
+      else if (c==L'+') {
+        // previous atom is required, but the literal can not extend over the repetition
+        if (run.size()>best.size()) best=run;
+        run.clear(); last_lit=false;
+        i++;
+      }
+
+      else if (c==L'.' or c==L'^' or c==L'$') {
+        if (run.size()>best.size()) best=run;
+        run.clear(); last_lit=false;
+        i++;
+      }
+
+      else {
+        // plain char
+        if (depth==0) { run.push_back(c); last_lit=true; }
+        else { run.clear(); last_lit=false; }
+        i++;
+      }
+    }
+
+    if (depth!=0) return L"";
+    if (run.size()>best.size()) best=run;
+    return best;
+  }
+
 }
@@ -28,6 +28,8 @@
 
 #include <sstream>
 #include <fstream>
+#include <atomic>
+#include <functional>
 
 #include "freeling/morfo/traces.h"
 #include "freeling/morfo/util.h"
@@ -41,6 +43,27 @@ namespace freeling {
 #define MOD_TRACENAME L"SEMDB"
 #define MOD_TRACECODE SENSES_TRACE
 
+  /// number of entries in the per-thread memo of get_word_senses results
+#define SENSES_MEMO_SIZE 4096
+
+  /// entry in the memo of get_word_senses results
+  class senses_memo_entry {
+  public:
+    /// semanticDB instance that computed the result (0 = empty entry)
+    unsigned long instance;
+    /// lookup key
+    wstring form, lemma, pos;
+    /// result
+    list<wstring> senses;
+
+    senses_memo_entry() : instance(0) {}
+  };
+
+  /// recent lookups done by current thread, direct-mapped on key hash.
+  static thread_local vector<senses_memo_entry> senses_memo(SENSES_MEMO_SIZE);
+  /// counter to assign a unique id to each semanticDB instance
+  static atomic<unsigned long> semdb_instances(0);
+
 
   ///////////////////////////////////////////////////////////////
   ///  Constructor of the auxiliary class "sense_info"
@@ -91,6 +114,8 @@ namespace freeling {
 
     // store PoS appearing in mapping to select relevant dictionary entries later.
     set<wstring> posset;
+    form_in_key = false;
+    instance = ++semdb_instances;
 
     enum sections {WN_POS_MAP, DATA_FILES};
     config_file cfg(true);  
@@ -112,7 +137,9 @@ namespace freeling {
         posmaprule r;   // read and store a posmap rule, eg: "VMP v (VMP00SM)"  or  "N n L"
         sin>>r.pos>>r.wnpos>>r.lemma;
         posmap.push_back(r); 
-        if (r.lemma!=L"L" and r.lemma!=L"F") 
+        if (r.lemma==L"F") 
+          form_in_key = true;
+        else if (r.lemma!=L"L") 
           posset.insert(r.lemma);
         break;
       }
@@ -173,11 +200,20 @@ namespace freeling {
         wstring sens;
         sin>>sens;
         wstring tag= sens.substr(sens.find(L"-")+1);
-        // get words for current sense. Store both sense->words and word->sense records
+        // intern sense code
+        int sid = sense_codes.size();
+        sense_codes.push_back(sens);
+        // get words for current sense. Store sense->words records in
+        // the database, and word->sense records in the compiled index
         wstring wd; 
         while (sin>>wd) {
           sensesdb->add_database(L"S:"+sens,wd);
-          sensesdb->add_database(L"W:"+wd+L":"+tag, sens);
+
+          vector<pair<wstring,vector<int> > > &ws = word_senses[wd];
+          vector<pair<wstring,vector<int> > >::iterator p;
+          for (p=ws.begin(); p!=ws.end() and p->first!=tag; p++);
+          if (p==ws.end()) p = ws.insert(ws.end(), make_pair(tag,vector<int>()));
+          p->second.push_back(sid);
         }
       }
       fsens.close();
@@ -208,6 +244,14 @@ namespace freeling {
 
   list<wstring> semanticDB::get_word_senses(const wstring &form, const wstring &lemma, const wstring &pos) const {
 
+    // check whether this thread looked up the same word recently
+    hash<wstring> hs;
+    size_t h = hs(lemma)*31 + hs(pos);
+    if (form_in_key) h = h*31 + hs(form);
+    senses_memo_entry &m = senses_memo[(h^instance) % SENSES_MEMO_SIZE];
+    if (m.instance==instance and m.lemma==lemma and m.pos==pos and (not form_in_key or m.form==form)) 
+      return m.senses;
+
     // get pairs (lemma,pos) to search in WN for this analysis
     list<pair<wstring,wstring> > searchlist;
     get_WN_keys(form, lemma, pos, searchlist);
@@ -217,16 +261,39 @@ namespace freeling {
     list<pair<wstring,wstring> >::iterator p;
     for (p=searchlist.begin(); p!=searchlist.end(); p++) {
       TRACE(4,L" .. searching "+p->first+L" "+p->second);
-      list<wstring> s = util::wstring2list(sensesdb->access_database(L"W:"+p->first+L":"+p->second), L" ");
-      lsen.insert(lsen.end(),s.begin(),s.end());
+      lookup_senses(p->first, p->second, lsen);
     }
     if (not lsen.empty()) {
       TRACE(4,L" .. senses found: "+util::list2wstring(lsen,L"/"));
     }
 
+    // remember result
+    m.instance = instance;
+    m.lemma = lemma;
+    m.pos = pos;
+    m.form = (form_in_key ? form : L"");
+    m.senses = lsen;
+
     return lsen;
   }
 
+  ///////////////////////////////////////////////////////////////
+  ///  Append senses for given lemma and WN PoS to given list
+  ///////////////////////////////////////////////////////////////  
+
+  void semanticDB::lookup_senses(const wstring &lemma, const wstring &wnpos, list<wstring> &lsen) const {
+    unordered_map<wstring,vector<pair<wstring,vector<int> > > >::const_iterator w = word_senses.find(lemma);
+    if (w==word_senses.end()) return;
+
+    for (vector<pair<wstring,vector<int> > >::const_iterator p=w->second.begin(); p!=w->second.end(); p++) {
+      if (p->first==wnpos) {
+        for (vector<int>::const_iterator s=p->second.begin(); s!=p->second.end(); s++)
+          lsen.push_back(sense_codes[*s]);
+        return;
+      }
+    }
+  }
+
 
   ///////////////////////////////////////////////////////////////
   ///  Get synonyms for a sense+pos
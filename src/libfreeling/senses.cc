@@ -46,7 +46,7 @@ namespace freeling {
   ///  Create the sense annotator
   ///////////////////////////////////////////////////////////////
 
-  senses::senses(const wstring & wsdFile) {
+  senses::senses(const wstring & wsdFile) : warned(false) {
  
     duplicate = false;
     semdb = new semanticDB(wsdFile);
@@ -91,6 +91,28 @@ namespace freeling {
   ///////////////////////////////////////////////////////////////  
 
   void senses::analyze(sentence &s) const {
+    annotate(s, duplicate);
+  }
+
+  ///////////////////////////////////////////////////////////////
+  ///  Analyze given sentences with given options. Taggers and 
+  ///  later modules expect a single analysis per lemma and tag,
+  ///  so DuplicateAnalysis is ignored beyond MORFO level.
+  ///////////////////////////////////////////////////////////////  
+
+  void senses::analyze(sentence &s, const analyzer_invoke_options &opt) const {
+    if (duplicate and opt.OutputLevel>=TAGGED and not warned.exchange(true))
+      WARNING(L"DuplicateAnalysis option ignored due to selected OutputLevel>=TAGGED.");
+
+    annotate(s, duplicate and opt.OutputLevel<TAGGED);
+  }
+
+  ///////////////////////////////////////////////////////////////
+  ///  Annotate senses in given sentence, duplicating analysis
+  ///  for each sense if requested.
+  ///////////////////////////////////////////////////////////////  
+
+  void senses::annotate(sentence &s, bool duplicate) const {
     list<wstring> lsen;  
 
     // anotate with all possible senses, no disambiguation
@@ -199,6 +199,25 @@ void srl_treeler::analyze(freeling::sentence &s) const {
 
 
 
+///////////////////////////////////////////////////////////////
+/// Enrich given sentences with semantic roles. Sentences are
+/// independent, so they are spread over the parallel_for pool
+/// threads (or analyzed in turn if called from a worker thread).
+///////////////////////////////////////////////////////////////
+
+void srl_treeler::analyze(list<freeling::sentence> &ls) const {
+
+  metrics::probe p(typeid(*this));
+  vector<freeling::sentence*> vs;
+  vs.reserve(ls.size());
+  for (list<freeling::sentence>::iterator s=ls.begin(); s!=ls.end(); s++) 
+    vs.push_back(&(*s));
+
+  util::parallel_for(0, vs.size(), [&](size_t i) { analyze(*vs[i]); });
+  p.count(ls);
+}
+
+
 // -------------  Private methods -----------------------//
 
 ///////////////////////////////////////////////////////////////
@@ -59,7 +59,8 @@ namespace freeling {
     if (fabr.fail()) ERROR_CRASH(L"Error opening file "+sufFile);
   
     int kind= -1;
-    Longest[SUF]=0;  Longest[PREF]=0;    
+    trie[SUF].push_back(affix_node());
+    trie[PREF].push_back(affix_node());
     // load suffix rules
     while (getline(fabr, line)) {
       // skip comments and empty lines       
@@ -90,11 +91,8 @@ namespace freeling {
           suf.lema=lema; suf.always=always; 
           suf.retok=retok;
           if (suf.retok==L"-") suf.retok.clear();
-          // Insert rule in appropriate affix multimaps.
-          affix[kind].insert(make_pair(key,suf));
-          if (suf.always) affix_always[kind].insert(make_pair(key,suf));  
-          ExistingLength[kind].insert(key.size());
-          if (key.size()>Longest[kind]) Longest[kind]=key.size();
+          // Insert rule in appropriate affix trie.
+          add_rule(kind,key,suf);
         }
       }
     }
@@ -105,6 +103,55 @@ namespace freeling {
   }
 
 
+  //////////////////////////////////////////////////////////////////////////////////////////
+  /// Store a rule and index it in the trie of its kind under the given affix.
+  /// Suffixes are inserted from their last char backwards, so that a single walk
+  /// from the end of a word finds all its suffixes.
+  //////////////////////////////////////////////////////////////////////////////////////////
+
+  void affixes::add_rule(int kind, const wstring &key, const sufrule &suf) {
+    rules[kind].push_back(suf);
+    const sufrule *r = &rules[kind].back();
+
+    int node=0;
+    for (size_t i=0; i<key.size(); i++) {
+      wchar_t c = (kind==SUF ? key[key.size()-1-i] : key[i]);
+      unsigned long long t = ((unsigned long long)node<<32) | (unsigned int)c;
+      unordered_map<unsigned long long,int>::const_iterator p=trans[kind].find(t);
+      if (p!=trans[kind].end()) node=p->second;
+      else {
+        trie[kind].push_back(affix_node());
+        trans[kind].insert(make_pair(t,(int)trie[kind].size()-1));
+        node=trie[kind].size()-1;
+      }
+    }
+
+    trie[kind][node].all.push_back(r);
+    if (suf.always) trie[kind][node].always.push_back(r);
+  }
+
+
+  //////////////////////////////////////////////////////////////////////////////////////////
+  /// Walk the trie of given kind along the lowercased form, collecting all affixes
+  /// with rules, by increasing length. Affixes must leave a non-empty root.
+  //////////////////////////////////////////////////////////////////////////////////////////
+
+  void affixes::find_affixes(int kind, const wstring &lws, bool known, affix_matches &found) const {
+    size_t len=lws.size();
+    int node=0;
+    for (size_t i=1; i<len; i++) {
+      wchar_t c = (kind==SUF ? lws[len-i] : lws[i-1]);
+      unsigned long long t = ((unsigned long long)node<<32) | (unsigned int)c;
+      unordered_map<unsigned long long,int>::const_iterator p=trans[kind].find(t);
+      if (p==trans[kind].end()) break;
+      node=p->second;
+
+      const vector<const sufrule*> &rl = (known ? trie[kind][node].always : trie[kind][node].all);
+      if (not rl.empty()) found.push_back(make_pair(i,&rl));
+    }
+  }
+
+
   //////////////////////////////////////////////////////////////////////////////////////////
   /// Look up possible roots of a suffixed form.
   /// Words already analyzed are only applied the "always"-marked suffix rules.
@@ -113,78 +160,60 @@ namespace freeling {
 
   void affixes::look_for_affixes(word &w) const {
 
-    if (w.get_n_analysis()>0) {
+    bool known = (w.get_n_analysis()>0);
+    if (known) {
       // word with analysys already. Check only "always-checkable" affixes
       TRACE(2,L"=== Known word '"+w.get_form()+L"', with "+util::int2wstring(w.get_n_analysis())+L" analysis. Looking only for 'always' affixes");
-      TRACE(3,L" --- Cheking SUF ---");
-      look_for_affixes_in_list(SUF,affix_always[SUF],w);
-      TRACE(3,L" --- Cheking PREF ---");
-      look_for_affixes_in_list(PREF,affix_always[PREF],w);
-      TRACE(3,L" --- Cheking PREF+SUF ---");
-      look_for_combined_affixes(affix_always[SUF],affix_always[PREF],w);
     }
     else {
       // word not in dictionary. Check all affixes
       TRACE(2,L"===Unknown word '"+w.get_form()+L"'. Looking for any affix");
-      TRACE(3,L" --- Cheking SUF ---");
-      look_for_affixes_in_list(SUF,affix[SUF],w);
-      TRACE(3,L" --- Cheking PREF ---");
-      look_for_affixes_in_list(PREF,affix[PREF],w);
-      TRACE(3,L" --- Cheking PREF+SUF ---");
-      look_for_combined_affixes(affix[SUF],affix[PREF],w);
     }
+
+    // find all suffixes and prefixes of the word with a single walk on each trie
+    const wstring &lws=w.get_lc_form();
+    affix_matches sufs,prefs;
+    find_affixes(SUF,lws,known,sufs);
+    find_affixes(PREF,lws,known,prefs);
+
+    // dictionary lookups are shared by all rules tried on this word
+    root_cache roots;
+    TRACE(3,L" --- Cheking SUF ---");
+    look_for_affixes_in_list(SUF,sufs,w,roots);
+    TRACE(3,L" --- Cheking PREF ---");
+    look_for_affixes_in_list(PREF,prefs,w,roots);
+    TRACE(3,L" --- Cheking PREF+SUF ---");
+    look_for_combined_affixes(sufs,prefs,w,roots);
   }
 
 
   //////////////////////////////////////////////////////////////////////////////////////////
-  // Look for suffixes of the word w, using the given multimap.
+  // Apply the rules of the given affixes of the word w.
   // The word is annotated with new analysis, if any.
   //////////////////////////////////////////////////////////////////////////////////////////
 
-  void affixes::look_for_affixes_in_list(int kind, const std::multimap<std::wstring,sufrule> &suff, word &w) const {
-    typedef multimap<wstring,sufrule>::const_iterator T1;
-    T1 sufit;
-    pair<T1,T1> rules;
+  void affixes::look_for_affixes_in_list(int kind, const affix_matches &found, word &w, root_cache &roots) const {
     set<wstring> candidates;
-    wstring lws,form_term,form_root;
-    unsigned int i,j, len;
-
-    lws=w.get_lc_form();
-    len=lws.length();
-    for (i=1; i<=Longest[kind] && i<len; i++) {
-      // advance backwards in form
-      j=len-i;
-
-      // check whether there are any affixes of that size
-      if (ExistingLength[kind].find(i)==ExistingLength[kind].end()) {
-        TRACE(4,L"No affixes of size "+util::int2wstring(i));
-      }
-      else {
-        // get the termination/beggining
-        if (kind==SUF) form_term = lws.substr(j);
-        else if (kind==PREF) form_term = lws.substr(0,i);
-
-        // get all rules for that suffix
-        rules=suff.equal_range(form_term);
-        if (rules.first==suff.end() || rules.first->first!=form_term) {
-          TRACE(3,L"No rules for affix "+form_term+L" (size "+util::int2wstring(i)+L")");
-        }
-        else {
-          TRACE(3,L"Found "+util::int2wstring(suff.count(form_term))+L" rules for affix "+form_term+L" (size "+util::int2wstring(i)+L")");
-          for (sufit=rules.first; sufit!=rules.second; sufit++) {
-            // get the stem, after removing the affix
-            if (kind==SUF) form_root = lws.substr(0,j);
-            else if (kind==PREF) form_root = lws.substr(i);
-            TRACE(3,L"Trying rule ["+form_term+L" "+sufit->second.term+L" "+sufit->second.expression+L" "+sufit->second.output+L"] on root "+form_root);
+    wstring form_term,form_root;
+
+    const wstring &lws=w.get_lc_form();
+    unsigned int len=lws.length();
+    for (affix_matches::const_iterator f=found.begin(); f!=found.end(); f++) {
+      unsigned int i=f->first;
+      // split the form in termination/beggining and the stem
+      if (kind==SUF) { form_term = lws.substr(len-i); form_root = lws.substr(0,len-i); }
+      else { form_term = lws.substr(0,i); form_root = lws.substr(i); }
+
+      TRACE(3,L"Found "+util::int2wstring(f->second->size())+L" rules for affix "+form_term+L" (size "+util::int2wstring(i)+L")");
+      for (vector<const sufrule*>::const_iterator sufit=f->second->begin(); sufit!=f->second->end(); sufit++) {
+        TRACE(3,L"Trying rule ["+form_term+L" "+(*sufit)->term+L" "+(*sufit)->expression+L" "+(*sufit)->output+L"] on root "+form_root);
           
-            // complete all possible roots, using terminations/begginings provided in suffix rule
-            candidates = GenerateRoots(kind, sufit->second, form_root);
-            // fix accentuation patterns of obtained roots
-            accen.fix_accentuation(candidates, sufit->second);
-            // enrich word analysis list with dictionary entries for valid roots
-            SearchRootsList(candidates, form_term, sufit->second, w);
-          }
-        }
+        // complete all possible roots, using terminations/begginings provided in suffix rule
+        candidates = GenerateRoots(kind, **sufit, form_root);
+        // fix accentuation patterns of obtained roots
+        accen.fix_accentuation(candidates, **sufit);
+        // enrich word analysis list with dictionary entries for valid roots
+        SearchRootsList(candidates, form_term, **sufit, w, roots);
       }
     }
   }
@@ -195,71 +224,45 @@ namespace freeling {
   // The word is annotated with new analysis, if any.
   //////////////////////////////////////////////////////////////////////////////////////////
 
-  void affixes::look_for_combined_affixes(const std::multimap<std::wstring,sufrule> &suff, const std::multimap<std::wstring,sufrule> &pref, word &w) const
+  void affixes::look_for_combined_affixes(const affix_matches &sufs, const affix_matches &prefs, word &w, root_cache &roots) const
   {
-    typedef multimap<wstring,sufrule>::const_iterator T1;
-    T1 sufit,prefit;
-    pair<T1,T1> rules_S,rules_P;
     set<wstring> candidates,cand1,cand2;
-    wstring lws,form_suf,form_pref,form_root;
-    unsigned int i,j,len;
-
-    lws=w.get_lc_form();
-    len=lws.length();
-    for (i=1; i<=Longest[SUF] && i<len; i++) {
-      // check whether there are any suffixes of that size. 
-      if (ExistingLength[SUF].find(i)==ExistingLength[SUF].end()) {
-        TRACE(4,L"No suffixes of size "+util::int2wstring(i));
-        continue; // Skip to next size if none found
-      }
- 
+    wstring form_suf,form_pref,form_root;
+
+    const wstring &lws=w.get_lc_form();
+    unsigned int len=lws.length();
+    for (affix_matches::const_iterator fs=sufs.begin(); fs!=sufs.end(); fs++) {
+      unsigned int i=fs->first;
+      form_suf = lws.substr(len-i);
+
       // check prefixes, only to len-i, since i+j>=len leaves no space for a root.
-      for (j=1; j<=Longest[PREF] && j<len-i; j++) {  
-        // check whether there are any suffixes of that size. Skip to next if none found
-        if (ExistingLength[PREF].find(j)==ExistingLength[PREF].end()) {
-          TRACE(4,L"No prefixes of size "+util::int2wstring(j));
-          continue; // Skip to next size if none found
-        }
-      
-        // get sufix and prefix of current lengths
-        form_suf = lws.substr(len-i);
+      for (affix_matches::const_iterator fp=prefs.begin(); fp!=prefs.end() and fp->first<len-i; fp++) {
+        unsigned int j=fp->first;
         form_pref = lws.substr(0,j);
-        // get all rules for those affixes
-        rules_S = suff.equal_range(form_suf);
-        if (rules_S.first==suff.end() || rules_S.first->first!=form_suf) {
-          TRACE(3,L"No rules for suffix "+form_suf+L" (size "+util::int2wstring(i)+L")");
-          continue; // Skip to next size if no rules found
-        }
-        rules_P = pref.equal_range(form_pref);
-        if (rules_P.first==pref.end() || rules_P.first->first!=form_pref) {
-          TRACE(3,L"No rules for prefix "+form_pref+L" (size "+util::int2wstring(j)+L")");
-          continue; // Skip to next size if no rules found
-        }
 
         // get the stem, after removing the suffix and prefix
-        form_root = lws.substr(0,len-i).substr(j);
+        form_root = lws.substr(j,len-i-j);
         TRACE(3,L"Trying a decomposition: "+form_pref+L"+"+form_root+L"+"+form_suf);
-
-        // if we reach here, there are rules for a sufix and a prefix of the word.      
-        TRACE(3,L"Found "+util::int2wstring(suff.count(form_suf))+L" rules for suffix "+form_suf+L" (size "+util::int2wstring(i)+L")");
-        TRACE(3,L"Found "+util::int2wstring(pref.count(form_pref))+L" rules for prefix "+form_pref+L" (size "+util::int2wstring(j)+L")");
+        TRACE(3,L"Found "+util::int2wstring(fs->second->size())+L" rules for suffix "+form_suf+L" (size "+util::int2wstring(i)+L")");
+        TRACE(3,L"Found "+util::int2wstring(fp->second->size())+L" rules for prefix "+form_pref+L" (size "+util::int2wstring(j)+L")");
       
         // backup of locked status
         bool locked = w.is_locked_analysis();
    
-        for (sufit=rules_S.first; sufit!=rules_S.second; sufit++) {
-          for (prefit=rules_P.first; prefit!=rules_P.second; prefit++) {
+        for (vector<const sufrule*>::const_iterator sufit=fs->second->begin(); sufit!=fs->second->end(); sufit++) {
+          // cand1: all possible completions with suffix rule (same for all prefix rules)
+          cand1 = GenerateRoots(SUF, **sufit, form_root);
+          // fix accentuation patterns of obtained roots
+          accen.fix_accentuation(cand1, **sufit);
+
+          for (vector<const sufrule*>::const_iterator prefit=fp->second->begin(); prefit!=fp->second->end(); prefit++) {
        
             candidates.clear();
-            // cand1: all possible completions with suffix rule
-            cand1 = GenerateRoots(SUF, sufit->second, form_root);
-            // fix accentuation patterns of obtained roots
-            accen.fix_accentuation(cand1, sufit->second);
             for (set<wstring>::iterator s=cand1.begin(); s!=cand1.end(); s++) {
               // cand2: for each cand1, generate all possible completions with pref rule 
-              cand2 = GenerateRoots(PREF, prefit->second, (*s));
+              cand2 = GenerateRoots(PREF, **prefit, (*s));
               // fix accentuation patterns of obtained roots
-              accen.fix_accentuation(cand2, prefit->second);
+              accen.fix_accentuation(cand2, **prefit);
               // accumulate cand2 to candidate list.
               candidates.insert(cand2.begin(),cand2.end());
             }
@@ -267,14 +270,14 @@ namespace freeling {
             // enrich word analysis list with dictionary entries for valid roots
             word waux=w;
             // apply prefix rules and generate analysis in waux.
-            SearchRootsList(candidates, form_pref, prefit->second, waux);
+            SearchRootsList(candidates, form_pref, **prefit, waux, roots);
             // use analysis in waux as base to apply suffix rule
             for (set<wstring>::iterator s=candidates.begin(); s!=candidates.end(); s++) 
-              ApplyRule(form_pref+(*s), waux, form_suf, sufit->second, w);
+              ApplyRule(form_pref+(*s), waux, form_suf, **sufit, w);
 
             // ApplyRule may have locked the word. 
             // Unless both rules agree on that, revert to original locking status.
-            if (not (sufit->second.nomore and prefit->second.nomore)) {
+            if (not ((*sufit)->nomore and (*prefit)->nomore)) {
               if (locked) w.lock_analysis(); 
               else w.unlock_analysis();
             }
@@ -336,14 +339,14 @@ namespace freeling {
 
   //////////////////////////////////////////////////////////////////////////////////////////
   /// Search candidate forms in dictionary, discarding invalid forms
-  /// and annotating the valid ones.
+  /// and annotating the valid ones. Each distinct root is looked up only
+  /// once per word, later rules reuse the result stored in the cache.
   //////////////////////////////////////////////////////////////////////////////////////////
 
-  void affixes::SearchRootsList(set<wstring> &roots, const wstring &aff, const sufrule &suf, word &wd) const
+  void affixes::SearchRootsList(set<wstring> &roots, const wstring &aff, const sufrule &suf, word &wd, root_cache &cache) const
   {
     set<wstring> remain;
     set<wstring>::iterator r;
-    list<analysis> la;
 
     TRACE(3,L"Checking a list of "+util::int2wstring(roots.size())+L" roots.");
 #ifdef VERBOSE
@@ -356,9 +359,13 @@ namespace freeling {
 
       r=remain.begin();
 
-      // look into the dictionary for that root
-      la.clear();
-      dic.search_form(*r,la);
+      // look into the dictionary for that root, unless already done for this word
+      root_cache::iterator c=cache.find(*r);
+      if (c==cache.end()) {
+        c=cache.insert(make_pair(*r,list<analysis>())).first;
+        dic.search_form(*r,c->second);
+      }
+      const list<analysis> &la=c->second;
 
       // if found, we must construct the analysis for the suffix
       if (la.empty()) {
@@ -148,11 +148,11 @@ namespace freeling {
 
   void tokenizer::tokenize(const std::wstring &p, unsigned long &offset, list<word> &v) const 
   {
-    wstring t[10];
+    freeling::regexp::span t[10];
     list<pair<wstring, freeling::regexp> >::const_iterator i;
     bool match;
     int j, substr, len=0;
-    vector<wstring> results;  // to store match results
+    vector<freeling::regexp::span> results;  // to store match results (relative to c)
 
     v.clear(); 
     // Loop until line is completely processed. 
@@ -179,11 +179,12 @@ namespace freeling {
             for (j=(substr==0? 0 : 1); j<=substr && match; j++) {
               // get each requested  substring
               t[j] = results.at(j);
-              len += t[j].length();
-              TRACE(2,L"Found match "+util::int2wstring(j)+L" ["+t[j]+L"] for rule "+i->first);
+              if (t[j].first<0) t[j].first=0;  // unmatched group, null substring
+              len += t[j].second;
+              TRACE(2,L"Found match "+util::int2wstring(j)+L" ["+wstring(c+t[j].first,c+t[j].first+t[j].second)+L"] for rule "+i->first);
               // if special rule, match must be in abbrev file
               if ((i->first)[0]==L'*') {
-                wstring lower = util::lowercase(t[j]);
+                wstring lower = util::lowercase(wstring(c+t[j].first,c+t[j].first+t[j].second));
                 if (abrevs.find(lower)==abrevs.end()) {
                   match = false;
                   TRACE(2,L"Special rule and found match not in abbrev list. Rule not satisfied");
@@ -204,15 +205,15 @@ namespace freeling {
         // create word for each matched substring and append it to token list
         substr = matches.find(i->first)->second;
         for (j=(substr==0? 0 : 1); j<=substr; j++) {
-          if (t[j].length() > 0) {
-            TRACE(2,L"Accepting matched substring ["+t[j]+L"]");
-            word w(t[j]);
-            w.set_span(offset,offset+t[j].length());
-            offset += t[j].length();
+          if (t[j].second > 0) {
+            word w(wstring(c+t[j].first, c+t[j].first+t[j].second));
+            TRACE(2,L"Accepting matched substring ["+w.get_form()+L"]");
+            w.set_span(offset,offset+t[j].second);
+            offset += t[j].second;
             v.push_back(w);
           }
           else
-            TRACE(2,L"Skipping matched null substring ["+t[j]+L"]");
+            TRACE(2,L"Skipping matched null substring");
         } 
         // remaining substring
         c += len;
@@ -210,6 +210,8 @@ namespace freeling {
 
   void ukb::analyze(std::list<freeling::sentence> &ls) const {
 
+    metrics::probe p(typeid(*this));
+
     //  Init a weight vector for synsets in the sentences 
     vector<double> pv;
     init_synset_vector(ls,pv);
@@ -220,6 +222,7 @@ namespace freeling {
 
     // Extract ranks from the vector, and move results to sentence
     extract_ranks_to_sentences(ls,pv);
+    p.count(ls);
 
     TRACE(2,"Sentences successfully analyzed by UKB module");
   }
@@ -33,6 +33,12 @@
 
 #define BOOST_SYSTEM_NO_DEPRECATED
 #include <boost/filesystem.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <exception>
+#include <atomic>
+#include <memory>
+#include <deque>
 
 #include "freeling/morfo/util.h"
 
@@ -370,4 +376,138 @@ namespace freeling {
       cl[0] = towupper(cl[0]); 
     return cl;
   }
+
+  namespace {
+
+    /// a parallel_for call. Its stripes of indices are claimed by 
+    /// the calling thread and by any pool thread picking the batch.
+    class pfor_batch {
+    public:
+      size_t from, to, nth;
+      const function<void(size_t)> *f;
+      /// next stripe to claim
+      atomic<size_t> next;
+      /// stripes finished, guarded by 'sem'
+      size_t done;
+      vector<exception_ptr> err;
+      boost::mutex sem;
+      boost::condition_variable finished;
+
+      pfor_batch(size_t fr, size_t t, size_t n, const function<void(size_t)> &fn) 
+        : from(fr), to(t), nth(n), f(&fn), next(0), done(0), err(n) {}
+
+      /// claim and run stripes until none is left
+      void work() {
+        size_t t;
+        while ((t=next++) < nth) {
+          try {
+            for (size_t i=from+t; i<to; i+=nth) (*f)(i);
+          }
+          catch (...) { err[t] = current_exception(); }
+
+          boost::mutex::scoped_lock lock(sem);
+          if (++done==nth) finished.notify_all();
+        }
+      }
+    };
+
+    /// set in pool threads, and in threads that asked for serial calls
+    thread_local bool serial_thread = false;
+    /// max threads per call, 0 until set or first used
+    atomic<size_t> max_threads(0);
+
+    /// threads waiting for parallel_for batches. Created on first use
+    /// and never destroyed, since calls may happen during exit.
+    class pfor_pool {
+    private:
+      deque<shared_ptr<pfor_batch> > queue;
+      size_t nthreads;
+      boost::mutex sem;
+      boost::condition_variable wake;
+
+      void work() {
+        serial_thread = true;
+        while (true) {
+          shared_ptr<pfor_batch> b;
+          {
+            boost::mutex::scoped_lock lock(sem);
+            while (queue.empty()) wake.wait(lock);
+            b = queue.front();
+            queue.pop_front();
+          }
+          b->work();
+        }
+      }
+
+    public:
+      pfor_pool() : nthreads(0) {}
+
+      /// offer batch to n pool threads, creating them if needed
+      void post(const shared_ptr<pfor_batch> &b, size_t n) {
+        {
+          boost::mutex::scoped_lock lock(sem);
+          for (; nthreads<n; nthreads++) 
+            boost::thread(&pfor_pool::work, this).detach();
+          for (size_t i=0; i<n; i++) queue.push_back(b);
+        }
+        wake.notify_all();
+      }
+
+      static pfor_pool& get() {
+        static pfor_pool *p = new pfor_pool();
+        return *p;
+      }
+    };
+  }
+
+  /////////////////////////////////////////////////////////////////////////////
+  /// Call f(i) for each i in [from,to). Indices are striped over up to 
+  /// max_threads threads: the calling one, and pool threads that pick
+  /// the batch before the caller claimed all stripes.
+  /// An exception thrown by any call is rethrown once all stripes are done.
+  /////////////////////////////////////////////////////////////////////////////
+
+  void util::parallel_for(size_t from, size_t to, const function<void(size_t)> &f) {
+    if (to<=from) return;
+
+    size_t nth = 1;
+    if (not serial_thread) {
+      if (max_threads.load()==0) set_parallel_threads(0);
+      nth = min<size_t>(to-from, max_threads.load());
+    }
+    if (nth<=1) {
+      for (size_t i=from; i<to; i++) f(i);
+      return;
+    }
+
+    shared_ptr<pfor_batch> b = make_shared<pfor_batch>(from, to, nth, f);
+    pfor_pool::get().post(b, nth-1);
+    b->work();
+    {
+      // wait for stripes claimed by pool threads
+      boost::mutex::scoped_lock lock(b->sem);
+      while (b->done<nth) b->finished.wait(lock);
+    }
+
+    for (size_t t=0; t<nth; t++)
+      if (b->err[t]) rethrow_exception(b->err[t]);
+  }
+
+  /////////////////////////////////////////////////////////////////////////////
+  /// Set max number of threads per parallel_for call (0 = number of cores)
+  /////////////////////////////////////////////////////////////////////////////
+
+  void util::set_parallel_threads(size_t n) {
+    if (n==0) n = max<size_t>(1, boost::thread::hardware_concurrency());
+    max_threads.store(n);
+  }
+
+  /////////////////////////////////////////////////////////////////////////////
+  /// Run parallel_for calls from the calling thread serially, or not
+  /////////////////////////////////////////////////////////////////////////////
+
+  void util::set_serial_thread(bool b) {
+    serial_thread = b;
+  }
+
 } // namespace
@@ -182,7 +182,7 @@ namespace treeler {
 	//TODO precompute
 	SynIntLabelPath new_path;
 	for (auto it = syn_path.begin(); it != syn_path.end(); ++it){
-	  string synl = *it;
+	  const string& synl = *it;
 	  //map the label
 	  //typename FIdx::Tag syn_label = FIdx::tag( symbols.map_field<SYNTACTIC_LABEL,typename FIdx::Tag>(syn_label_arg));
 	  int int_syn = symbols.map_field<SYNTACTIC_LABEL, int>(synl);
@@ -240,9 +240,9 @@ namespace treeler {
 	}
 
 	//get the syn path from pred to arg
-	SynLabelPath synl_path = x.get_syn_path(pred, arg);
+	const SynLabelPath& synl_path = x.get_syn_path(pred, arg);
 	SynIntLabelPath synl_int_path = ToIntPath(config, symbols, synl_path);
-	UpDownPath ud_path = x.get_ud_path(pred, arg);
+	const UpDownPath& ud_path = x.get_ud_path(pred, arg);
 
 	typename FIdx::BigWord syn_ud_path = PathFeatures<FIdx>::path(synl_path, synl_int_path, ud_path);
 	//typename FIdx::Path syn_ud_path = FIdx::path(synl_path, synl_int_path, ud_path);
@@ -300,7 +300,7 @@ namespace treeler {
 
 	const int num_words = x.size();
 	typedef std::list<int> NodePath;
-	NodePath pt = x.get_node_path(pred, arg);
+	const NodePath& pt = x.get_node_path(pred, arg);
 
 	//var to check if there are holes 
 	bool holes_at_left = false;
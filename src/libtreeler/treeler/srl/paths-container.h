@@ -43,51 +43,6 @@
 namespace treeler {
 
   namespace srl {
-    /** Computes list of children given a dep vector */
-    class Children {
-    public:
-      Children(const DepVector<string>& dep_vector): kRoot_(-1) {
-	//the number of words
-	int n = dep_vector.size();
-	children_.resize(n);
-	
-	//root is -1, thus we have to get the children of -1, the root
-	for (int i = -1; i < n; ++i) {
-	  //get i as mod
-	  int head = i;
-	  for (int m = 0; m < n; ++m){
-	    //get the head of m
-	    if (dep_vector.at(m).h == head){
-	      if (head == kRoot_){
-		children_of_root_.push_back(m);
-	      } else {
-		children_.at(head).push_back(m);
-	      }
-	    }
-	  }
-	}
-      }
-    
-      /** return the children of h */
-      const list<int>& at(int h) const {
-	if (h == kRoot_){
-	  return children_of_root_;
-	}
-	assert(h >= 0);
-	assert(h < static_cast<int>(children_.size()));
-	return children_.at(h);
-      }
-      
-    private:
-      /** the root position */
-      const int kRoot_;
-      /** children for the root */
-      list<int> children_of_root_;
-      /** a vector from node to children of this node */
-      vector<list<int>> children_;
-    }; //end of class Children
-    
-
     /**
      * \brief A class to have paths
      * \ingroup srl
@@ -108,21 +63,19 @@ namespace treeler {
         syn_label_paths_.resize(num_words2);
         ud_paths_.resize(num_words2);
 
-        //compute the children of dep_vector
-        Children children(dep_vector);
+        //parent and depth of each node, computed once for all pairs
+        ComputeAncestors(dep_vector);
 
         //build paths starting only from predicates
+        list<int> path;
         for (auto it = pred_list.begin(); it != pred_list.end(); ++it) {
-          //explore the paths for this predicate
           const int pred = *it;
-          list<int> initial_path;
-          initial_path.push_back(pred);
-          bool go_only_down = false;
-          ComputeAllPaths(pred, pred, dep_vector, children, initial_path, go_only_down);
-          //now all paths from pred to all reachable args are filled
+          for (int arg = 0; arg < num_words_; ++arg) {
+            TreePath(pred, arg, &path);
+            AddPath(pred, arg, path, dep_vector);
+          }
           //PrintPaths(pred);
-
-       }
+        }
       }
 
       void PrintPaths(int pred) const {
@@ -212,62 +165,64 @@ namespace treeler {
         return s*num_words_ + e;
       }
 
-      /** Compute paths from the depvector */
-      void ComputeAllPaths(int source, int node, const DepVector<string>& dep_vector, const
-        Children& children, const list<int>& prev_path, bool go_only_down){
-        if (node == -1) assert (go_only_down);
-        assert(node >= -1);
-        assert(node < num_words_);
-        //add the initial path to the path list
-        assert(prev_path.size() <= 100); //hardcoded max path len
-
-        if (node != -1){ //we will not need paths to the root
-          AddPath(source, node, prev_path, dep_vector);
+      /** parent of each node, with num_words_ standing for the root */
+      vector<int> parent_;
+      /** depth of each node, the root being at depth 0 */
+      vector<int> depth_;
+
+      /** Fills parent_ and depth_ from the depvector */
+      void ComputeAncestors(const DepVector<string>& dep_vector){
+        parent_.assign(num_words_ + 1, kRoot_);
+        depth_.assign(num_words_ + 1, -1);
+        depth_[num_words_] = 0;
+        for (int i = 0; i < num_words_; ++i){
+          const int head = dep_vector.at(i).h;
+          assert(head >= kRoot_ and head < num_words_);
+          parent_[i] = (head == kRoot_ ? num_words_ : head);
         }
-        int last_node = prev_path.back();
-        if (last_node < 0) last_node = -last_node;
-        //check the path ends where we expect to
-        assert(last_node == node or (node == -1 and last_node == num_words_) );
-
-        if (!go_only_down){
-          //go up and recursively call
-          if (node != kRoot_){
-            assert(node >= 0);
-            assert(node <= static_cast<int>(dep_vector.size()));
-
-            int head = dep_vector.at(node).h;
-            if (head != kRoot_){ //for czech multiroots
-              //add the head as a path node
-              list<int> current_path = prev_path;
-              current_path.push_back(head);
-              //cerr << "going upwards " << endl;
-              ComputeAllPaths(source, head, dep_vector, children, current_path, false);
-            } else {
-              list<int> current_path = prev_path;
-              current_path.push_back(num_words_); //special code for root (it can't be -1)
-              //cerr << "going upwards " << endl;
-              ComputeAllPaths(source, head, dep_vector, children, current_path, true);
-            }
-          }
-        } //end of go only down
-
-        //call go downs
-        for (auto it = children.at(node).begin(); it != children.at(node).end(); ++it){
-          //do not revisit the source
-          const int child = *it;
-
-          
-            //get a copy of the path and add the child
-            list<int> current_path = prev_path;
-            //flag as minus the descendant nodes
-            current_path.push_back(-child);
-            //AddPath(source, child, current_path, dep_vector);
-
-            //Call go down
-            ComputeAllPaths(source, child, dep_vector, children, current_path, true);
-        } //end for all children
 
+        vector<int> pending;
+        for (int i = 0; i < num_words_; ++i){
+          //climb until a node with known depth, then set depths on the way back
+          int node = i;
+          while (depth_[node] < 0){
+            pending.push_back(node);
+            node = parent_[node];
+            assert(static_cast<int>(pending.size()) <= num_words_); //no cycles
+          }
+          while (!pending.empty()){
+            depth_[pending.back()] = depth_[parent_[pending.back()]] + 1;
+            pending.pop_back();
+          }
+        }
+      }
 
+      /** 
+       * Builds the path from s to e through their lowest common
+       * ancestor: upward nodes as they are, the root as num_words_,
+       * and downward nodes flagged as minus.
+       */
+      void TreePath(int s, int e, list<int>* path) const {
+        path->clear();
+        list<int> down;
+        int a = s;
+        int b = e;
+        while (depth_[a] > depth_[b]) {
+          path->push_back(a);
+          a = parent_[a];
+        }
+        while (depth_[b] > depth_[a]) {
+          down.push_front(-b);
+          b = parent_[b];
+        }
+        while (a != b) {
+          path->push_back(a);
+          down.push_front(-b);
+          a = parent_[a];
+          b = parent_[b];
+        }
+        path->push_back(a);
+        path->splice(path->end(), down);
       }
 
       /** Adds a node path and computes the syn label and up-down path */
@@ -278,24 +233,16 @@ namespace treeler {
         assert(source == node_path.front());
         assert(-end == node_path.back() or end == node_path.back());
 
-        
         const int idx = Index(source, end);
         assert(idx < static_cast<int>(node_paths_.size()));
-
-        bool update = false;
-        if (node_paths_.at(idx).empty()) {
-          node_paths_.at( idx ) = node_path;
-          update = true;
-        } else if (node_paths_.at(idx).size() > node_path.size()){
-          node_paths_.at( idx ) = node_path;
-          update = true;
-        }
-
+        node_paths_.at(idx) = node_path;
 
         //build the up/down path
         //build the syn label path
-        list<bool> updown_path;
-        list<string> syn_path;
+        UpDownPath& updown_path = ud_paths_.at(idx);
+        SynLabelPath& syn_path = syn_label_paths_.at(idx);
+        updown_path.clear();
+        syn_path.clear();
 
         int prev_node = source;
         for (auto it = node_path.begin(); it != node_path.end(); ++it){
@@ -312,8 +259,7 @@ namespace treeler {
               if (prev_node == static_cast<int>(dep_vector.size())){
                 syn_path.push_back("root");
               } else{
-                string synl = dep_vector.at(prev_node).l;
-                syn_path.push_back(synl);
+                syn_path.push_back(dep_vector.at(prev_node).l);
               }
             }
             //ud down and syn paths
@@ -321,17 +267,11 @@ namespace treeler {
             prev_node = node;
           } else { //the node is the child of the previous
             //add as synlabel the label of the current
-            string synl = dep_vector.at(-node).l;
-            syn_path.push_back(synl);
+            syn_path.push_back(dep_vector.at(-node).l);
             updown_path.push_back(kDown_);
             prev_node = -node;
           }
         }
-        assert(idx < static_cast<int>(syn_label_paths_.size()));
-        if (update) syn_label_paths_.at(idx) = syn_path;
-        assert(idx < static_cast<int>(ud_paths_.size()));
-        if (update) ud_paths_.at(idx) = updown_path;
-
       }
     };
 
@@ -30,7 +30,10 @@
 #include <iostream>
 #include <fstream>
 #include <sstream>
+#include <deque>
+#include <chrono>
 #include "socket.h"
+#include "async_client.h"
 
 using namespace std;
 
@@ -53,14 +56,61 @@ void process_stream(istream &sin, socket_CS &sock) {
 }
 
 
+//////////////////////////////////////////////////////////
+// process a file (or stdin) sending each line as a request without 
+// waiting for previous results. Results are printed in input order.
+void process_stream(istream &sin, async_client &client, size_t window) {
+
+  deque<future<string> > results;
+  string s;
+  while (getline(sin,s)) {
+    results.push_back(client.submit(s));
+    // print results already there. If the oldest one is slow, 
+    // do not let the others pile up indefinitely.
+    while (not results.empty() and 
+           (results.size() > 2*window or
+            results.front().wait_for(chrono::seconds(0))==future_status::ready)) {
+      cout<<results.front().get();
+      results.pop_front();
+    }
+  }
+
+  while (not results.empty()) {
+    cout<<results.front().get();
+    results.pop_front();
+  }
+}
+
+
 //------------------------------------------
 int main(int argc, char *argv[]) {
 
+  // language to ask a multi-language server for, if any
+  string lang;
+  // number of pipelined requests, 0 to wait for each result before sending more
+  size_t window = 0;
+  while (argc > 1 and string(argv[1]).find("--")==0) {
+    string opt(argv[1]);
+    int used = 1;
+    if (opt=="--async") window = DEFAULT_WINDOW;
+    else if (opt=="--window" and argc > 2) { window = atoi(argv[2]); used = 2; }
+    else if (opt=="--lang" and argc > 2) { lang = argv[2]; used = 2; }
+    else { argc = 1; break; }
+    argv[used] = argv[0];
+    argv += used;
+    argc -= used;
+  }
+
   if (argc < 2) {
     cerr<<"usage: "<<endl;
-    cerr<<"   Connect to server in local host:   "<<string(argv[0])<<" port [input-files]"<<endl;
-    cerr<<"   Connect to server in remote host:  "<<string(argv[0])<<" host:port [input-files]"<<endl;
+    cerr<<"   Connect to server in local host:   "<<string(argv[0])<<" [options] port [input-files]"<<endl;
+    cerr<<"   Connect to server in remote host:  "<<string(argv[0])<<" [options] host:port [input-files]"<<endl;
     cerr<<"   (if no input-files are provided, stdin is read and processed)"<<endl;
+    cerr<<"options:"<<endl;
+    cerr<<"   --lang code   select language in a multi-language server ('auto' to identify it)"<<endl;
+    cerr<<"   --async       send requests without waiting for results (analyzer_server only)."<<endl;
+    cerr<<"                 Each line is analyzed as a separate document."<<endl;
+    cerr<<"   --window N    same than --async, with at most N requests in flight (default "<<DEFAULT_WINDOW<<")"<<endl;
     exit(0);
   }
 
@@ -76,6 +126,29 @@ int main(int argc, char *argv[]) {
   istringstream ss(p);
   ss>>port;
   
+  if (window > 0) {
+    // pipelined requests
+    try {
+      async_client client(host, port, window);
+      if (not lang.empty()) client.command("SET_LANG "+lang).get();
+
+      if (argc==2) process_stream(cin, client, window);
+      else {
+        for (int i=2; i<argc; i++) {
+          cout << "<OUTPUT SRCFILE=\"" << string(argv[i]) << "\">" << endl;
+          ifstream fin(argv[i]);
+          process_stream(fin, client, window);
+          cout << "</OUTPUT>" << endl;
+        }
+      }
+    }
+    catch (std::exception &e) {
+      cerr<<e.what()<<endl;
+      exit(1);
+    }
+    return 0;
+  }
+
   // connect to server  
   socket_CS sock(host,port);
 
@@ -90,6 +163,15 @@ int main(int argc, char *argv[]) {
     exit(0);
   };
 
+  if (not lang.empty()) {
+    sock.write_message("SET_LANG "+lang);
+    sock.read_message(r);
+    if (r!="FL-SERVER-READY") {
+      cerr<<"Language not available. Server answer was: [" << r << "]" << endl;
+      exit(1);
+    }
+  }
+
   if (argc==2) 
     // no input files given. Use stdin as a single file
     process_stream(cin,sock);
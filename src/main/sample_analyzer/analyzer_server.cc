@@ -0,0 +1,619 @@
+//////////////////////////////////////////////////////////////////
+//
+//    FreeLing - Open Source Language Analyzers
+//
+//    Copyright (C) 2014   TALP Research Center
+//                         Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU Affero General Public
+//    License as published by the Free Software Foundation; either
+//    version 3 of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Affero General Public License for more details.
+//
+//    You should have received a copy of the GNU Affero General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: Lluis Padro (padro@lsi.upc.es)
+//             TALP Research Center
+//             despatx C6.212 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+////////////////////////////////////////////////////////////////
+
+
+//------------------------------------------------------------------//
+//
+//                    IMPORTANT NOTICE
+//
+//  This file contains a simple main program to illustrate
+//  usage of FreeLing analyzers library.
+//
+//  It is a server that loads analyzers for several languages
+//  and attends requests for any of them, using a single pool
+//  of worker threads shared by all clients and languages.
+//  Clients may use the plain protocol (one request at a time) 
+//  or switch to framed messages and send many requests without
+//  waiting for the results (see socket.h and async_client.h)
+//
+//------------------------------------------------------------------//
+
+#include <sstream>
+#include <iostream>
+#include <deque>
+#include <vector>
+#include <map>
+#include <set>
+#include <future>
+#include <functional>
+#include <csignal>
+
+#include <boost/thread.hpp>
+
+// client/server communication
+#include "socket.h"
+/// config file/options handler for each language
+#include "config.h"
+// server performance statistics
+#include "stats.h"
+
+/// headers to call freeling library
+#include "freeling/morfo/analyzer.h"
+/// output handlers, created as the analyzer program does
+#include "handlers.h"
+
+using namespace std;
+using namespace freeling;
+
+//////// A language attended by the server  //////////
+
+class language {
+ public:
+  /// language code requests refer to
+  wstring code;
+  /// configuration, analyzer, and output handler for the language
+  config *cfg;
+  analyzer *anlz;
+  io::output_handler *out;
+  /// maximum number of requests for this language analyzed at once
+  int limit;
+  /// number of requests being analyzed
+  int active;
+
+  language(char *prog, const string &cfgfile, int lim);
+  ~language();
+
+  /// analyze given text as a document, return printed results
+  wstring analyze(const wstring &text, document &doc) const;
+  /// analyze given text with an analyzer keeping the splitter buffer of 
+  /// a client, return printed results for the completed sentences
+  wstring analyze(analyzer &a, const wstring &text, list<sentence> &ls, bool flush) const;
+};
+
+//---- Load configuration file, check it can be used by the server
+//---- and create output handler. Analyzer is created later.
+language::language(char *prog, const string &cfgfile, int lim) : anlz(NULL), limit(lim), active(0) {
+
+  char *av[] = {prog, (char*)"-f", (char*)cfgfile.c_str()};
+  cfg = new config(3, av);
+  code = cfg->config_opt.Lang;
+
+  if (cfg->InputFormat != INP_TEXT) {
+    wcerr << L"Error - Configuration " << util::string2wstring(cfgfile) << L": server only accepts 'text' input format." << endl;
+    exit(1);
+  }
+
+  // same adjustments than analyzer main program
+  if (cfg->invoke_opt.OutputLevel>=COREF and not cfg->config_opt.NEC_NECFile.empty())
+    cfg->invoke_opt.NEC_NEClassification = true;
+  if (cfg->invoke_opt.OutputLevel>=COREF and not cfg->config_opt.SENSE_ConfigFile.empty())
+    cfg->invoke_opt.SENSE_WSD_which = UKB;
+
+  analyzer_config::status st = cfg->check_invoke_options(cfg->invoke_opt);
+  if (st.stat != CFG_OK) {
+    wcerr << st.description << endl;
+    if (st.stat == CFG_ERROR) exit (1);
+  }
+
+  // formats that are not plain text can not travel in server messages
+  if (cfg->OutputFormat!=OUT_FREELING and cfg->OutputFormat!=OUT_CONLL and cfg->OutputFormat!=OUT_XML
+      and cfg->OutputFormat!=OUT_JSON and cfg->OutputFormat!=OUT_JSONL) {
+    wcerr << L"Warning - Output format not available in server for " << code << L". Using 'freeling'." << endl;
+    cfg->OutputFormat = OUT_FREELING;
+  }
+  out = create_output_handler(cfg);
+}
+
+language::~language() {
+  delete anlz;
+  delete out;
+  delete cfg;
+}
+
+//---- Analyze a request
+wstring language::analyze(const wstring &text, document &doc) const {
+  anlz->analyze(text, doc, cfg->invoke_opt, true);
+  if (doc.empty() or doc.front().empty()) return L"";
+  return out->PrintResults(doc);
+}
+
+//---- Analyze a request as part of the client text stream. Incomplete
+//---- sentences stay in the analyzer until a later request completes them.
+wstring language::analyze(analyzer &a, const wstring &text, list<sentence> &ls, bool flush) const {
+  a.analyze(text, ls, cfg->invoke_opt, flush);
+  if (flush) a.reset_offset();
+  if (ls.empty()) return L"";
+  return out->PrintResults(ls);
+}
+
+
+//////// Pool of threads analyzing requests for any language  //////////
+
+class worker_pool {
+ private:
+  /// a pending request, and the language it is for
+  class job {
+  public:
+    size_t lang;
+    function<void()> task;
+  };
+
+  vector<language*> &langs;
+  deque<job> pending;
+  boost::mutex sem;
+  boost::condition_variable changed;
+  boost::thread_group workers;
+
+  /// oldest pending job whose language has a free slot
+  deque<job>::iterator next_job();
+  /// worker thread main loop
+  void work();
+
+ public:
+  worker_pool(vector<language*> &ls, int nthreads);
+  /// queue a task analyzing a request for given language
+  void submit(size_t lang, const function<void()> &task);
+};
+
+worker_pool::worker_pool(vector<language*> &ls, int nthreads) : langs(ls) {
+  for (int i=0; i<nthreads; i++)
+    workers.create_thread(boost::bind(&worker_pool::work, this));
+}
+
+void worker_pool::submit(size_t lang, const function<void()> &task) {
+  job j;
+  j.lang = lang;
+  j.task = task;
+  {
+    boost::mutex::scoped_lock lock(sem);
+    pending.push_back(j);
+  }
+  changed.notify_one();
+}
+
+deque<worker_pool::job>::iterator worker_pool::next_job() {
+  deque<job>::iterator j;
+  for (j=pending.begin(); j!=pending.end(); j++)
+    if (langs[j->lang]->active < langs[j->lang]->limit) break;
+  return j;
+}
+
+void worker_pool::work() {
+  // requests already keep all workers busy, so modules
+  // do not fan out further from these threads
+  util::set_serial_thread(true);
+  while (true) {
+    job j;
+    {
+      boost::mutex::scoped_lock lock(sem);
+      deque<job>::iterator p;
+      while ((p=next_job())==pending.end()) changed.wait(lock);
+      j = *p;
+      pending.erase(p);
+      langs[j.lang]->active++;
+    }
+
+    j.task();
+
+    {
+      boost::mutex::scoped_lock lock(sem);
+      langs[j.lang]->active--;
+    }
+    // a job waiting for this language may be eligible now
+    changed.notify_all();
+  }
+}
+
+
+//////// Server state  //////////
+
+vector<language*> languages;
+map<wstring,size_t> lang_index;
+lang_ident *ident=NULL;
+worker_pool *pool=NULL;
+
+//---- Capture signal to shut server down cleanly
+void terminate (int param) {
+  wcerr<<L"SERVER: Signal received. Stopping"<<endl;
+  exit(0);
+}
+
+//---- Language to analyze given text with: the one selected by
+//---- the client, or the identified one if the client chose 'auto'.
+size_t select_language(const wstring &text, int selected) {
+  if (selected>=0) return selected;
+
+  set<wstring> known;
+  for (size_t i=0; i<languages.size(); i++) known.insert(languages[i]->code);
+  map<wstring,size_t>::const_iterator l = lang_index.find(ident->identify_language(text,known));
+  // unidentified text goes to the first language
+  return (l==lang_index.end() ? 0 : l->second);
+}
+
+//////// A connected client  //////////
+
+class session {
+ public:
+  socket_CS *conn;
+  /// statistics reported by PRINT_STATS
+  ServerStats stats;
+  /// language selected by the client, -1 means "auto"
+  int lang;
+  /// requests read whose response is not sent yet (framed protocol only)
+  int inflight;
+  /// analyzer of each language used by the plain protocol, keeping the
+  /// client's incomplete sentences until FLUSH_BUFFER. Modules are shared
+  /// with the language analyzer, only splitter buffers are per client.
+  map<size_t,analyzer*> buffered;
+
+  /// a response waiting to be written by the connection writer thread
+  class frame {
+  public:
+    unsigned int id;
+    char type;
+    string payload;
+  };
+  deque<frame> outbox;
+  /// set when the reader is done and the writer must stop once outbox is empty
+  bool closing;
+
+  /// guards all members above
+  boost::mutex sem;
+  /// signaled when a request in flight has been answered
+  boost::condition_variable finished;
+  /// signaled when a frame is queued, or closing is set
+  boost::condition_variable outgoing;
+
+  session(socket_CS *c) : conn(c), lang(0), inflight(0), closing(false) {}
+  ~session() {
+    for (map<size_t,analyzer*>::iterator a=buffered.begin(); a!=buffered.end(); a++) delete a->second;
+  }
+};
+
+//---- Process a server command. Return false if the text is not one.
+bool run_command(const wstring &text, session &ses, string &answer, bool &ok) {
+  ok = true;
+  if (text==L"RESET_STATS") {
+    boost::mutex::scoped_lock lock(ses.sem);
+    // metrics are server wide, only this client's statistics are reset
+    ses.stats.ResetStats();
+    answer = "FL-SERVER-READY";
+  }
+  else if (text==L"PRINT_STATS") {
+    boost::mutex::scoped_lock lock(ses.sem);
+    answer = util::wstring2string(ses.stats.GetStats());
+  }
+  else if (text==L"PRINT_METRICS")
+    answer = util::wstring2string(metrics::to_prometheus());
+  else if (text==L"PRINT_METRICS_JSON")
+    answer = util::wstring2string(metrics::to_json());
+  else if (text==L"FLUSH_BUFFER")
+    // framed requests are analyzed as a whole, nothing is pending
+    // (the plain protocol handles FLUSH_BUFFER in attend_client)
+    answer = "FL-SERVER-READY";
+
+  else if (text.find(L"SET_LANG ")==0) {
+    wstring code = text.substr(9);
+    map<wstring,size_t>::const_iterator l = lang_index.find(code);
+    if (code==L"auto" and ident!=NULL) ses.lang = -1;
+    else if (l!=lang_index.end()) ses.lang = l->second;
+    else {
+      answer = "FL-SERVER-ERROR Unknown language '"+util::wstring2string(code)+"'";
+      ok = false;
+      return true;
+    }
+    answer = "FL-SERVER-READY";
+  }
+  
+  else return false;
+
+  return true;
+}
+
+//---- Analyze text of a plain protocol client in the pool, waiting for 
+//---- the result. As in the analyzer server, sentences split across 
+//---- requests are kept until completed, or until flush is requested.
+wstring analyze(size_t lang, const wstring &text, session &ses, bool flush) {
+  // only the client thread uses its buffered analyzers, no lock needed
+  map<size_t,analyzer*>::iterator b = ses.buffered.find(lang);
+  if (b==ses.buffered.end()) 
+    b = ses.buffered.insert(make_pair(lang, new analyzer(*languages[lang]->cfg))).first;
+  analyzer *a = b->second;
+
+  list<sentence> ls;
+  wstring res;
+  promise<void> done;
+  future<void> ready = done.get_future();
+  pool->submit(lang, [&]() {
+      try { res = languages[lang]->analyze(*a,text,ls,flush); done.set_value(); }
+      catch (...) { done.set_exception(current_exception()); }
+    });
+  ready.get();
+
+  boost::mutex::scoped_lock lock(ses.sem);
+  ses.stats.UpdateStats(ls);
+  return res;
+}
+
+//---- Queue a response for the connection writer. Called with ses.sem held.
+void send_frame(session &ses, unsigned int id, char type, const string &payload) {
+  session::frame f;
+  f.id = id;
+  f.type = type;
+  f.payload = payload;
+  // the client would not accept it, report the failure instead
+  if (payload.size() > MAX_FRAME_SZ) {
+    f.type = FRAME_ERROR;
+    f.payload = "Result too large";
+  }
+  ses.outbox.push_back(f);
+  ses.outgoing.notify_one();
+}
+
+//---- Connection writer thread: the only one writing to the socket 
+//---- in framed mode, so pool threads never block on a slow client.
+void write_frames(session &ses) {
+  bool broken = false;
+  boost::mutex::scoped_lock lock(ses.sem);
+  while (true) {
+    while (ses.outbox.empty() and not ses.closing) ses.outgoing.wait(lock);
+    if (ses.outbox.empty()) break;
+
+    session::frame f = ses.outbox.front();
+    ses.outbox.pop_front();
+
+    // write without holding the lock, so results keep being queued
+    lock.unlock();
+    // if the client went away, just drop the results
+    if (not broken) {
+      try { ses.conn->write_frame(f.id, f.type, f.payload); } 
+      catch (std::exception &e) { broken = true; }
+    }
+    lock.lock();
+
+    ses.inflight--;
+    ses.finished.notify_all();
+  }
+}
+
+//---- Attend a client using the framed protocol. Requests are read 
+//---- as they come and analyzed concurrently, each response is sent 
+//---- by the connection writer as soon as it is ready. When 'window' 
+//---- requests are in flight, reading stops, so TCP flow control 
+//---- slows the client down.
+void attend_framed(session &ses, int window) {
+
+  boost::thread writer(boost::bind(write_frames, boost::ref(ses)));
+
+  try {
+    unsigned int id;
+    char type;
+    string payload;
+    while (ses.conn->read_frame(id,type,payload)) {
+      wstring text = util::string2wstring(payload);
+      string answer;
+      bool ok;
+
+      {
+        // each request takes a slot until its response is written
+        boost::mutex::scoped_lock lock(ses.sem);
+        while (ses.inflight >= window) ses.finished.wait(lock);
+        ses.inflight++;
+      }
+
+      if (type==FRAME_COMMAND) {
+        if (not run_command(text, ses, answer, ok)) {
+          answer = "Unknown command '"+payload+"'";
+          ok = false;
+        }
+        boost::mutex::scoped_lock lock(ses.sem);
+        send_frame(ses, id, ok ? FRAME_RESULT : FRAME_ERROR, answer);
+      }
+
+      else if (type==FRAME_TEXT) {
+        // language is chosen now, so later SET_LANG commands do not affect this request
+        size_t lang = select_language(text,ses.lang);
+
+        pool->submit(lang, [&ses,id,lang,text]() {
+            document doc;
+            string res;
+            char rtype = FRAME_RESULT;
+            try { res = util::wstring2string(languages[lang]->analyze(text,doc)); }
+            catch (std::exception &e) { res = e.what(); rtype = FRAME_ERROR; }
+
+            boost::mutex::scoped_lock lock(ses.sem);
+            ses.stats.UpdateStats(doc);
+            send_frame(ses, id, rtype, res);
+          });
+      }
+
+      else {
+        boost::mutex::scoped_lock lock(ses.sem);
+        send_frame(ses, id, FRAME_ERROR, "Unknown message type");
+      }
+    }
+  }
+  catch (std::exception &e) {
+    wcerr<<L"SERVER: "<<util::string2wstring(e.what())<<L". Dropping client."<<endl;
+  }
+
+  // wait for requests still being analyzed, and for their
+  // responses to be written, before closing the connection
+  {
+    boost::mutex::scoped_lock lock(ses.sem);
+    while (ses.inflight > 0) ses.finished.wait(lock);
+    ses.closing = true;
+    ses.outgoing.notify_one();
+  }
+  writer.join();
+}
+
+//---- Attend a client until it disconnects.
+void attend_client(socket_CS *conn, int window) {
+
+  session ses(conn);
+
+  try {
+    string s;
+    while (conn->read_message(s)) {
+      wstring text = util::string2wstring(s);
+      string answer;
+      bool ok;
+
+      // client wants pipelined requests, switch to framed messages
+      if (s==FRAMED_PROTOCOL) {
+        conn->write_message(FRAMED_READY);
+        attend_framed(ses, window);
+        break;
+      }
+      // analyze whatever is left in the splitter buffers of the client
+      else if (text==L"FLUSH_BUFFER") {
+        wstring res;
+        for (map<size_t,analyzer*>::iterator b=ses.buffered.begin(); b!=ses.buffered.end(); b++) 
+          res += analyze(b->first, L"", ses, true);
+        conn->write_message(res.empty() ? string("FL-SERVER-READY") : util::wstring2string(res));
+      }
+      else if (run_command(text, ses, answer, ok)) 
+        conn->write_message(answer);
+      else {
+        wstring res = analyze(select_language(text,ses.lang), text, ses, false);
+        conn->write_message(res.empty() ? string("FL-SERVER-READY") : util::wstring2string(res));
+      }
+    }
+  }
+  catch (std::exception &e) {
+    wcerr<<L"SERVER: "<<util::string2wstring(e.what())<<L". Dropping client."<<endl;
+  }
+
+  wcerr<<L"SERVER: client ended. Closing connection."<<endl;
+  try { conn->close_connection(); } catch (std::exception &e) {}
+  delete conn;
+}
+
+
+//---------------------------------------------
+// Main program
+//---------------------------------------------
+
+int main (int argc, char **argv) {
+
+  int port, nthreads, limit, queue, window;
+  wstring identfile, locale;
+  vector<string> cfgfiles;
+
+  po::options_description opts("Options");
+  opts.add_options()
+    ("help,h", "Help about command-line options.")
+    ("port,p", po::value<int>(&port)->required(), "Port where server is to be started")
+    ("threads,t", po::value<int>(&nthreads)->default_value(boost::thread::hardware_concurrency()), "Number of analysis threads shared by all languages")
+    ("limit,l", po::value<int>(&limit)->default_value(0), "Default maximum number of requests of a language analyzed at once (0: no limit)")
+    ("queue,q", po::value<int>(&queue)->default_value(DEFAULT_QUEUE_SIZE), "Maximum number of waiting clients.")
+    ("window,w", po::value<int>(&window)->default_value(64), "Maximum number of requests in flight per client using the framed protocol")
+    ("fidn,I", po::wvalue<wstring>(&identfile), "Language identifier file, to serve clients selecting language 'auto'")
+    ("locale", po::wvalue<wstring>(&locale), "Locale of input text (default: locale in first configuration)")
+    ("cfg", po::value<vector<string> >(&cfgfiles), "Configuration files, one per language. A per-language limit may be given as 'file.cfg:N'")
+    ;
+  po::positional_options_description pos;
+  pos.add("cfg", -1);
+
+  po::variables_map vm;
+  try {
+    po::store(po::command_line_parser(argc, argv).options(opts).positional(pos).run(), vm);
+    if (vm.count("help")) {
+      cerr<<"usage: "<<argv[0]<<" --port N [options] lang1.cfg[:limit] lang2.cfg[:limit] ..."<<endl<<opts<<endl;
+      exit(0);
+    }
+    po::notify(vm);
+  }
+  catch (std::exception &e) {
+    cerr<<"Error while parsing command line: "<<e.what()<<endl;
+    exit(1);
+  }
+  if (cfgfiles.empty()) {
+    cerr<<"Error - No configuration files given."<<endl;
+    exit(1);
+  }
+  if (nthreads<1) nthreads = 1;
+  if (limit<1) limit = nthreads;
+  if (window<1) window = 1;
+
+  // load configurations
+  for (size_t i=0; i<cfgfiles.size(); i++) {
+    string f = cfgfiles[i];
+    int lim = limit;
+    size_t c = f.rfind(':');
+    if (c!=string::npos and c+1<f.size() and f.find_first_not_of("0123456789",c+1)==string::npos) {
+      lim = atoi(f.substr(c+1).c_str());
+      f = f.substr(0,c);
+    }
+
+    language *l = new language(argv[0], f, max(lim,1));
+    if (lang_index.find(l->code)!=lang_index.end()) {
+      wcerr<<L"Error - Language '"<<l->code<<L"' configured more than once."<<endl;
+      exit(1);
+    }
+    lang_index.insert(make_pair(l->code, languages.size()));
+    languages.push_back(l);
+  }
+
+  /// set the locale to UTF to properly handle special characters.
+  util::init_locale(locale.empty() ? languages[0]->cfg->Locale : locale);
+
+  if (not identfile.empty()) ident = new lang_ident(util::expand_filename(identfile));
+
+  // create analyzers and load all their modules, several languages at a time
+  util::parallel_for(0, languages.size(), [&](size_t i) {
+      languages[i]->anlz = new analyzer(*languages[i]->cfg);
+      languages[i]->anlz->load_modules(languages[i]->cfg->invoke_opt);
+    });
+
+  metrics::enable();
+  pool = new worker_pool(languages, nthreads);
+
+  // Capture terminating signals, to exit cleanly.
+  signal(SIGTERM,terminate);
+  signal(SIGQUIT,terminate);
+  // a client closing its connection must not end the server
+  signal(SIGPIPE,SIG_IGN);
+
+  socket_CS sock(port, queue);
+
+  wcerr<<endl<<L"Launched server "<<getpid()<<L" at port "<<port<<L" with "<<nthreads<<L" threads for languages:";
+  for (size_t i=0; i<languages.size(); i++) wcerr<<L" "<<languages[i]->code<<L"("<<languages[i]->limit<<L")";
+  wcerr<<endl<<endl;
+  wcerr<<L"Select the language with:   analyzer_client --lang "<<languages[0]->code<<L" localhost:"<<port<<endl;
+  if (ident!=NULL) wcerr<<L"or let the server identify it:   analyzer_client --lang auto localhost:"<<port<<endl;
+  wcerr<<endl;
+
+  // attend each client in its own thread. Analysis is done in the pool.
+  while (true) {
+    socket_CS *conn = sock.accept_client();
+    wcerr<<L"SERVER: Connection established."<<endl;
+    boost::thread(attend_client, conn, window).detach();
+  }
+}
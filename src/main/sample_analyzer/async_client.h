@@ -0,0 +1,201 @@
+//////////////////////////////////////////////////////////////////
+//
+//    FreeLing - Open Source Language Analyzers
+//
+//    Copyright (C) 2014   TALP Research Center
+//                         Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU Affero General Public
+//    License as published by the Free Software Foundation; either
+//    version 3 of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Affero General Public License for more details.
+//
+//    You should have received a copy of the GNU Affero General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: Lluis Padro (padro@lsi.upc.es)
+//             TALP Research Center
+//             despatx C6.212 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+////////////////////////////////////////////////////////////////
+
+#ifndef _ASYNC_CLIENT
+#define _ASYNC_CLIENT
+
+#include <string>
+#include <map>
+#include <memory>
+#include <future>
+#include <functional>
+#include <stdexcept>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+
+#include "socket.h"
+
+#define DEFAULT_WINDOW 64
+
+////////////////////////////////////////////////////////////////
+///  Class async_client sends requests to an analyzer_server
+/// using the framed protocol: many requests may be in flight
+/// on the same connection, and results are delivered as they
+/// arrive, in any order.
+///  Submitting blocks while 'window' requests are pending, so a
+/// fast producer can not flood the server.
+////////////////////////////////////////////////////////////////
+
+class async_client {
+
+ public:
+  /// called with the result of a request, or the error message if ok==false.
+  /// Runs in the thread receiving responses, so it should be short.
+  typedef std::function<void(bool ok, const std::string &result)> callback;
+
+  async_client(const std::string &host, int port, size_t window=DEFAULT_WINDOW);
+  /// wait for pending requests and close the connection
+  ~async_client();
+
+  /// send text to analyze, 'cb' is called when the result arrives
+  void submit(const std::string &text, const callback &cb);
+  /// send text to analyze, get the result from the returned future
+  std::future<std::string> submit(const std::string &text);
+  /// send a server command (SET_LANG, PRINT_STATS, PRINT_METRICS...)
+  std::future<std::string> command(const std::string &cmd);
+
+  /// wait until all submitted requests are answered
+  void wait();
+
+ private:
+  socket_CS sock;
+  size_t window;
+  /// callbacks of requests in flight, by request id
+  std::map<unsigned int,callback> pending;
+  unsigned int next_id;
+  /// set when the connection fails, with the reason
+  std::string broken;
+  /// guards the members above
+  std::mutex sem;
+  /// serializes writes to the socket
+  std::mutex wsem;
+  std::condition_variable answered;
+  std::thread receiver;
+
+  void send(char type, const std::string &payload, const callback &cb);
+  std::future<std::string> send(char type, const std::string &payload);
+  /// receiver thread: dispatch responses to their callbacks
+  void receive();
+};
+
+
+//---- Connect and switch server to framed messages
+inline async_client::async_client(const std::string &host, int port, size_t w)
+  : sock(host,port,false), window(w>0 ? w : 1), next_id(0) {
+
+  sock.write_message(FRAMED_PROTOCOL);
+  std::string r;
+  sock.read_message(r);
+  if (r!=FRAMED_READY)
+    throw std::runtime_error("Server does not support pipelined requests. Its answer was: ["+r+"]");
+
+  receiver = std::thread(&async_client::receive, this);
+}
+
+inline async_client::~async_client() {
+  wait();
+  // closing our side makes the server close the connection, ending the receiver
+  try { sock.end_writing(); } catch (std::exception &e) {}
+  receiver.join();
+  try { sock.close_connection(); } catch (std::exception &e) {}
+}
+
+inline void async_client::submit(const std::string &text, const callback &cb) { send(FRAME_TEXT, text, cb); }
+
+inline std::future<std::string> async_client::submit(const std::string &text) { return send(FRAME_TEXT, text); }
+
+inline std::future<std::string> async_client::command(const std::string &cmd) { return send(FRAME_COMMAND, cmd); }
+
+inline void async_client::wait() {
+  std::unique_lock<std::mutex> lock(sem);
+  answered.wait(lock, [this]() { return pending.empty(); });
+}
+
+//---- Register callback and send request, waiting for a free slot in the window
+inline void async_client::send(char type, const std::string &payload, const callback &cb) {
+  unsigned int id;
+  {
+    std::unique_lock<std::mutex> lock(sem);
+    answered.wait(lock, [this]() { return pending.size() < window or not broken.empty(); });
+    if (not broken.empty()) throw std::runtime_error(broken);
+    // register the callback before sending, so it is there when the response comes
+    id = next_id++;
+    pending[id] = cb;
+  }
+
+  // write without holding 'sem', so the receiver keeps draining responses
+  // even if the server is not reading (its window is full)
+  try {
+    std::lock_guard<std::mutex> lock(wsem);
+    sock.write_frame(id, type, payload);
+  }
+  catch (std::exception &e) {
+    std::lock_guard<std::mutex> lock(sem);
+    pending.erase(id);
+    throw;
+  }
+}
+
+//---- Send request and return a future for its result
+inline std::future<std::string> async_client::send(char type, const std::string &payload) {
+  std::shared_ptr<std::promise<std::string> > res = std::make_shared<std::promise<std::string> >();
+  send(type, payload, [res](bool ok, const std::string &r) {
+      if (ok) res->set_value(r);
+      else res->set_exception(std::make_exception_ptr(std::runtime_error(r)));
+    });
+  return res->get_future();
+}
+
+//---- Receive responses and call the callback of each request
+inline void async_client::receive() {
+  unsigned int id;
+  char type;
+  std::string payload;
+  try {
+    while (sock.read_frame(id,type,payload)) {
+      callback cb;
+      {
+        std::lock_guard<std::mutex> lock(sem);
+        std::map<unsigned int,callback>::iterator p = pending.find(id);
+        if (p==pending.end()) continue;
+        cb = p->second;
+        pending.erase(p);
+      }
+      cb(type==FRAME_RESULT, payload);
+      answered.notify_all();
+    }
+  }
+  catch (std::exception &e) {
+    std::lock_guard<std::mutex> lock(sem);
+    broken = e.what();
+  }
+
+  // fail whatever is still pending
+  std::map<unsigned int,callback> lost;
+  {
+    std::lock_guard<std::mutex> lock(sem);
+    if (broken.empty()) broken = "Connection closed by server";
+    lost.swap(pending);
+  }
+  for (std::map<unsigned int,callback>::iterator p=lost.begin(); p!=lost.end(); p++)
+    p->second(false, broken);
+  answered.notify_all();
+}
+
+#endif
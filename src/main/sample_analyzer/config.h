@@ -47,12 +47,15 @@
 #define DEFAULT_MAX_WORKERS 5   // maximum number of workers simultaneously active.
 #define DEFAULT_QUEUE_SIZE 32   // maximum number of waiting clients
 
+// Default number of sentences read from column input before analyzing them
+#define DEFAULT_INPUT_BATCH 32
+
 // codes for InputMode
 typedef enum {MODE_CORPUS,MODE_DOC} InputModes;
 // codes for OutputFormat
-typedef enum {OUT_FREELING,OUT_TRAIN,OUT_CONLL,OUT_XML,OUT_JSON,OUT_NAF} OutputFormats;
+typedef enum {OUT_FREELING,OUT_TRAIN,OUT_CONLL,OUT_XML,OUT_JSON,OUT_JSONL,OUT_NAF,OUT_BINARY} OutputFormats;
 // codes for InputFormat
-typedef enum {INP_TEXT, INP_FREELING, INP_CONLL} InputFormats;
+typedef enum {INP_TEXT, INP_FREELING, INP_CONLL, INP_BINARY} InputFormats;
 
 std::wistream& operator>>(std::wistream& in, InputModes& val) {
   std::wstring token;
@@ -74,7 +77,9 @@ std::wistream& operator>>(std::wistream& in, OutputFormats& val) {
   else if (token==L"train") val = OUT_TRAIN;
   else if (token==L"xml") val = OUT_XML;
   else if (token==L"json") val = OUT_JSON ;
+  else if (token==L"jsonl") val = OUT_JSONL ;
   else if (token==L"naf") val = OUT_NAF;
+  else if (token==L"binary") val = OUT_BINARY;
   else {
      val = OUT_FREELING;
      WARNING(L"Unknown or invalid output format: "<<token<<L". Using default.");
@@ -88,6 +93,7 @@ std::wistream& operator>>(std::wistream& in, InputFormats& val) {
   if (token==L"text") val = INP_TEXT;
   else if (token==L"freeling") val = INP_FREELING;
   else if (token==L"conll") val = INP_CONLL;
+  else if (token==L"binary") val = INP_BINARY;
   else {
     val = INP_FREELING;
     WARNING(L"Unknown or invalid input format: "<<token<<L". Using default.");
@@ -140,6 +146,8 @@ public:
 
   /// whether splitter buffer must be flushed at each line
   bool AlwaysFlush = false;
+  /// sentences read from column input before analyzing and printing them
+  int InputBatch = DEFAULT_INPUT_BATCH;
 
   /// Tagset to use for shortening tags in output
   std::wstring TAGSET_TagsetFile;
@@ -166,9 +174,10 @@ public:
       ("ident",po::wvalue<std::wstring>(&LangIdentMode),"Produce language identification as output (best: only most likely language, all: whole ranking)")
       ("flush","Consider each newline as a sentence end")
       ("noflush","Do not consider each newline as a sentence end")
+      ("batch",po::wvalue<int>(&InputBatch),"Sentences read from column input (freeling, conll) before analyzing them (1: output each sentence as soon as it is read)")
       ("mode",po::wvalue<InputModes>(&InputMode),"Input mode (doc,corpus)")
-      ("input",po::wvalue<InputFormats>(&InputFormat),"Input format (text,freeling,conll)")
-      ("output",po::wvalue<OutputFormats>(&OutputFormat),"Output format (freeling,conll,train,xml,json,naf)")
+      ("input",po::wvalue<InputFormats>(&InputFormat),"Input format (text,freeling,conll,binary)")
+      ("output",po::wvalue<OutputFormats>(&OutputFormat),"Output format (freeling,conll,train,xml,json,jsonl,naf,binary)")
       ("iconll",po::wvalue<std::wstring>(&InputConllFile),"CoNLL input definition file")
       ("oconll",po::wvalue<std::wstring>(&OutputConllFile),"CoNLL output definition file")
       ("fidn,I",po::wvalue<std::wstring>(&IDENT_identFile),"Language identifier file")
@@ -185,9 +194,10 @@ public:
       ("ServerQueueSize",po::wvalue<int>(&QueueSize)->default_value(DEFAULT_QUEUE_SIZE),"Maximum number of waiting requests in server mode")
       ("LangIdent",po::wvalue<std::wstring>(&LangIdentMode),"Produce language identification as output (best: only most likely language, all: whole ranking)")
       ("AlwaysFlush",po::wvalue<bool>(&AlwaysFlush)->default_value(false),"Consider each newline as a sentence end")
+      ("InputBatch",po::wvalue<int>(&InputBatch)->default_value(DEFAULT_INPUT_BATCH),"Sentences read from column input (freeling, conll) before analyzing them (1: output each sentence as soon as it is read)")
       ("InputMode",po::wvalue<InputModes>(&InputMode)->default_value(MODE_CORPUS),"Input mode (corpus,doc)")
-      ("OutputFormat",po::wvalue<OutputFormats>(&OutputFormat)->default_value(OUT_FREELING),"Output format (freeling,conll,train,xml,json,naf)")
-      ("InputFormat",po::wvalue<InputFormats>(&InputFormat)->default_value(INP_TEXT),"Input format (text,freeling,conll)")
+      ("OutputFormat",po::wvalue<OutputFormats>(&OutputFormat)->default_value(OUT_FREELING),"Output format (freeling,conll,train,xml,json,jsonl,naf,binary)")
+      ("InputFormat",po::wvalue<InputFormats>(&InputFormat)->default_value(INP_TEXT),"Input format (text,freeling,conll,binary)")
       ("InputConllConfig",po::wvalue<std::wstring>(&InputConllFile),"CoNLL input definition file")
       ("OutputConllConfig",po::wvalue<std::wstring>(&OutputConllFile),"CoNLL output definition file")
       ("LangIdentFile",po::wvalue<std::wstring>(&IDENT_identFile),"Language identifier file")
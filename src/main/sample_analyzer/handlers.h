@@ -0,0 +1,129 @@
+//////////////////////////////////////////////////////////////////
+//
+//    FreeLing - Open Source Language Analyzers
+//
+//    Copyright (C) 2014   TALP Research Center
+//                         Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU Affero General Public
+//    License as published by the Free Software Foundation; either
+//    version 3 of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Affero General Public License for more details.
+//
+//    You should have received a copy of the GNU Affero General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: Lluis Padro (padro@lsi.upc.es)
+//             TALP Research Center
+//             despatx C6.212 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+////////////////////////////////////////////////////////////////
+
+#ifndef _HANDLERS
+#define _HANDLERS
+
+/// config file/options handler for the sample applications
+#include "config.h"
+
+/// output and input handlers for each format
+#include "freeling/output/output_freeling.h"
+#include "freeling/output/output_train.h"
+#include "freeling/output/output_conll.h"
+#include "freeling/output/output_xml.h"
+#include "freeling/output/output_json.h"
+#include "freeling/output/output_naf.h"
+#include "freeling/output/output_binary.h"
+#include "freeling/output/input_conll.h"
+#include "freeling/output/input_freeling.h"
+#include "freeling/output/input_binary.h"
+
+////////////////////////////////////////////////////////////////
+///  Create output and input handlers for the formats and
+/// levels requested in a configuration. Shared by the 
+/// analyzer and the analyzer_server programs.
+////////////////////////////////////////////////////////////////
+
+//---- Create output handler for requested format
+inline freeling::io::output_handler* create_output_handler(const config *cfg) {
+  using namespace freeling;
+
+  io::output_handler *out;
+  if (cfg->OutputFormat==OUT_TRAIN) {
+    out = new io::output_train();
+  }
+  else if (cfg->OutputFormat==OUT_CONLL) {
+    if (not cfg->OutputConllFile.empty()) 
+      out = new io::output_conll(cfg->OutputConllFile);
+    else {
+       out = new io::output_conll();
+       out->load_tagset(cfg->TAGSET_TagsetFile);
+    }
+  }
+  else if (cfg->OutputFormat==OUT_XML) {
+    out = new io::output_xml();
+    out->load_tagset(cfg->TAGSET_TagsetFile);
+  }
+  else if (cfg->OutputFormat==OUT_JSON or cfg->OutputFormat==OUT_JSONL)  {
+    io::output_json *ojs = new io::output_json();
+    ojs->load_tagset(cfg->TAGSET_TagsetFile);
+    ojs->output_jsonl(cfg->OutputFormat==OUT_JSONL);
+    out = ojs;
+  }
+  else if (cfg->OutputFormat==OUT_BINARY)  {
+    out = new io::output_binary();
+  }
+  else if (cfg->OutputFormat==OUT_NAF)  {
+    io::output_naf *onaf = new io::output_naf();
+    onaf->load_tagset(cfg->TAGSET_TagsetFile);
+    onaf->set_language(cfg->config_opt.Lang);
+
+    onaf->ActivateLayer(L"text",true);
+    onaf->ActivateLayer(L"terms",cfg->invoke_opt.OutputLevel>=MORFO);
+    onaf->ActivateLayer(L"entities",cfg->invoke_opt.OutputLevel>=TAGGED);
+    onaf->ActivateLayer(L"chunks",cfg->invoke_opt.OutputLevel==SHALLOW);
+    onaf->ActivateLayer(L"constituency",cfg->invoke_opt.OutputLevel>=PARSED
+                        and cfg->invoke_opt.DEP_which==TXALA);
+    onaf->ActivateLayer(L"deps",cfg->invoke_opt.OutputLevel>=DEP);
+    onaf->ActivateLayer(L"srl",cfg->invoke_opt.OutputLevel>=DEP 
+                        and cfg->invoke_opt.DEP_which==TREELER);
+    onaf->ActivateLayer(L"coreferences",cfg->invoke_opt.OutputLevel>=COREF);
+    out = onaf;
+  }
+  else { //  default, cfg->OutputFormat==OUT_FREELING
+    io::output_freeling *ofl = new io::output_freeling();
+    ofl->output_senses(cfg->invoke_opt.SENSE_WSD_which!=NO_WSD);
+    ofl->output_all_senses(cfg->invoke_opt.SENSE_WSD_which!=MFS);
+    ofl->output_phonetics(cfg->invoke_opt.PHON_Phonetics);
+    ofl->output_dep_tree(cfg->invoke_opt.OutputLevel>=DEP);
+    ofl->output_corefs(cfg->invoke_opt.OutputLevel>=COREF);
+    out = ofl;
+  }
+
+  return out;
+}
+
+
+//---- Create input handler for requested format (NULL for plain text)
+inline freeling::io::input_handler* create_input_handler(const config *cfg) {
+  using namespace freeling;
+
+  io::input_handler *inp;
+  if (cfg->InputFormat==INP_CONLL) {
+    if (not cfg->InputConllFile.empty()) inp = new io::input_conll(cfg->InputConllFile);
+    else inp = new io::input_conll();
+  }
+  else if (cfg->InputFormat==INP_FREELING)  inp = new io::input_freeling();
+  else if (cfg->InputFormat==INP_BINARY)  inp = new io::input_binary();
+  else inp = NULL;
+
+  return inp;
+}
+
+#endif
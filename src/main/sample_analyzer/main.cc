@@ -60,14 +60,7 @@
 #include "freeling/morfo/analyzer.h"
 
 /// functions to print results depending on configuration options
-#include "freeling/output/output_freeling.h"
-#include "freeling/output/output_train.h"
-#include "freeling/output/output_conll.h"
-#include "freeling/output/output_xml.h"
-#include "freeling/output/output_json.h"
-#include "freeling/output/output_naf.h"
-#include "freeling/output/input_conll.h"
-#include "freeling/output/input_freeling.h"
+#include "handlers.h"
 
 // Semaphores and stuff to handle children count in server mode
 #ifdef WIN32
@@ -183,6 +176,7 @@ bool CheckStatsCommands(const wstring &text, ServerStats &stats) {
   bool b=false;
   if (text==L"RESET_STATS") { 
     stats.ResetStats();
+    metrics::reset();
     SendACK();
     b=true;
   }
@@ -190,6 +184,14 @@ bool CheckStatsCommands(const wstring &text, ServerStats &stats) {
     sock->write_message(util::wstring2string(stats.GetStats()));
     b=true;
   }
+  else if (text==L"PRINT_METRICS") {
+    sock->write_message(util::wstring2string(metrics::to_prometheus()));
+    b=true;
+  }
+  else if (text==L"PRINT_METRICS_JSON") {
+    sock->write_message(util::wstring2string(metrics::to_json()));
+    b=true;
+  }
   return b;
 }
 
@@ -237,6 +239,14 @@ void OutputTokens(const list<word> &av) {
 //---- Output analysis result to output channel
 void OutputSentences(const io::output_handler &out, list<sentence> &ls) {
 
+  // binary output is written as bytes, not through the wide stream locale
+  const io::output_binary *bin = dynamic_cast<const io::output_binary*>(&out);
+  if (bin!=NULL) {
+    bin->write_sentences(cout,ls);
+    cout.flush();
+    return;
+  }
+
   if (ServerMode) {
     if (ls.empty()) {
       SendACK();
@@ -256,6 +266,14 @@ void OutputSentences(const io::output_handler &out, list<sentence> &ls) {
 //---- Output analysis result to output channel
 void OutputDocument(const io::output_handler &out, const document &doc) {
 
+  // binary output is written as bytes, not through the wide stream locale
+  const io::output_binary *bin = dynamic_cast<const io::output_binary*>(&out);
+  if (bin!=NULL) {
+    bin->write_document(cout,doc);
+    cout.flush();
+    return;
+  }
+
   // not in server mode, print results to wcout
   if (not ServerMode) {
     out.PrintResults(wcout,doc);
@@ -275,74 +293,6 @@ void OutputDocument(const io::output_handler &out, const document &doc) {
 }
 
 
-//---- Create output handler for requested format
-io::output_handler* create_output_handler(config *cfg) {
-
-  io::output_handler *out;
-  if (cfg->OutputFormat==OUT_TRAIN) {
-    out = new io::output_train();
-  }
-  else if (cfg->OutputFormat==OUT_CONLL) {
-    if (not cfg->OutputConllFile.empty()) 
-      out = new io::output_conll(cfg->OutputConllFile);
-    else {
-       out = new io::output_conll();
-       out->load_tagset(cfg->TAGSET_TagsetFile);
-    }
-  }
-  else if (cfg->OutputFormat==OUT_XML) {
-    out = new io::output_xml();
-    out->load_tagset(cfg->TAGSET_TagsetFile);
-  }
-  else if (cfg->OutputFormat==OUT_JSON)  {
-    out = new io::output_json();
-    out->load_tagset(cfg->TAGSET_TagsetFile);
-  }
-  else if (cfg->OutputFormat==OUT_NAF)  {
-    io::output_naf *onaf = new io::output_naf();
-    onaf->load_tagset(cfg->TAGSET_TagsetFile);
-    onaf->set_language(cfg->config_opt.Lang);
-
-    onaf->ActivateLayer(L"text",true);
-    onaf->ActivateLayer(L"terms",cfg->invoke_opt.OutputLevel>=MORFO);
-    onaf->ActivateLayer(L"entities",cfg->invoke_opt.OutputLevel>=TAGGED);
-    onaf->ActivateLayer(L"chunks",cfg->invoke_opt.OutputLevel==SHALLOW);
-    onaf->ActivateLayer(L"constituency",cfg->invoke_opt.OutputLevel>=PARSED
-                        and cfg->invoke_opt.DEP_which==TXALA);
-    onaf->ActivateLayer(L"deps",cfg->invoke_opt.OutputLevel>=DEP);
-    onaf->ActivateLayer(L"srl",cfg->invoke_opt.OutputLevel>=DEP 
-                        and cfg->invoke_opt.DEP_which==TREELER);
-    onaf->ActivateLayer(L"coreferences",cfg->invoke_opt.OutputLevel>=COREF);
-    out = onaf;
-  }
-  else { //  default, cfg->OutputFormat==OUT_FREELING
-    io::output_freeling *ofl = new io::output_freeling();
-    ofl->output_senses(cfg->invoke_opt.SENSE_WSD_which!=NO_WSD);
-    ofl->output_all_senses(cfg->invoke_opt.SENSE_WSD_which!=MFS);
-    ofl->output_phonetics(cfg->invoke_opt.PHON_Phonetics);
-    ofl->output_dep_tree(cfg->invoke_opt.OutputLevel>=DEP);
-    ofl->output_corefs(cfg->invoke_opt.OutputLevel>=COREF);
-    out = ofl;
-  }
-
-  return out;
-}
-
-
-//---- Create input handler for requested format
-io::input_handler* create_input_handler(config *cfg) {
-
-  io::input_handler *inp;
-  if (cfg->InputFormat==INP_CONLL) {
-    if (not cfg->InputConllFile.empty()) inp = new io::input_conll(cfg->InputConllFile);
-    else inp = new io::input_conll();
-  }
-  else if (cfg->InputFormat==INP_FREELING)  inp = new io::input_freeling();
-  else inp = NULL;
-  
-  return inp;
-}
-
 //---- Load options from config file and command line
 config* load_config(int argc, char *argv[]) {
   
@@ -360,6 +310,9 @@ config* load_config(int argc, char *argv[]) {
     cfg->Port=0;
   }
 
+  // per-module counters are only reported by the server
+  if (ServerMode) metrics::enable();
+
   /// Check options are minimally consistent
   
   /// Check that required configuration can satisfy required requests
@@ -468,6 +421,14 @@ config* load_config(int argc, char *argv[]) {
     wcerr<<L"Error - 'conll' input format only accepts input analysis levels >= tagged."<<endl;
     exit(1);
   }
+  if (cfg->InputFormat==INP_BINARY and cfg->invoke_opt.InputLevel < SPLITTED) {
+    wcerr<<L"Error - 'binary' input format only accepts input analysis levels >= splitted."<<endl;
+    exit(1);
+  }
+  if (cfg->Server and (cfg->InputFormat==INP_BINARY or cfg->OutputFormat==OUT_BINARY)) {
+    wcerr<<L"Error - 'binary' input and output formats are not available in server mode."<<endl;
+    exit(1);
+  }
   if (cfg->InputFormat==INP_TEXT and cfg->invoke_opt.InputLevel!=TEXT) {
     wcerr<<L"Error - 'text' input format only accepts input analysis level 'text'."<<endl;
     exit(1);
@@ -539,10 +500,39 @@ void process_text_incremental(analyzer &anlz, ServerStats &stats, const io::outp
 // outputting results as soon as they are available
 //---------------------------------------------
 
-void process_columns_incremental(const analyzer &anlz, ServerStats &stats, const io::input_handler &inp, const io::output_handler &out) {
+void process_columns_incremental(const analyzer &anlz, ServerStats &stats, const io::input_handler &inp, const io::output_handler &out, size_t batch) {
 
   // read and analyze text incrementally. Text is analyzed in some column format
   list<sentence> ls;
+
+  // binary input is read as bytes, not through the wide stream locale
+  const io::input_binary *bin = dynamic_cast<const io::input_binary*>(&inp);
+  if (bin!=NULL) {
+    ls.push_back(sentence());
+    while (bin->read_sentence(cin,ls.back())) {
+      anlz.analyze(ls);
+      OutputSentences(out,ls);
+      ls.clear();
+      ls.push_back(sentence());
+    }
+    return;
+  }
+
+  if (not ServerMode) {
+    // read sentences straight from stdin, without accumulating input text,
+    // and analyze them in batches of the given size
+    bool more=true;
+    while (more) {
+      more = inp.input_sentences(wcin,ls,batch);
+      if (ls.empty()) continue;
+      // analyze
+      anlz.analyze(ls);
+      // output results
+      OutputSentences(out,ls);
+    }
+    return;
+  }
+
   wstring text, line;  
   while (ReadLine(line)) {
     if (ServerMode) {
@@ -609,6 +599,8 @@ int main (int argc, char **argv) {
     inp = create_input_handler(cfg);
 
     anlz = new analyzer(*cfg);
+    // the server loads modules before forking workers, so they share them
+    if (ServerMode) anlz->load_modules(cfg->invoke_opt);
   }
 
   if (ServerMode) {
@@ -651,16 +643,24 @@ int main (int argc, char **argv) {
     // ---------------------------------------------------------------
     // Process text documentwise
     else if (cfg->InputMode == MODE_DOC) {
-      // load whole document in a string
+      document doc; 
       wstring text;
-      load_document(text, *stats);
+      // binary input is read as bytes, not through the wide stream locale
+      if (cfg->InputFormat == INP_BINARY) 
+        static_cast<io::input_binary*>(inp)->read_document(cin,doc);
+      // otherwise, load whole document in a string
+      else
+        load_document(text, *stats);
       
-      document doc; 
       // if input is plain text, analyze directly, treating blank lines
       // as paragraph separators.
       if (cfg->InputFormat == INP_TEXT) 
         anlz->analyze(text,doc,true);
 
+      // binary input is already loaded in the document
+      else if (cfg->InputFormat == INP_BINARY) 
+        anlz->analyze(doc);
+
       // if input is partially analyzed, load it into a document, and analyze
       else {  
         inp->input_document(text,doc);
@@ -678,7 +678,7 @@ int main (int argc, char **argv) {
       if (cfg->InputFormat == INP_TEXT) 
         process_text_incremental(*anlz,*stats,*out,cfg->AlwaysFlush);
       else 
-        process_columns_incremental(*anlz,*stats,*inp,*out);    
+        process_columns_incremental(*anlz,*stats,*inp,*out,max(1,cfg->InputBatch));    
     }
 
       // if we are a forked server attending a client, and the client is done, we exit.
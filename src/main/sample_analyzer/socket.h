@@ -3,6 +3,7 @@
 
 
 #include <string>
+#include <stdexcept>
 #if defined WIN32 || defined WIN64
   #include <winsock2.h>
   #include "iso646.h"
@@ -17,10 +18,14 @@
                        error("Error at WSAStartup()\n", iResult);
   #define cleanup_socket() WSACleanup()
   #define socklen_t int
+  #define SHUT_WR SD_SEND
+  #define socket_errno WSAGetLastError()
+  #define pause_ms(ms) Sleep(ms)
 #else
   #include <string.h>
   #include <cstdlib>
   #include <cstdio>
+  #include <cerrno>
   #include <unistd.h>
   #include <sys/types.h>
   #include <sys/socket.h>
@@ -33,38 +38,66 @@
   #define startup_socket()
   #define cleanup_socket()
   #define SOCKET int
+  #define socket_errno errno
+  #define pause_ms(ms) usleep((ms)*1000)
 #endif
 
 #define SOCK_QUEUE_SZ 5
 #define BUFF_SZ 2048
+// largest framed message accepted
+#define MAX_FRAME_SZ (64*1024*1024)
+
+// Framed messages: 4-byte payload length, 4-byte request id (both
+// big-endian), 1-byte message type, and the payload. Used by the
+// pipelined protocol, where responses may come in any order.
+#define FRAME_HEADER_SZ 9
+#define FRAME_TEXT 'T'      // client: text to analyze
+#define FRAME_COMMAND 'C'   // client: server command (SET_LANG, PRINT_STATS...)
+#define FRAME_RESULT 'R'    // server: result of a request (maybe empty)
+#define FRAME_ERROR 'E'     // server: request failed, payload explains why
+// message sent by clients (in the plain protocol) to switch to framed
+// messages, and server answer accepting it
+#define FRAMED_PROTOCOL "FL-FRAMED-1"
+#define FRAMED_READY "FL-FRAMED-READY"
 
 class socket_CS {
   private:
   SOCKET sock, sock2;
+  // whether errors end the process (forked workers) or are thrown (threaded servers)
+  bool fatal;
   void error(const std::string &,int) const;
+  SOCKET accept_connection();
+  socket_CS() {}
+  bool read_bytes(char *, size_t);
+  void write_bytes(const char *, size_t);
 
   public:
     socket_CS(int port, int qsize=SOCK_QUEUE_SZ);
-    socket_CS(const std::string&, int);
+    socket_CS(const std::string&, int, bool fatal_errors=true);
 
     ~socket_CS();
 
     void wait_client();
+    socket_CS* accept_client();
     int read_message(std::string&);
     void write_message(const std::string &);
+    bool read_frame(unsigned int &, char &, std::string &);
+    void write_frame(unsigned int, char, const std::string &);
     void close_connection();
+    void end_writing();
     void set_child();
     void set_parent();
 };
 
 
 void socket_CS::error(const std::string &msg, int code) const {
+  if (not fatal) throw std::runtime_error(msg);
   perror(msg.c_str());
   exit(code);
 }
 
 
-socket_CS::socket_CS(int port, int queue_size) {
+socket_CS::socket_CS(int port, int queue_size) : fatal(true) {
   struct sockaddr_in server;
   startup_socket();  
   sock = socket(AF_INET, SOCK_STREAM, 0);
@@ -83,7 +116,7 @@ socket_CS::socket_CS(int port, int queue_size) {
 
 
 
-socket_CS::socket_CS(const std::string &host, int port) {
+socket_CS::socket_CS(const std::string &host, int port, bool fatal_errors) : fatal(fatal_errors) {
 
   struct sockaddr_in server;
   startup_socket();  
@@ -109,11 +142,51 @@ socket_CS::~socket_CS() {
   cleanup_socket();
 }
 
+// whether a failed accept() may succeed later: the listening socket 
+// is fine, but the pending client went away, or there are no free 
+// descriptors or buffers right now.
+static bool accept_transient(int e) {
+#if defined WIN32 || defined WIN64
+  return e==WSAEINTR or e==WSAECONNRESET or e==WSAEMFILE or e==WSAENOBUFS or e==WSAENETDOWN;
+#else
+  return e==EINTR or e==ECONNABORTED or e==EPROTO or e==EMFILE or e==ENFILE 
+    or e==ENOBUFS or e==ENOMEM or e==ENETDOWN or e==ENETUNREACH 
+    or e==EHOSTUNREACH or e==EHOSTDOWN or e==ENOPROTOOPT;
+#endif
+}
+
+// accept a connection on the listening socket. Transient failures are
+// reported and the accept retried, so they do not end the server.
+SOCKET socket_CS::accept_connection() {  
+  while (true) {
+    struct sockaddr_in client;
+    socklen_t len = sizeof(client);
+    SOCKET s = accept(sock,(struct sockaddr *) &client, &len);
+    if (s >= 0) return s;
+
+    int e = socket_errno;
+    if (not accept_transient(e)) error("ERROR on accept",s);
+    perror("ERROR on accept (retrying)");
+    // give other connections time to release resources
+    pause_ms(100);
+  }
+}
+
 void socket_CS::wait_client() {  
-  struct sockaddr_in client;
-  socklen_t len = sizeof(client);
-  sock2 = accept(sock,(struct sockaddr *) &client, &len);
-  if (sock2 < 0) error("ERROR on accept",sock2);
+  sock2 = accept_connection();
+}
+
+// Accept a client and return a connection to attend it, while this
+// socket keeps listening. Errors on the connection are thrown, so 
+// a threaded server can drop the client and go on.
+socket_CS* socket_CS::accept_client() {  
+  SOCKET s = accept_connection();
+
+  socket_CS *conn = new socket_CS();
+  conn->sock = s;
+  conn->sock2 = s;
+  conn->fatal = false;
+  return conn;
 }
 
 void socket_CS::set_child() {  
@@ -158,6 +231,68 @@ void socket_CS::write_message(const std::string &s) {
 }
 
 
+// read exactly n bytes. Return false if the connection was closed before the first one.
+bool socket_CS::read_bytes(char *buf, size_t n) {
+  size_t got=0;
+  while (got<n) {
+    int k = read_from_socket(sock2,buf+got,n-got);
+    if (k < 0) error("ERROR reading from socket",k);
+    if (k == 0) {
+      if (got==0) return false;
+      error("ERROR connection closed in the middle of a message",0);
+    }
+    got += k;
+  }
+  return true;
+}
+
+void socket_CS::write_bytes(const char *buf, size_t n) {
+  size_t sent=0;
+  while (sent<n) {
+    int k = write_to_socket(sock2,buf+sent,n-sent);
+    if (k < 0) error("ERROR writing to socket",k);
+    sent += k;
+  }
+}
+
+// read a framed message. Return false if the connection was closed.
+bool socket_CS::read_frame(unsigned int &id, char &type, std::string &payload) {
+  unsigned char h[FRAME_HEADER_SZ];
+  if (not read_bytes((char*)h,FRAME_HEADER_SZ)) return false;
+
+  size_t len = ((size_t)h[0]<<24) | ((size_t)h[1]<<16) | ((size_t)h[2]<<8) | (size_t)h[3];
+  id = ((unsigned int)h[4]<<24) | ((unsigned int)h[5]<<16) | ((unsigned int)h[6]<<8) | (unsigned int)h[7];
+  type = (char)h[8];
+  if (len > MAX_FRAME_SZ) error("ERROR message too large",0);
+
+  payload.resize(len);
+  if (len>0 and not read_bytes(&payload[0],len)) 
+    error("ERROR connection closed in the middle of a message",0);
+  return true;
+}
+
+// write a framed message. Threads sharing a connection must
+// serialize their calls, so messages do not get interleaved.
+void socket_CS::write_frame(unsigned int id, char type, const std::string &payload) {
+  size_t len = payload.size();
+  // the other side would reject it (and the length field has 32 bits)
+  if (len > MAX_FRAME_SZ) error("ERROR message too large",0);
+  std::string msg(FRAME_HEADER_SZ,0);
+  msg[0] = (char)(len>>24); msg[1] = (char)(len>>16); msg[2] = (char)(len>>8); msg[3] = (char)len;
+  msg[4] = (char)(id>>24); msg[5] = (char)(id>>16); msg[6] = (char)(id>>8); msg[7] = (char)id;
+  msg[8] = type;
+  msg += payload;
+  write_bytes(msg.c_str(),msg.size());
+}
+
+
+// tell the other side we will send nothing else, but keep reading
+void socket_CS::end_writing() {
+  int n;
+  n = shutdown(sock2,SHUT_WR);
+  if (n < 0) error("ERROR closing socket",n);
+}
+
 void socket_CS::close_connection() {
   int n;
   n=close_socket(sock2);
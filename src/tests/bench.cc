@@ -0,0 +1,667 @@
+//////////////////////////////////////////////////////////////////
+//
+//    FreeLing - Open Source Language Analyzers
+//
+//    Copyright (C) 2014   TALP Research Center
+//                         Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU Affero General Public
+//    License as published by the Free Software Foundation; either
+//    version 3 of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Affero General Public License for more details.
+//
+//    You should have received a copy of the GNU Affero General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: Lluis Padro (padro@lsi.upc.es)
+//             TALP Research Center
+//             despatx C6.212 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+////////////////////////////////////////////////////////////////
+
+
+//------------------------------------------------------------------//
+//
+//  freeling-bench: time each processing stage, and the whole
+//  analyzer, on fixed corpora.
+//
+//  For each given configuration (a language code, looked up in
+//  <share>/config, or a .cfg file) every module enabled in the
+//  configuration is loaded, and timed on the corpus already analyzed
+//  up to the level it needs, so each figure covers one module only.
+//  End-to-end throughput of the analyzer is then measured for each
+//  output level up to the one the configuration reaches.
+//
+//  Results go to stdout (or --out file) as text, csv or json.
+//
+//  Usage:  freeling-bench [options] cfg1 [cfg2 ...]
+//     --share DIR     FreeLing data directory (default: $FREELINGSHARE)
+//     --corpus DIR    directory holding <lang>.txt corpora
+//     --filter STR    run only benchmarks whose name contains STR
+//     --min-time S    minimum timed seconds per repetition (default: 0.5)
+//     --reps N        repetitions per benchmark (default: 3)
+//     --format F      text, csv or json (default: text)
+//     --out FILE      write results to FILE
+//     --locale L      locale to use (default: "default")
+//
+//------------------------------------------------------------------//
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include <chrono>
+#include <ctime>
+#include <cstdlib>
+
+#define BOOST_SYSTEM_NO_DEPRECATED
+#include <boost/thread/thread.hpp>
+
+#include "freeling.h"
+#include "config.h"
+
+using namespace std;
+using namespace freeling;
+
+#ifndef FL_BENCH_CORPUS
+#define FL_BENCH_CORPUS "."
+#endif
+
+//////////////////////////////////////////////////////////////////
+/// Options of the benchmark run
+
+class bench_options {
+public:
+  string share;
+  string corpus;
+  string filter;
+  double min_time;
+  int reps;
+  string format;
+  string out;
+  wstring locale;
+  vector<string> configs;
+
+  bench_options() : corpus(FL_BENCH_CORPUS), min_time(0.5), reps(3), format("text"), locale(L"default") {
+    const char *s = getenv("FREELINGSHARE");
+    if (s!=NULL) share = s;
+  }
+};
+
+//////////////////////////////////////////////////////////////////
+/// Timing of one benchmark
+
+class bench_result {
+public:
+  string config;
+  string name;
+  unsigned long sentences;
+  unsigned long tokens;
+  long iterations;
+  /// seconds per iteration: median, best and worst repetition
+  double median, fastest, slowest;
+
+  double tokens_per_sec() const { return median>0 ? tokens/median : 0; }
+};
+
+//////////////////////////////////////////////////////////////////
+/// Auxiliary functions
+
+bool file_exists(const wstring &fname) {
+  if (fname.empty()) return false;
+  ifstream f(util::wstring2string(fname).c_str());
+  return f.good();
+}
+
+unsigned long count_sentences(const document &doc) {
+  unsigned long n=0;
+  for (document::const_iterator p=doc.begin(); p!=doc.end(); p++) n += p->size();
+  return n;
+}
+
+unsigned long count_tokens(const document &doc) {
+  unsigned long n=0;
+  for (document::const_iterator p=doc.begin(); p!=doc.end(); p++)
+    for (paragraph::const_iterator s=p->begin(); s!=p->end(); s++) n += s->size();
+  return n;
+}
+
+//////////////////////////////////////////////////////////////////
+/// Run 'body' repeatedly, calling 'setup' (untimed) before each
+/// iteration, until 'min_time' timed seconds are gathered. Repeat
+/// that 'reps' times, and keep the time per iteration of each one.
+
+bench_result measure(const bench_options &opt, const string &cfgname, const string &name,
+                     unsigned long nsent, unsigned long ntok,
+                     const function<void()> &setup, const function<void()> &body) {
+  typedef chrono::steady_clock clock_type;
+
+  // warm-up: caches, lazy initializations, page faults
+  setup(); body();
+
+  vector<double> per_iter;
+  long iters=0;
+  for (int r=0; r<opt.reps; r++) {
+    double elapsed=0;
+    long n=0;
+    while (n==0 or elapsed<opt.min_time) {
+      setup();
+      clock_type::time_point t0 = clock_type::now();
+      body();
+      elapsed += chrono::duration<double>(clock_type::now()-t0).count();
+      n++;
+    }
+    per_iter.push_back(elapsed/n);
+    iters += n;
+  }
+  sort(per_iter.begin(), per_iter.end());
+
+  bench_result res;
+  res.config = cfgname;
+  res.name = name;
+  res.sentences = nsent;
+  res.tokens = ntok;
+  res.iterations = iters;
+  res.median = per_iter[per_iter.size()/2];
+  res.fastest = per_iter.front();
+  res.slowest = per_iter.back();
+
+  wcerr << L"  " << util::string2wstring(name) << L": " << res.median*1000 << L" ms/iter, "
+        << res.tokens_per_sec() << L" tokens/s" << endl;
+  return res;
+}
+
+//////////////////////////////////////////////////////////////////
+/// Benchmarks for one configuration
+
+class bench_suite {
+private:
+  const bench_options &opt;
+  const config &cfg;
+  string name;
+  vector<bench_result> &results;
+
+  wstring text;
+  analyzer_invoke_options ivk;
+
+  /// modules, only those available in the configuration are loaded
+  tokenizer *tk;
+  splitter *sp;
+  maco *morfo;
+  hmm_tagger *hmm;
+  relax_tagger *relax;
+  nec *neclass;
+  senses *sens;
+  ukb *dsb;
+  chart_parser *parser;
+  dep_txala *deptxala;
+  dep_treeler *deptreeler;
+  dep_lstm *deplstm;
+  relaxcor *corfc;
+
+  /// whether the benchmark was selected with --filter
+  bool wanted(const string &bname) const {
+    return opt.filter.empty() or bname.find(opt.filter)!=string::npos;
+  }
+
+  /// load a module if its file exists and some selected benchmark needs it
+  template<class T> T* load(const wstring &fname, const string &bname, const function<T*()> &create) {
+    if (fname.empty()) return NULL;
+    if (not file_exists(fname)) {
+      wcerr << L"  skipping " << util::string2wstring(bname) << L": file " << fname << L" not found." << endl;
+      return NULL;
+    }
+    return create();
+  }
+
+  /// time given processor on a copy of given input
+  template<class T> void run_processor(const string &bname, const T *proc, const document &input) {
+    if (proc==NULL or not wanted(bname)) return;
+    document work;
+    results.push_back(measure(opt, name, bname, count_sentences(input), count_tokens(input),
+                              [&]() { work = input; },
+                              [&]() { proc->analyze(work); }));
+  }
+
+  /// time given processor on a copy of given input, with given options
+  template<class T> void run_processor(const string &bname, const T *proc, const document &input,
+                                       const analyzer_invoke_options &iv) {
+    if (proc==NULL or not wanted(bname)) return;
+    document work;
+    results.push_back(measure(opt, name, bname, count_sentences(input), count_tokens(input),
+                              [&]() { work = input; },
+                              [&]() { proc->analyze(work, iv); }));
+  }
+
+  /// tokenize and split the corpus, one paragraph per line
+  document split_corpus() const {
+    document doc;
+    splitter::session_id ses = sp->open_session();
+    unsigned long offs=0;
+    wistringstream in(text);
+    wstring line;
+    while (getline(in,line)) {
+      if (line.empty()) continue;
+      list<word> lw;
+      tk->tokenize(line, offs, lw);
+      doc.push_back(paragraph());
+      sp->split(ses, lw, true, doc.back());
+    }
+    sp->close_session(ses);
+    return doc;
+  }
+
+  /// apply PoS tagger selected in the configuration
+  void tag(document &doc) const {
+    if (ivk.TAGGER_which==RELAX and relax!=NULL) relax->analyze(doc, ivk);
+    else if (hmm!=NULL) hmm->analyze(doc, ivk);
+    else if (relax!=NULL) relax->analyze(doc, ivk);
+  }
+
+  /// apply dependency parser selected in the configuration
+  bool parse_dep(document &doc) const {
+    if (ivk.DEP_which==TREELER and deptreeler!=NULL) deptreeler->analyze(doc);
+    else if (ivk.DEP_which==LSTM and deplstm!=NULL) deplstm->analyze(doc);
+    else if (ivk.DEP_which==TXALA and deptxala!=NULL) deptxala->analyze(doc);
+    else return false;
+    return true;
+  }
+
+  /// time each stage of the maco cascade alone, on the output of the stages before it
+  void bench_maco_stages(const document &splitted) {
+    typedef pair<string, bool analyzer_invoke_options::*> stage;
+    const stage stages[] = {
+      stage("maco/usermap", &analyzer_invoke_options::MACO_UserMap),
+      stage("maco/numbers", &analyzer_invoke_options::MACO_NumbersDetection),
+      stage("maco/punctuation", &analyzer_invoke_options::MACO_PunctuationDetection),
+      stage("maco/dates", &analyzer_invoke_options::MACO_DatesDetection),
+      stage("maco/dictionary", &analyzer_invoke_options::MACO_DictionarySearch),
+      stage("maco/multiwords", &analyzer_invoke_options::MACO_MultiwordsDetection),
+      stage("maco/ner", &analyzer_invoke_options::MACO_NERecognition),
+      stage("maco/quantities", &analyzer_invoke_options::MACO_QuantitiesDetection),
+      stage("maco/probabilities", &analyzer_invoke_options::MACO_ProbabilityAssignment)
+    };
+    const int nstages = sizeof(stages)/sizeof(stage);
+
+    // options with all stages off, to be turned on one by one
+    analyzer_invoke_options before = ivk;
+    for (int i=0; i<nstages; i++) before.*(stages[i].second) = false;
+
+    document input = splitted;
+    for (int i=0; i<nstages; i++) {
+      if (not (ivk.*(stages[i].second))) continue;
+
+      analyzer_invoke_options only = before;
+      for (int j=0; j<nstages; j++) only.*(stages[j].second) = (j==i);
+      run_processor(stages[i].first, morfo, input, only);
+
+      // move input forward through this stage
+      morfo->analyze(input, only);
+    }
+  }
+
+public:
+  bench_suite(const bench_options &o, const config &c, const string &n, vector<bench_result> &res)
+    : opt(o), cfg(c), name(n), results(res), ivk(c.invoke_opt),
+      tk(NULL), sp(NULL), morfo(NULL), hmm(NULL), relax(NULL), neclass(NULL), sens(NULL),
+      dsb(NULL), parser(NULL), deptxala(NULL), deptreeler(NULL), deplstm(NULL), corfc(NULL) {}
+
+  ~bench_suite() {
+    delete tk; delete sp; delete morfo; delete hmm; delete relax;
+    delete neclass; delete sens; delete dsb; delete parser;
+    delete deptxala; delete deptreeler; delete deplstm; delete corfc;
+  }
+
+  /// read corpus for the configuration language
+  bool load_corpus() {
+    string fname = opt.corpus + "/" + util::wstring2string(cfg.config_opt.Lang) + ".txt";
+    wifstream f(fname.c_str());
+    if (not f.good()) {
+      wcerr << L"No corpus " << util::string2wstring(fname) << L" for " << util::string2wstring(name) << L", skipping." << endl;
+      return false;
+    }
+    wstringstream ss;
+    ss << f.rdbuf();
+    text = ss.str();
+    return true;
+  }
+
+  /// per-module benchmarks
+  void run_modules() {
+    const analyzer_config_options &co = cfg.config_opt;
+
+    tk = load<tokenizer>(co.TOK_TokenizerFile, "tokenizer", [&]() { return new tokenizer(co.TOK_TokenizerFile); });
+    sp = load<splitter>(co.SPLIT_SplitterFile, "splitter", [&]() { return new splitter(co.SPLIT_SplitterFile); });
+    if (tk==NULL or sp==NULL) {
+      wcerr << L"  tokenizer and splitter are required, skipping " << util::string2wstring(name) << endl;
+      return;
+    }
+
+    // --- tokenizer
+    if (wanted("tokenizer")) {
+      list<word> lw;
+      tk->tokenize(text, lw);
+      unsigned long ntok = lw.size();
+      results.push_back(measure(opt, name, "tokenizer", 0, ntok,
+                                [&]() { lw.clear(); },
+                                [&]() { unsigned long offs=0; tk->tokenize(text, offs, lw); }));
+    }
+
+    // --- splitter
+    document splitted = split_corpus();
+    if (wanted("splitter")) {
+      list<word> tokens;
+      tk->tokenize(text, tokens);
+      list<word> work;
+      list<sentence> ls;
+      results.push_back(measure(opt, name, "splitter", count_sentences(splitted), tokens.size(),
+                                [&]() { work = tokens; ls.clear(); },
+                                [&]() {
+                                  splitter::session_id ses = sp->open_session();
+                                  sp->split(ses, work, true, ls);
+                                  sp->close_session(ses);
+                                }));
+    }
+
+    // --- morphological analysis, whole and stage by stage
+    morfo = load<maco>(co.MACO_DictionaryFile, "maco", [&]() { return new maco(cfg); });
+    if (morfo==NULL) return;
+    run_processor("maco", morfo, splitted, ivk);
+    bench_maco_stages(splitted);
+
+    document analyzed = splitted;
+    morfo->analyze(analyzed, ivk);
+
+    // --- taggers
+    hmm = load<hmm_tagger>(co.TAGGER_HMMFile, "hmm_tagger", [&]() { return new hmm_tagger(cfg); });
+    relax = load<relax_tagger>(co.TAGGER_RelaxFile, "relax_tagger", [&]() { return new relax_tagger(cfg); });
+    run_processor("hmm_tagger", hmm, analyzed, ivk);
+    run_processor("relax_tagger", relax, analyzed, ivk);
+    if (hmm==NULL and relax==NULL) return;
+
+    document tagged = analyzed;
+    tag(tagged);
+
+    // --- NE classification (nec picks the classifier its file asks for)
+    if (wanted("nec")) {
+      neclass = load<nec>(co.NEC_NECFile, "nec", [&]() { return new nec(co.NEC_NECFile); });
+      run_processor("nec", neclass, tagged);
+    }
+
+    // --- sense annotation and disambiguation
+    sens = load<senses>(co.SENSE_ConfigFile, "senses", [&]() { return new senses(co.SENSE_ConfigFile); });
+    run_processor("senses", sens, tagged);
+    if (sens!=NULL and wanted("ukb")) {
+      dsb = load<ukb>(co.UKB_ConfigFile, "ukb", [&]() { return new ukb(co.UKB_ConfigFile); });
+      document sensed = tagged;
+      sens->analyze(sensed);
+      run_processor("ukb", dsb, sensed);
+    }
+
+    // --- constituency and dependency parsers
+    parser = load<chart_parser>(co.PARSER_GrammarFile, "chart_parser",
+                                [&]() { return new chart_parser(co.PARSER_GrammarFile); });
+    run_processor("chart_parser", parser, tagged);
+
+    if (parser!=NULL) {
+      deptxala = load<dep_txala>(co.DEP_TxalaFile, "dep_txala",
+                                 [&]() { return new dep_txala(co.DEP_TxalaFile, parser->get_start_symbol()); });
+      if (deptxala!=NULL and wanted("dep_txala")) {
+        document parsed = tagged;
+        parser->analyze(parsed);
+        run_processor("dep_txala", deptxala, parsed);
+      }
+    }
+
+    // (the configured dependency parser is also needed to prepare relaxcor input)
+    bool coref = wanted("relaxcor") and not co.COREF_CorefFile.empty();
+    if (wanted("dep_treeler") or (coref and ivk.DEP_which==TREELER)) {
+      deptreeler = load<dep_treeler>(co.DEP_TreelerFile, "dep_treeler",
+                                     [&]() { return new dep_treeler(co.DEP_TreelerFile); });
+      run_processor("dep_treeler", deptreeler, tagged);
+    }
+    if (wanted("dep_lstm") or (coref and ivk.DEP_which==LSTM)) {
+      deplstm = load<dep_lstm>(co.DEP_LSTMFile, "dep_lstm", [&]() { return new dep_lstm(co.DEP_LSTMFile); });
+      run_processor("dep_lstm", deplstm, tagged);
+    }
+
+    // --- coreference, on the output of the configured dependency parser
+    if (coref) {
+      corfc = load<relaxcor>(co.COREF_CorefFile, "relaxcor", [&]() { return new relaxcor(co.COREF_CorefFile); });
+      if (corfc!=NULL) {
+        document dep = tagged;
+        if (sens!=NULL) sens->analyze(dep);
+        if (parser!=NULL) parser->analyze(dep);
+        if (parse_dep(dep)) run_processor("relaxcor", corfc, dep);
+        else wcerr << L"  skipping relaxcor: no dependency parser available." << endl;
+      }
+    }
+  }
+
+  /// end-to-end throughput of a whole analyzer, for each output level
+  void run_pipeline() {
+    const AnalysisLevel levels[] = {MORFO, TAGGED, PARSED, DEP};
+    const char *level_names[] = {"morfo", "tagged", "parsed", "dep"};
+    const int nlevels = sizeof(levels)/sizeof(AnalysisLevel);
+
+    bool any=false;
+    for (int i=0; i<nlevels; i++) any = any or wanted(string("analyzer/")+level_names[i]);
+    if (not any) return;
+
+    // load only what the deepest level needs
+    analyzer_config ac = cfg;
+    ac.config_opt.SRL_TreelerFile = ac.config_opt.COREF_CorefFile = ac.config_opt.SEMGRAPH_SemGraphFile = L"";
+    ac.config_opt.UKB_ConfigFile = ac.config_opt.NEC_NECFile = ac.config_opt.PHON_PhoneticsFile = L"";
+    if (ivk.DEP_which!=TREELER) ac.config_opt.DEP_TreelerFile = L"";
+    if (ivk.DEP_which!=LSTM) ac.config_opt.DEP_LSTMFile = L"";
+    if (ivk.DEP_which!=TXALA) ac.config_opt.DEP_TxalaFile = L"";
+    const wstring *files[] = {&ac.config_opt.TOK_TokenizerFile, &ac.config_opt.SPLIT_SplitterFile,
+                              &ac.config_opt.MACO_DictionaryFile, &ac.config_opt.TAGGER_HMMFile,
+                              &ac.config_opt.TAGGER_RelaxFile, &ac.config_opt.SENSE_ConfigFile,
+                              &ac.config_opt.PARSER_GrammarFile, &ac.config_opt.DEP_TxalaFile,
+                              &ac.config_opt.DEP_TreelerFile, &ac.config_opt.DEP_LSTMFile};
+    for (size_t f=0; f<sizeof(files)/sizeof(wstring*); f++) {
+      if (not files[f]->empty() and not file_exists(*files[f])) {
+        wcerr << L"  skipping analyzer: file " << *files[f] << L" not found." << endl;
+        return;
+      }
+    }
+
+    ac.invoke_opt.InputLevel = TEXT;
+    ac.invoke_opt.NEC_NEClassification = false;
+    ac.invoke_opt.PHON_Phonetics = false;
+    ac.invoke_opt.SRL_which = NO_SRL;
+    if (ac.invoke_opt.SENSE_WSD_which==UKB) ac.invoke_opt.SENSE_WSD_which = MFS;
+    analyzer anlz(ac);
+
+    for (int i=0; i<nlevels; i++) {
+      string bname = string("analyzer/")+level_names[i];
+      if (not wanted(bname)) continue;
+
+      analyzer_invoke_options iv = ac.invoke_opt;
+      iv.OutputLevel = levels[i];
+      if (levels[i]>=TAGGED and iv.TAGGER_which==NO_TAGGER) continue;
+      if (levels[i]>=PARSED and ac.config_opt.PARSER_GrammarFile.empty()) continue;
+      if (levels[i]>=DEP and (iv.DEP_which==NO_DEP or (ac.config_opt.DEP_TxalaFile.empty() and
+                                                     ac.config_opt.DEP_TreelerFile.empty() and
+                                                     ac.config_opt.DEP_LSTMFile.empty()))) continue;
+
+      document doc;
+      anlz.analyze(text, doc, iv, true);
+      unsigned long nsent = count_sentences(doc), ntok = count_tokens(doc);
+      results.push_back(measure(opt, name, bname, nsent, ntok,
+                                [&]() { doc.clear(); },
+                                [&]() { anlz.analyze(text, doc, iv, true); }));
+    }
+  }
+};
+
+//////////////////////////////////////////////////////////////////
+/// Output formats
+
+string json_string(const string &s) {
+  string r = "\"";
+  for (size_t i=0; i<s.size(); i++) {
+    if (s[i]=='"' or s[i]=='\\') r += '\\';
+    r += s[i];
+  }
+  return r + "\"";
+}
+
+void print_text(ostream &out, const vector<bench_result> &res) {
+  out << left;
+  out.width(16); out << "config";
+  out.width(24); out << "benchmark";
+  out << right;
+  out.width(12); out << "ms/iter";
+  out.width(12); out << "min";
+  out.width(12); out << "max";
+  out.width(10); out << "iters";
+  out.width(10); out << "tokens";
+  out.width(14); out << "tokens/s" << endl;
+  for (vector<bench_result>::const_iterator r=res.begin(); r!=res.end(); r++) {
+    out << left;
+    out.width(16); out << r->config;
+    out.width(24); out << r->name;
+    out << right << fixed;
+    out.precision(3);
+    out.width(12); out << r->median*1000;
+    out.width(12); out << r->fastest*1000;
+    out.width(12); out << r->slowest*1000;
+    out.width(10); out << r->iterations;
+    out.width(10); out << r->tokens;
+    out.precision(0);
+    out.width(14); out << r->tokens_per_sec() << endl;
+  }
+}
+
+void print_csv(ostream &out, const vector<bench_result> &res) {
+  out << "config,benchmark,seconds_median,seconds_min,seconds_max,iterations,sentences,tokens,tokens_per_second" << endl;
+  out.precision(9);
+  for (vector<bench_result>::const_iterator r=res.begin(); r!=res.end(); r++)
+    out << r->config << "," << r->name << "," << r->median << "," << r->fastest << "," << r->slowest << ","
+        << r->iterations << "," << r->sentences << "," << r->tokens << "," << r->tokens_per_sec() << endl;
+}
+
+void print_json(ostream &out, const bench_options &opt, const vector<bench_result> &res) {
+  time_t now = time(NULL);
+  char date[32];
+  strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%SZ", gmtime(&now));
+
+  out.precision(9);
+  out << "{" << endl;
+  out << "  \"context\": {\"date\": " << json_string(date)
+      << ", \"cpus\": " << boost::thread::hardware_concurrency()
+      << ", \"min_time\": " << opt.min_time << ", \"repetitions\": " << opt.reps << "}," << endl;
+  out << "  \"benchmarks\": [";
+  for (vector<bench_result>::const_iterator r=res.begin(); r!=res.end(); r++) {
+    out << (r==res.begin() ? "" : ",") << endl;
+    out << "    {\"config\": " << json_string(r->config) << ", \"name\": " << json_string(r->name)
+        << ", \"iterations\": " << r->iterations
+        << ", \"seconds_median\": " << r->median << ", \"seconds_min\": " << r->fastest
+        << ", \"seconds_max\": " << r->slowest
+        << ", \"sentences\": " << r->sentences << ", \"tokens\": " << r->tokens
+        << ", \"tokens_per_second\": " << r->tokens_per_sec() << "}";
+  }
+  out << endl << "  ]" << endl << "}" << endl;
+}
+
+//////////////////////////////////////////////////////////////////
+/// Command line
+
+void usage() {
+  wcerr << L"Usage: freeling-bench [options] config [config ...]" << endl
+        << L"  config is a language code (looked up in <share>/config) or a .cfg file" << endl
+        << L"  --share DIR     FreeLing data directory (default: $FREELINGSHARE)" << endl
+        << L"  --corpus DIR    directory holding <lang>.txt corpora" << endl
+        << L"  --filter STR    run only benchmarks whose name contains STR" << endl
+        << L"  --min-time S    minimum timed seconds per repetition (default: 0.5)" << endl
+        << L"  --reps N        repetitions per benchmark (default: 3)" << endl
+        << L"  --format F      text, csv or json (default: text)" << endl
+        << L"  --out FILE      write results to FILE instead of stdout" << endl
+        << L"  --locale L      locale to use (default: \"default\")" << endl;
+  exit(1);
+}
+
+bench_options parse_args(int argc, char **argv) {
+  bench_options opt;
+  for (int i=1; i<argc; i++) {
+    string a = argv[i];
+    bool has_value = (i+1<argc);
+    if (a=="--help" or a=="-h") usage();
+    else if (a=="--share" and has_value) opt.share = argv[++i];
+    else if (a=="--corpus" and has_value) opt.corpus = argv[++i];
+    else if (a=="--filter" and has_value) opt.filter = argv[++i];
+    else if (a=="--min-time" and has_value) opt.min_time = atof(argv[++i]);
+    else if (a=="--reps" and has_value) opt.reps = max(1,atoi(argv[++i]));
+    else if (a=="--format" and has_value) opt.format = argv[++i];
+    else if (a=="--out" and has_value) opt.out = argv[++i];
+    else if (a=="--locale" and has_value) opt.locale = util::string2wstring(argv[++i]);
+    else if (a.compare(0,2,"--")==0) usage();
+    else opt.configs.push_back(a);
+  }
+  if (opt.configs.empty() or (opt.format!="text" and opt.format!="csv" and opt.format!="json")) usage();
+  return opt;
+}
+
+int main(int argc, char **argv) {
+
+  bench_options opt = parse_args(argc, argv);
+  util::init_locale(opt.locale);
+
+  // config files refer to data files through $FREELINGSHARE
+  if (not opt.share.empty()) {
+#ifdef WIN32
+    _putenv_s("FREELINGSHARE", opt.share.c_str());
+#else
+    setenv("FREELINGSHARE", opt.share.c_str(), 1);
+#endif
+  }
+
+  vector<bench_result> results;
+  for (vector<string>::const_iterator c=opt.configs.begin(); c!=opt.configs.end(); c++) {
+    string cfgfile = *c;
+    string cfgname = *c;
+    if (cfgfile.find(".cfg")==string::npos) cfgfile = opt.share + "/config/" + cfgfile + ".cfg";
+    else cfgname = cfgname.substr(cfgname.find_last_of("/\\")+1);
+
+    if (not file_exists(util::string2wstring(cfgfile))) {
+      wcerr << L"Configuration " << util::string2wstring(cfgfile) << L" not found, skipping." << endl;
+      continue;
+    }
+
+    wcerr << L"Benchmarking " << util::string2wstring(cfgname) << endl;
+    char *av[] = {argv[0], (char*)"-f", (char*)cfgfile.c_str()};
+    config cfg(3, av);
+
+    bench_suite suite(opt, cfg, cfgname, results);
+    if (not suite.load_corpus()) continue;
+    try {
+      suite.run_modules();
+      suite.run_pipeline();
+    }
+    catch (std::exception &e) {
+      wcerr << L"Error benchmarking " << util::string2wstring(cfgname) << L": " << util::string2wstring(e.what())
+            << L". Skipping the rest of this configuration." << endl;
+    }
+  }
+
+  ofstream fout;
+  if (not opt.out.empty()) fout.open(opt.out.c_str());
+  ostream &out = opt.out.empty() ? cout : fout;
+
+  if (opt.format=="json") print_json(out, opt, results);
+  else if (opt.format=="csv") print_csv(out, results);
+  else print_text(out, results);
+
+  return 0;
+}
@@ -0,0 +1,236 @@
+//////////////////////////////////////////////////////////////////
+//
+//    FreeLing - Open Source Language Analyzers
+//
+//    Copyright (C) 2014   TALP Research Center
+//                         Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU Affero General Public
+//    License as published by the Free Software Foundation; either
+//    version 3 of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Affero General Public License for more details.
+//
+//    You should have received a copy of the GNU Affero General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: Lluis Padro (padro@lsi.upc.es)
+//             TALP Research Center
+//             despatx C6.212 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+////////////////////////////////////////////////////////////////
+
+
+//------------------------------------------------------------------//
+//
+//  Round-trip test for output_binary/input_binary: a sentence with
+//  non-ASCII forms, k-best selections, parse and dependency trees
+//  is written and read back through byte streams, wide file streams,
+//  and wide strings, and must be encoded the same way afterwards.
+//
+//  Usage: fl_test_binary [locale]   (default: FreeLing default locale)
+//
+//------------------------------------------------------------------//
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cstdio>
+
+#include "freeling.h"
+#include "freeling/io.h"
+
+using namespace std;
+using namespace freeling;
+
+int errors = 0;
+
+//---- report a failed check
+void check(bool ok, const wstring &what) {
+  if (not ok) {
+    wcerr << L"FAILED: " << what << endl;
+    errors++;
+  }
+}
+
+//---- word with two analyses, each selected in a different kbest sequence
+word make_word(const wstring &form, size_t pos, const wstring &lem0, const wstring &tag0,
+               const wstring &lem1, const wstring &tag1) {
+  word w(form);
+  w.set_position(pos);
+  w.set_span(pos*10, pos*10+form.size());
+  analysis a0(lem0,tag0);
+  a0.set_prob(0.75);
+  a0.mark_selected(0);
+  analysis a1(lem1,tag1);
+  a1.set_prob(0.25);
+  a1.mark_selected(1);
+  w.push_back(a0);
+  w.push_back(a1);
+  return w;
+}
+
+//---- sentence holding everything the binary format keeps
+sentence make_sentence() {
+  sentence s;
+  s.push_back(make_word(L"Él", 0, L"él", L"PP3MS000", L"el", L"DA0MS0"));
+  s.push_back(make_word(L"comió", 1, L"comer", L"VMIS3S0", L"comer", L"VMIS3S0"));
+  s.push_back(make_word(L"ñoquis", 2, L"ñoqui", L"NCMP000", L"ñoquis", L"NP00000"));
+  s.push_back(make_word(L"€", 3, L"€", L"Zm", L"euro", L"NCMS000"));
+  s.set_sentence_id(L"1");
+  s.set_is_tagged(true);
+  s.set_best_seq(1);
+
+  // corrector alternatives are selected in kbest sequences starting at 1
+  alternative alt(L"ñoqui", 1);
+  alt.set_probability(0.5);
+  alt.add_selection(1);
+  alt.add_selection(2);
+  s[2].add_alternative(alt);
+  s[2].user.push_back(L"usuário");
+
+  // flat parse tree for sequences 0 and 1, with one leaf per word
+  for (int k=0; k<2; k++) {
+    node root(L"grup-verb·" + util::int2wstring(k));
+    root.set_head(false);
+    parse_tree pt(root);
+    for (size_t i=0; i<s.size(); i++) {
+      node leaf(s[i].get_form());
+      leaf.set_word(s[i]);
+      leaf.set_head(i==1);
+      leaf.user.push_back(L"hoja");
+      pt.add_child(parse_tree(leaf));
+    }
+    pt.build_node_index(L"1");
+    s.set_parse_tree(pt,k);
+
+    // dependency tree headed by "comió", linked to the parse tree leaves
+    parse_tree &spt = s.get_parse_tree(k);
+    vector<parse_tree::iterator> leaves;
+    for (parse_tree::iterator p=spt.begin(); p!=spt.end(); ++p)
+      if (p->has_word()) leaves.push_back(p);
+
+    depnode head(L"top");
+    head.set_word(s[1]);
+    head.set_link(leaves[1]);
+    dep_tree dt(head);
+    const wstring rels[] = {L"suj", L"", L"dobj", L"f"};
+    for (size_t i=0; i<s.size(); i++) {
+      if (i==1) continue;
+      depnode d(rels[i] + (k==1 ? L"·" : L""));
+      d.set_word(s[i]);
+      d.set_link(leaves[i]);
+      dt.add_child(dep_tree(d));
+    }
+    s.set_dep_tree(dt,k);
+  }
+
+  predicate pr(1, L"comer.01");
+  pr.add_argument(0, L"A0");
+  pr.add_argument(2, L"A1");
+  s.add_predicate(pr);
+
+  return s;
+}
+
+//---- binary encoding of a sentence
+string encode(const io::output_binary &out, const sentence &s) {
+  ostringstream sout;
+  out.write_sentences(sout, list<sentence>(1,s));
+  return sout.str();
+}
+
+//---- check that a decoded sentence matches the original
+void check_sentence(const io::output_binary &out, const sentence &orig, const sentence &s, const wstring &how) {
+  check(encode(out,s)==encode(out,orig), how+L": re-encoded sentence differs");
+  if (s.size()!=orig.size()) {
+    check(false, how+L": wrong number of words");
+    return;
+  }
+
+  check(s[0].get_form()==L"Él" and s[2].get_form()==L"ñoquis" and s[3].get_form()==L"€", how+L": non-ASCII forms");
+  check(s.get_best_seq()==1 and s.num_kbest()==2, how+L": kbest sequences");
+  check(s[0].get_lemma(1)==L"el" and s[2].get_tag(1)==L"NP00000", how+L": analysis selected in k=1");
+  check(s[2].get_alternatives().size()==1 and s[2].alternatives_begin()->is_selected(1)
+        and s[2].alternatives_begin()->is_selected(2), how+L": alternative selections");
+  check(s.has_parse_tree(1) and s.get_parse_tree(1).begin()->get_label()==L"grup-verb·1", how+L": parse tree");
+  check(s.has_dep_tree(1) and s.get_dep_tree(1).begin()->get_word().get_form()==L"comió", how+L": dependency tree");
+  if (s.has_dep_tree(1)) {
+    dep_tree::const_sibling_iterator d = s.get_dep_tree(1).begin().sibling_begin();
+    check(d->get_label()==L"suj·" and d->has_link() and &(d->get_link()->get_word())==&s[0],
+          how+L": dependency link to parse tree");
+  }
+  check(s.get_predicates().size()==1, how+L": predicates");
+}
+
+
+int main (int argc, char **argv) {
+
+  // use a UTF-8 locale, as the analyzer does, so that wide
+  // streams would re-encode the bytes without byte_locale
+  util::init_locale(argc>1 ? util::string2wstring(argv[1]) : L"default");
+
+  io::output_binary out;
+  io::input_binary inp;
+  sentence orig = make_sentence();
+
+  // byte streams
+  {
+    istringstream sin(encode(out,orig));
+    sentence s;
+    check(inp.read_sentence(sin,s), L"byte stream: sentence not read");
+    check_sentence(out, orig, s, L"byte stream");
+    check(not inp.read_sentence(sin,s), L"byte stream: end of stream not detected");
+  }
+
+  // wide file streams with byte locale
+  {
+    string fname = "fl_test_binary.tmp";
+    wofstream fout;
+    fout.imbue(io::binary_handler::byte_locale());
+    fout.open(fname.c_str(), ios::binary);
+    out.PrintResults(fout, list<sentence>(2,orig));
+    fout.close();
+
+    // bytes in the file are the binary messages, not re-encoded
+    ifstream raw(fname.c_str(), ios::binary);
+    ostringstream bytes;
+    bytes << raw.rdbuf();
+    raw.close();
+    check(bytes.str()==encode(out,orig)+encode(out,orig), L"wide file stream: file content is not the binary encoding");
+
+    wifstream fin;
+    fin.imbue(io::binary_handler::byte_locale());
+    fin.open(fname.c_str(), ios::binary);
+    sentence s;
+    for (int i=0; i<2; i++) {
+      check(inp.input_sentence(fin,s), L"wide file stream: sentence not read");
+      check_sentence(out, orig, s, L"wide file stream");
+    }
+    check(not inp.input_sentence(fin,s), L"wide file stream: end of stream not detected");
+    fin.close();
+    remove(fname.c_str());
+  }
+
+  // wide strings
+  {
+    wostringstream wout;
+    out.PrintResults(wout, list<sentence>(1,orig));
+    list<sentence> ls;
+    inp.input_sentences(wout.str(), ls);
+    check(ls.size()==1, L"wide string: sentence not read");
+    if (not ls.empty()) check_sentence(out, orig, ls.front(), L"wide string");
+    // a reused list gets only the new sentences
+    inp.input_sentences(wout.str(), ls);
+    check(ls.size()==1, L"wide string: list not cleared before reading");
+  }
+
+  if (errors==0) wcout << L"OK" << endl;
+  return (errors==0 ? 0 : 1);
+}
@@ -0,0 +1,145 @@
+//////////////////////////////////////////////////////////////////
+//
+//    FreeLing - Open Source Language Analyzers
+//
+//    Copyright (C) 2014   TALP Research Center
+//                         Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU Affero General Public
+//    License as published by the Free Software Foundation; either
+//    version 3 of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Affero General Public License for more details.
+//
+//    You should have received a copy of the GNU Affero General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: Lluis Padro (padro@lsi.upc.es)
+//             TALP Research Center
+//             despatx C6.212 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+////////////////////////////////////////////////////////////////
+
+
+
+//------------------------------------------------------------------//
+//
+//  Copy and move tests for parse_tree and dep_tree: empty trees
+//  can be copied and assigned, and copies of non-empty trees get
+//  node and word indexes pointing to their own nodes.
+//
+//  Usage: fl_test_trees
+//
+//------------------------------------------------------------------//
+
+#include <iostream>
+#include <utility>
+
+#include "freeling.h"
+
+using namespace std;
+using namespace freeling;
+
+int errors = 0;
+
+//---- report a failed check
+void check(bool ok, const wstring &what) {
+  if (not ok) {
+    wcerr << L"FAILED: " << what << endl;
+    errors++;
+  }
+}
+
+//---- sentence "a b c" with a flat parse tree and a dependency tree headed by "b"
+sentence make_sentence() {
+  sentence s;
+  const wstring forms[] = {L"a", L"b", L"c"};
+  for (size_t i=0; i<3; i++) {
+    word w(forms[i]);
+    w.set_position(i);
+    w.push_back(analysis(forms[i],L"NC"));
+    s.push_back(w);
+  }
+
+  parse_tree pt(node(L"S"));
+  for (size_t i=0; i<s.size(); i++) {
+    node leaf(s[i].get_form());
+    leaf.set_word(s[i]);
+    pt.add_child(parse_tree(leaf));
+  }
+  pt.build_node_index(L"1");
+  s.set_parse_tree(pt);
+
+  depnode head(L"top");
+  head.set_word(s[1]);
+  dep_tree dt(head);
+  for (size_t i=0; i<s.size(); i++) {
+    if (i==1) continue;
+    depnode d(L"mod");
+    d.set_word(s[i]);
+    dt.add_child(dep_tree(d));
+  }
+  dt.rebuild_node_index();
+  s.set_dep_tree(dt);
+  return s;
+}
+
+
+int main () {
+
+  // empty trees
+  {
+    parse_tree a;
+    parse_tree b(a);
+    parse_tree c;
+    c = a;
+    parse_tree d(std::move(b));
+    c = std::move(d);
+    check(a.empty() and c.empty(), L"empty parse_tree copies are not empty");
+
+    dep_tree e;
+    dep_tree f(e);
+    dep_tree g;
+    g = e;
+    dep_tree h(std::move(f));
+    g = std::move(h);
+    check(e.empty() and g.empty(), L"empty dep_tree copies are not empty");
+  }
+
+  // assigning an empty tree over a non-empty one
+  {
+    sentence s = make_sentence();
+    parse_tree pt = s.get_parse_tree();
+    pt = parse_tree();
+    check(pt.empty() and pt.get_node_by_id(L"1.0")==pt.end(), L"parse_tree index not cleared on assignment");
+    dep_tree dt = s.get_dep_tree();
+    dt = dep_tree();
+    check(dt.empty(), L"dep_tree not emptied on assignment");
+  }
+
+  // non-empty trees: indexes point to the copy's own nodes
+  {
+    sentence s = make_sentence();
+    const parse_tree &pt = s.get_parse_tree();
+    parse_tree pc(pt);
+    parse_tree::iterator n = pc.get_node_by_id(L"1.2");
+    check(n!=pc.end() and n->get_label()==L"b", L"parse_tree copy: node index");
+    check(&(*pc.get_node_by_pos(2)) != &(*pt.get_node_by_pos(2))
+          and pc.get_node_by_pos(2)->get_word().get_form()==L"c", L"parse_tree copy: word index");
+
+    const dep_tree &dt = s.get_dep_tree();
+    dep_tree dc;
+    dc = dt;
+    check(&(*dc.get_node_by_pos(0)) != &(*dt.get_node_by_pos(0))
+          and dc.get_node_by_pos(0)->get_word().get_form()==L"a", L"dep_tree copy: word index");
+  }
+
+  if (errors==0) wcout << L"OK" << endl;
+  return (errors==0 ? 0 : 1);
+}